@@ -9,6 +9,7 @@ import {
   TextInputBuilder,
   TextInputStyle
 } from 'discord.js';
+import { publishAssignment, setQueued } from './playerChannel.js';
 
 const SUPABASE_URL = process.env.SUPABASE_URL;
 const SUPABASE_KEY = process.env.SUPABASE_KEY;
@@ -81,6 +82,33 @@ function parseMatchChannel(name) {
   return { type: m[0], maxPlayers: a === b ? a * 2 : a + b };
 }
 
+// rl_name (identifiant du plugin) d'un membre Discord, mis en cache
+const rlNames = new Map(); // discord_id -> rl_name
+async function rlNameOf(discordId) {
+  if (rlNames.has(discordId)) return rlNames.get(discordId);
+  const [user] = await sbRequest('GET', 'users', { query: `discord_id=eq.${discordId}` }).catch(() => []);
+  const name = user?.rl_name || null;
+  if (name) rlNames.set(discordId, name);
+  return name;
+}
+
+function inLobby(discordId) {
+  for (const match of activeMatches.values())
+    if (match.players.includes(discordId)) return true;
+  return false;
+}
+
+// Signale au plugin du joueur qu'il attend un match (GET /player renvoie
+// "queued": true) : il interroge alors le bot toutes les 3 s. Un joueur
+// déplacé de la file vers le salon de son match reste en attente jusqu'à
+// la publication des identifiants.
+async function markQueued(discordId, value) {
+  const name = await rlNameOf(discordId);
+  if (!name) return;
+  if (!value && inLobby(discordId)) return;
+  setQueued(name, value);
+}
+
 function shuffle(arr) {
   const a = [...arr];
   for (let i = a.length - 1; i > 0; i--) {
@@ -92,6 +120,12 @@ function shuffle(arr) {
 
 export function setupAdvancedMatchmaking(client) {
   client.on('voiceStateUpdate', async (oldState, newState) => {
+    if (oldState.channelId !== newState.channelId && !newState.member?.user.bot) {
+      const fromQueue = oldState.channel && parseMatchChannel(oldState.channel.name);
+      const toQueue = newState.channel && parseMatchChannel(newState.channel.name);
+      if (toQueue) markQueued(newState.id, true).catch(() => {});
+      else if (fromQueue) markQueued(newState.id, false).catch(() => {});
+    }
     const channel = newState.channel;
     if (!channel) return;
     const info = parseMatchChannel(channel.name);
@@ -151,6 +185,7 @@ export function setupAdvancedMatchmaking(client) {
       teamVoiceIds: [],
       ...(is1v1 ? { captains: players.map(p => p.id) } : {})
     });
+    for (const p of players) markQueued(p.id, true).catch(() => {});
 
     if (is1v1) {
       await text.send(`Capitaines : <@${players[0].id}> et <@${players[1].id}>`);
@@ -276,6 +311,7 @@ export function setupAdvancedMatchmaking(client) {
           const body = { rl_name: name, rl_password: pwd };
           if (discordId === match.hostId)
             body.queue_type = match.queueType;
+          publishAssignment(playerId, body);
           if (creds.length) {
             await sbRequest('PATCH', `match_credentials?player_id=eq.${encodedId}`, { body }).catch(() => {});
           } else {
@@ -379,6 +415,7 @@ export async function handleMatchResult(data, client) {
       }
       await sbRequest('PATCH', `match_sessions?id=eq.${id}`, { body: { status: 'finished' } }).catch(() => {});
       activeMatches.delete(id);
+      for (const discordId of match.players) markQueued(discordId, false).catch(() => {});
       break;
     }
   }
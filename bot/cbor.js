@@ -0,0 +1,182 @@
+// Lecture des corps CBOR (RFC 8949) envoyés par le plugin avec
+// Content-Type: application/cbor (UPLOAD_FORMAT=cbor).
+//
+// Seul le sous-ensemble utile aux résultats de match est pris en charge :
+// entiers, chaînes, tableaux, tables (longueur définie ou non), booléens,
+// null et flottants. Les flottants 32 bits sont ramenés à leur plus courte
+// écriture décimale, comme dans le JSON du plugin (0.3 et non
+// 0.30000001192092896).
+
+// Profondeur maximale d'imbrication acceptée
+const MAX_DEPTH = 16;
+
+function shortestFloat32(value) {
+  if (!Number.isFinite(value)) return value;
+  for (let digits = 1; digits < 9; digits++) {
+    const candidate = Number(value.toPrecision(digits));
+    if (Math.fround(candidate) === value) return candidate;
+  }
+  return value;
+}
+
+function halfToNumber(bits) {
+  const exponent = (bits >> 10) & 0x1f;
+  const mantissa = bits & 0x3ff;
+  const sign = bits & 0x8000 ? -1 : 1;
+  if (exponent === 0) return sign * mantissa * 2 ** -24;
+  if (exponent === 31) return mantissa ? NaN : sign * Infinity;
+  return sign * (1 + mantissa / 1024) * 2 ** (exponent - 15);
+}
+
+class CborReader {
+  constructor(buffer) {
+    this.buffer = buffer;
+    this.view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
+    this.offset = 0;
+  }
+
+  need(size) {
+    if (this.offset + size > this.buffer.length) throw new Error('CBOR tronqué');
+  }
+
+  // Longueur ou valeur portée par la tête ; -1 pour une longueur indéfinie
+  argument(info) {
+    if (info < 24) return info;
+    let value;
+    switch (info) {
+      case 24:
+        this.need(1);
+        value = this.view.getUint8(this.offset);
+        this.offset += 1;
+        return value;
+      case 25:
+        this.need(2);
+        value = this.view.getUint16(this.offset);
+        this.offset += 2;
+        return value;
+      case 26:
+        this.need(4);
+        value = this.view.getUint32(this.offset);
+        this.offset += 4;
+        return value;
+      case 27: {
+        this.need(8);
+        const big = this.view.getBigUint64(this.offset);
+        this.offset += 8;
+        if (big > BigInt(Number.MAX_SAFE_INTEGER)) throw new Error('entier CBOR trop grand');
+        return Number(big);
+      }
+      case 31:
+        return -1;
+      default:
+        throw new Error('tête CBOR invalide');
+    }
+  }
+
+  bytes(length) {
+    if (length < 0) throw new Error('chaîne CBOR de longueur indéfinie non prise en charge');
+    this.need(length);
+    const out = this.buffer.subarray(this.offset, this.offset + length);
+    this.offset += length;
+    return out;
+  }
+
+  atBreak() {
+    this.need(1);
+    if (this.buffer[this.offset] !== 0xff) return false;
+    this.offset += 1;
+    return true;
+  }
+
+  read(depth = 0) {
+    if (depth > MAX_DEPTH) throw new Error('CBOR trop imbriqué');
+    this.need(1);
+    const head = this.buffer[this.offset++];
+    const major = head >> 5;
+    const info = head & 0x1f;
+
+    switch (major) {
+      case 0:
+        return this.argument(info);
+      case 1:
+        return -1 - this.argument(info);
+      case 2:
+        return Buffer.from(this.bytes(this.argument(info)));
+      case 3:
+        return this.bytes(this.argument(info)).toString('utf8');
+      case 4: {
+        const length = this.argument(info);
+        const list = [];
+        for (let i = 0; length < 0 ? !this.atBreak() : i < length; i++) {
+          list.push(this.read(depth + 1));
+        }
+        return list;
+      }
+      case 5: {
+        const length = this.argument(info);
+        const map = {};
+        for (let i = 0; length < 0 ? !this.atBreak() : i < length; i++) {
+          const key = this.read(depth + 1);
+          if (typeof key !== 'string' && typeof key !== 'number') {
+            throw new Error('clé CBOR non prise en charge');
+          }
+          // Pas de clé héritée de Object.prototype
+          Object.defineProperty(map, String(key), {
+            value: this.read(depth + 1),
+            enumerable: true,
+            writable: true,
+            configurable: true
+          });
+        }
+        return map;
+      }
+      case 6:
+        // Étiquette ignorée : seule la valeur compte
+        this.argument(info);
+        return this.read(depth + 1);
+      default:
+        return this.simple(info);
+    }
+  }
+
+  simple(info) {
+    switch (info) {
+      case 20:
+        return false;
+      case 21:
+        return true;
+      case 22:
+      case 23:
+        return null;
+      case 25: {
+        this.need(2);
+        const value = halfToNumber(this.view.getUint16(this.offset));
+        this.offset += 2;
+        return value;
+      }
+      case 26: {
+        this.need(4);
+        const value = shortestFloat32(this.view.getFloat32(this.offset));
+        this.offset += 4;
+        return value;
+      }
+      case 27: {
+        this.need(8);
+        const value = this.view.getFloat64(this.offset);
+        this.offset += 8;
+        return value;
+      }
+      default:
+        throw new Error('valeur CBOR simple non prise en charge');
+    }
+  }
+}
+
+// Décode un document CBOR complet ; lève une erreur s'il est invalide ou
+// suivi d'octets en trop.
+export function decodeCbor(buffer) {
+  const reader = new CborReader(buffer);
+  const value = reader.read();
+  if (reader.offset !== buffer.length) throw new Error('octets en trop après le document CBOR');
+  return value;
+}
@@ -0,0 +1,42 @@
+// Lecture des cartes de présence envoyées par le plugin (champ `heatmap`).
+//
+// La grille (`cols` × `rows` cases de `cellSize` unités, ligne 0 côté bleu)
+// est décrite une fois au niveau du match ; chaque carte est une chaîne
+// base64. Une fois décodée, chaque case non nulle est un entier variable
+// (LEB128) et une suite de cases nulles s'écrit 0 suivi de sa longueur.
+// Les valeurs sont des centièmes de seconde passés dans la case.
+
+function readVarint(bytes, state) {
+  let value = 0;
+  let shift = 0;
+  for (;;) {
+    if (state.offset >= bytes.length) throw new Error('carte de présence tronquée');
+    const byte = bytes[state.offset++];
+    value += (byte & 0x7f) * 2 ** shift;
+    if (!(byte & 0x80)) return value;
+    shift += 7;
+    if (shift > 28) throw new Error('entier trop long dans la carte de présence');
+  }
+}
+
+// Renvoie un Uint16Array de `cells` cases ; lève une erreur si la carte ne
+// couvre pas exactement la grille.
+export function decodeHeatmap(base64, cells) {
+  const bytes = Buffer.from(base64, 'base64');
+  const grid = new Uint16Array(cells);
+  const state = { offset: 0 };
+  let index = 0;
+  while (state.offset < bytes.length) {
+    const value = readVarint(bytes, state);
+    if (value === 0) {
+      const run = readVarint(bytes, state);
+      if (run === 0 || index + run > cells) throw new Error('suite de cases nulles invalide');
+      index += run;
+      continue;
+    }
+    if (index >= cells || value > 0xffff) throw new Error('case de carte de présence invalide');
+    grid[index++] = value;
+  }
+  if (index !== cells) throw new Error('carte de présence incomplète');
+  return grid;
+}
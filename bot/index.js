@@ -18,6 +18,7 @@ import express from 'express';
 import bodyParser from 'body-parser';
 import crypto from 'crypto';
 import https from 'https';
+import zlib from 'zlib';
 import helmet from 'helmet';
 import rateLimit from 'express-rate-limit';
 import cors from 'cors';
@@ -27,13 +28,17 @@ import { setupVerification, runVerificationSetup } from './verification.js';
 import { setupTeam } from './team.js';
 import { setupRegistration } from './registration.js';
 import { setupAdvancedMatchmaking, handleMatchResult } from './advancedMatchmaking.js';
+import { playerState, openPlayerStream, clearAssignment } from './playerChannel.js';
+import { recordMatchEvents, getLiveMatch } from './liveMatches.js';
+import { decodeCbor } from './cbor.js';
 
 const app = express();
-app.use(bodyParser.json({
-  verify: (req, res, buf) => {
-    req.rawBody = buf;
-  }
-}));
+// /match et /match/events lisent leur corps brut (voir plus bas) : la
+// signature porte sur les octets reçus, éventuellement compressés, en JSON
+// ou en CBOR selon Content-Type.
+const RAW_BODY_PATHS = new Set(['/match', '/match/batch', '/match/events']);
+const jsonParser = bodyParser.json();
+app.use((req, res, next) => (RAW_BODY_PATHS.has(req.path) ? next() : jsonParser(req, res, next)));
 app.use(helmet());
 
 const limiter = rateLimit({
@@ -42,7 +47,18 @@ const limiter = rateLimit({
   standardHeaders: true,
   legacyHeaders: false
 });
-app.use(limiter);
+// Routes appelées par le plugin : un match de 5 minutes envoie 60 à 70 lots
+// sur /match/events et /player est interrogé toutes les 3 s tant que le
+// joueur attend un match. Un lot refusé n'est pas renvoyé : ces routes ont
+// leur propre plafond, bien au-dessus de leur rythme normal.
+const PLUGIN_PATHS = new Set([...RAW_BODY_PATHS, '/player', '/player/stream']);
+const pluginLimiter = rateLimit({
+  windowMs: 15 * 60 * 1000,
+  max: 3000,
+  standardHeaders: true,
+  legacyHeaders: false
+});
+app.use((req, res, next) => (PLUGIN_PATHS.has(req.path) ? pluginLimiter : limiter)(req, res, next));
 
 const allowedOrigins = process.env.CORS_ORIGIN ? process.env.CORS_ORIGIN.split(',') : [];
 if (allowedOrigins.length > 0) {
@@ -73,10 +89,22 @@ const client = new Client({
 });
 const matchData = new Map();
 const recentMatches = new Set();
+// uploadId des résultats déjà traités : un plugin qui renvoie un résultat
+// depuis son journal (réponse perdue, plantage) n'est pas compté deux fois.
+const UPLOAD_ID_TTL = 7 * 24 * 60 * 60 * 1000;
+const MAX_UPLOAD_IDS = 10000;
+const seenUploads = new Map(); // uploadId -> date de réception
 
 const sanitizeString = str =>
   String(str || '').replace(/[^\w\sÀ-ÿ.'-]/g, '');
 
+// Possession d'une équipe, calculée par le plugin à partir des touches
+const teamPossessionSchema = Joi.object({
+  time: Joi.number().min(0).required(),
+  chains: Joi.number().integer().min(0).required(),
+  averageChain: Joi.number().min(0).required()
+});
+
 const matchSchema = Joi.object({
   scoreBlue: Joi.number().min(0).required(),
   scoreOrange: Joi.number().min(0).required(),
@@ -84,6 +112,8 @@ const matchSchema = Joi.object({
   teamOrange: Joi.string().default('Orange'),
   scorers: Joi.array().items(Joi.string().allow('')).default([]),
   mvp: Joi.string().allow('').default(''),
+  // Secondes jouees apres le temps reglementaire
+  overtime: Joi.number().integer().min(0).default(0),
   players: Joi.array()
     .items(
       Joi.object({
@@ -95,6 +125,22 @@ const matchSchema = Joi.object({
         shots: Joi.number().min(0).required(),
         saves: Joi.number().min(0).required(),
         expectedGoals: Joi.number().min(0).default(0),
+        // Tirs et xG par contexte (double_tap, open_net, aerial...)
+        shotContexts: Joi.object()
+          .pattern(
+            Joi.string().max(32),
+            Joi.object({
+              count: Joi.number().integer().min(0).required(),
+              xg: Joi.number().min(0).required()
+            })
+          )
+          .default({}),
+        // Carte de presence encodee (voir heatmap.js)
+        heatmap: Joi.string().base64().max(8192),
+        // Agregats de la session du plugin : [moyenne, ecart-type, forme, min, max]
+        session: Joi.object({
+          matches: Joi.number().integer().min(1).required()
+        }).pattern(Joi.string().max(32), Joi.array().items(Joi.number()).length(5)),
         clearances: Joi.number().min(0).default(0),
         defensiveChallenges: Joi.number().min(0).default(0),
         offensiveDemos: Joi.number().min(0).default(0),
@@ -105,14 +151,107 @@ const matchSchema = Joi.object({
         highPressings: Joi.number().min(0).default(0),
         boostPickups: Joi.number().min(0).default(0),
         wastedBoostPickups: Joi.number().min(0).default(0),
+        // Ramassages de boost par seconde de jeu
+        boostFrequency: Joi.number().min(0).default(0),
+        rotationQuality: Joi.number().min(0).max(1),
+        // Part du temps passe a chaque place de la rotation (1 = le plus proche du ballon)
+        role1Frequency: Joi.number().min(0).max(1).default(0),
+        role2Frequency: Joi.number().min(0).max(1).default(0),
+        role3Frequency: Joi.number().min(0).max(1).default(0),
+        role4Frequency: Joi.number().min(0).max(1).default(0),
+        // Secondes passees dans sa moitie du terrain
+        defenseTime: Joi.number().min(0).default(0),
+        blocks: Joi.number().min(0).default(0),
+        ballTouches: Joi.number().min(0).default(0),
+        aerialTouches: Joi.number().min(0).default(0),
+        doubleCommits: Joi.number().min(0).default(0),
         playstyleScore: Joi.number().default(0),
         auusaNote: Joi.string().allow('').default('')
-      }).unknown(false)
+      })
+        // Le plugin envoie le total des xG sous le nom court
+        .rename('xg', 'expectedGoals', { ignoreUndefined: true })
+        .unknown(false)
     )
     .min(1)
     .required(),
   duration: Joi.string().default('5:00'),
-  map: Joi.string().allow('').default('')
+  map: Joi.string().allow('').default(''),
+  uploadId: Joi.string().max(64),
+  playedAt: Joi.number().integer().min(0),
+  possession: Joi.object({
+    blue: teamPossessionSchema,
+    orange: teamPossessionSchema,
+    passes: Joi.array()
+      .items(
+        Joi.object({
+          from: Joi.string().allow('').required(),
+          to: Joi.string().allow('').required(),
+          count: Joi.number().integer().min(1).required()
+        })
+      )
+      .max(256)
+      .default([])
+  }),
+  heatmap: Joi.object({
+    cols: Joi.number().integer().min(1).max(256).required(),
+    rows: Joi.number().integer().min(1).max(256).required(),
+    cellSize: Joi.number().min(1).required(),
+    ball: Joi.string().base64().max(8192).allow('')
+  }),
+  // Latence des hooks du plugin depuis l'envoi precedent (mm_perf_upload), en microsecondes
+  perf: Joi.object().pattern(
+    Joi.string().max(32),
+    Joi.object({
+      count: Joi.number().integer().min(1).required(),
+      p50: Joi.number().min(0).required(),
+      p99: Joi.number().min(0).required(),
+      max: Joi.number().min(0).required()
+    })
+  )
+});
+
+// Lot envoyé pendant le match par le plugin (mm_stream)
+const matchEventsSchema = Joi.object({
+  matchId: Joi.string().max(64).required(),
+  seq: Joi.number().integer().min(1).required(),
+  final: Joi.boolean().default(false),
+  time: Joi.number().min(0).default(0),
+  scoreBlue: Joi.number().min(0).default(0),
+  scoreOrange: Joi.number().min(0).default(0),
+  reporter: Joi.string().allow('').default(''),
+  lostBatches: Joi.number().min(0).default(0),
+  events: Joi.array()
+    .items(
+      Joi.object({
+        type: Joi.string().valid('goal', 'demo', 'touch').required(),
+        time: Joi.number().required(),
+        player: Joi.string().allow('').default(''),
+        victim: Joi.string().allow(''),
+        xg: Joi.number().min(0),
+        scoreBlue: Joi.number().min(0),
+        scoreOrange: Joi.number().min(0)
+      })
+    )
+    .max(512)
+    .default([]),
+  players: Joi.array()
+    .items(
+      Joi.object({
+        name: Joi.string().required(),
+        team: Joi.number().valid(0, 1).required(),
+        goals: Joi.number(),
+        assists: Joi.number(),
+        shots: Joi.number(),
+        saves: Joi.number(),
+        touches: Joi.number(),
+        clearances: Joi.number(),
+        demos: Joi.number(),
+        boostPickups: Joi.number(),
+        expectedGoals: Joi.number()
+      })
+    )
+    .max(16)
+    .default([])
 });
 
 const playerSchema = Joi.object({
@@ -236,7 +375,9 @@ function translateMap(raw) {
 function getMatchSignature(payload) {
   const players = payload.players.map(p => p.name).sort().join('|');
   const totalGoals = payload.scoreBlue + payload.scoreOrange;
-  const minuteBucket = Math.floor(Date.now() / 60000);
+  // Un résultat renvoyé depuis le journal du plugin porte l'heure de fin du
+  // match : deux matchs identiques rejoués en même temps restent distincts.
+  const minuteBucket = Math.floor((payload.playedAt ? payload.playedAt * 1000 : Date.now()) / 60000);
   return `${payload.scoreBlue}-${payload.scoreOrange}-${totalGoals}-${players}-${minuteBucket}`;
 }
 setupMatchmaking(client);
@@ -327,12 +468,63 @@ async function runChannelSetup(interaction) {
   await interaction.reply('Canal enregistré pour les résultats de match.');
 }
 
-app.post('/match', async (req, res) => {
+// Taille maximale d'un résultat de match une fois décompressé
+const MAX_MATCH_BODY = 1024 * 1024;
+// Envoi groupé des résultats en attente dans le journal du plugin
+const MAX_BATCH_BODY = 4 * 1024 * 1024;
+const MAX_BATCH_MATCHES = 50;
+
+// Décompresse le corps selon Content-Encoding. Renvoie null si l'encodage
+// n'est pas pris en charge ; lève une erreur si le corps est invalide.
+function decodeBody(raw, encoding, limit = MAX_MATCH_BODY) {
+  const options = { maxOutputLength: limit };
+  switch ((encoding || 'identity').toLowerCase()) {
+    case 'identity':
+      return raw;
+    case 'gzip':
+      return zlib.gunzipSync(raw, options);
+    case 'deflate':
+      return zlib.inflateSync(raw, options);
+    case 'br':
+      return zlib.brotliDecompressSync(raw, options);
+    case 'zstd':
+      return typeof zlib.zstdDecompressSync === 'function'
+        ? zlib.zstdDecompressSync(raw, options)
+        : null;
+    default:
+      return null;
+  }
+}
+
+// Formats acceptés pour les corps signés du plugin
+const SIGNED_BODY_TYPES = ['application/json', 'application/cbor'];
+
+const matchBodyParser = express.raw({
+  type: SIGNED_BODY_TYPES,
+  inflate: false,
+  limit: MAX_MATCH_BODY
+});
+
+const batchBodyParser = express.raw({
+  type: SIGNED_BODY_TYPES,
+  inflate: false,
+  limit: MAX_BATCH_BODY
+});
+
+// Vérifie la signature du corps brut puis le décompresse et le lit (JSON
+// ou CBOR). Renvoie undefined après avoir répondu si la requête est refusée ;
+// un format inconnu reçoit 415 et le plugin renvoie alors le corps en JSON.
+function readSignedBody(req, res, limit = MAX_MATCH_BODY) {
   if (!API_SECRET) {
-    return res.sendStatus(401);
+    res.sendStatus(401);
+    return undefined;
+  }
+  if (req.get('content-type') && !req.is(SIGNED_BODY_TYPES)) {
+    res.sendStatus(415);
+    return undefined;
   }
   const headerSignature = req.get('x-signature') || '';
-  const rawBody = req.rawBody || '';
+  const rawBody = Buffer.isBuffer(req.body) ? req.body : Buffer.alloc(0);
   const expectedSignature = crypto
     .createHmac('sha256', API_SECRET)
     .update(rawBody)
@@ -345,25 +537,71 @@ app.post('/match', async (req, res) => {
       Buffer.from(expectedSignature, 'utf8')
     )
   ) {
-    return res.sendStatus(401);
+    res.sendStatus(401);
+    return undefined;
   }
 
-  const { error, value } = matchSchema.validate(req.body, {
+  try {
+    const decoded = decodeBody(rawBody, req.get('content-encoding'), limit);
+    if (!decoded) {
+      res.sendStatus(415);
+      return undefined;
+    }
+    if (req.is('application/cbor')) return decodeCbor(decoded);
+    return JSON.parse(decoded.toString('utf8'));
+  } catch {
+    res.status(400).json({ error: ['corps JSON ou CBOR invalide'] });
+    return undefined;
+  }
+}
+
+function alreadyUploaded(uploadId) {
+  const now = Date.now();
+  for (const [id, receivedAt] of seenUploads) {
+    if (now - receivedAt <= UPLOAD_ID_TTL && seenUploads.size <= MAX_UPLOAD_IDS) break;
+    seenUploads.delete(id);
+  }
+  if (seenUploads.has(uploadId)) return true;
+  seenUploads.set(uploadId, now);
+  return false;
+}
+
+// Valide et publie un résultat de match. Renvoie le code HTTP de la réponse
+// et, pour un résultat invalide, le détail des erreurs.
+async function processMatchResult(body) {
+  const { error, value } = matchSchema.validate(body, {
     abortEarly: false
   });
   if (error) {
-    return res.status(400).json({
-      error: error.details.map(d => d.message)
-    });
+    return { status: 400, error: error.details.map(d => d.message) };
+  }
+  if (value.uploadId && alreadyUploaded(value.uploadId)) {
+    return { status: 200 };
   }
   const payload = sanitizePayload(value);
   const signature = getMatchSignature(payload);
   if (recentMatches.has(signature)) {
-    return res.sendStatus(200);
+    return { status: 200 };
   }
   recentMatches.add(signature);
   setTimeout(() => recentMatches.delete(signature), 10000);
+  // Match terminé : ses identifiants ne doivent plus être rejoués
+  for (const p of value.players) clearAssignment(p.name);
 
+  try {
+    await publishMatchResult(payload);
+  } catch (err) {
+    // Rien n'a été publié : le renvoi du même résultat par le plugin doit
+    // être traité à nouveau, pas acquitté comme un doublon.
+    if (value.uploadId) seenUploads.delete(value.uploadId);
+    recentMatches.delete(signature);
+    throw err;
+  }
+  return { status: 200 };
+}
+
+// Publie le message de fin de match et met à jour les classements.
+async function publishMatchResult(payload) {
   const {
     scoreBlue,
     scoreOrange,
@@ -386,7 +624,7 @@ app.post('/match', async (req, res) => {
     const bluePlayers = players.filter(p => p.team === 0);
     const orangePlayers = players.filter(p => p.team === 1);
 
-    const matchDateStr = new Date().toLocaleDateString('fr-FR', {
+    const matchDateStr = new Date(payload.playedAt ? payload.playedAt * 1000 : Date.now()).toLocaleDateString('fr-FR', {
       day: 'numeric',
       month: 'long',
       year: 'numeric'
@@ -506,9 +744,81 @@ app.post('/match', async (req, res) => {
     matchData.set(message.id, players);
     await handleMatchResult(payload, client);
   }
+}
+
+app.post('/match', matchBodyParser, async (req, res) => {
+  const body = readSignedBody(req, res);
+  if (body === undefined) return;
+
+  try {
+    const { status, error } = await processMatchResult(body);
+    if (error) {
+      return res.status(status).json({ error });
+    }
+    res.sendStatus(status);
+  } catch (err) {
+    // Le plugin garde le résultat dans son journal et le renverra
+    console.error('Erreur lors du traitement d\'un résultat :', err);
+    res.sendStatus(500);
+  }
+});
+
+// Résultats en attente dans le journal du plugin, envoyés ensemble après
+// une panne : { matches: [...] } -> { results: [code HTTP par résultat] }.
+app.post('/match/batch', batchBodyParser, async (req, res) => {
+  const body = readSignedBody(req, res, MAX_BATCH_BODY);
+  if (body === undefined) return;
+  if (!Array.isArray(body?.matches) || body.matches.length > MAX_BATCH_MATCHES) {
+    return res.status(400).json({ error: ['matches doit être une liste de 50 résultats au plus'] });
+  }
+
+  const results = [];
+  for (const match of body.matches) {
+    try {
+      results.push((await processMatchResult(match)).status);
+    } catch (err) {
+      console.error('Erreur lors du traitement d\'un résultat groupé :', err);
+      results.push(500);
+    }
+  }
+  res.json({ results });
+});
+
+app.post('/match/events', matchBodyParser, (req, res) => {
+  const body = readSignedBody(req, res);
+  if (body === undefined) return;
+
+  const { error, value } = matchEventsSchema.validate(body, {
+    abortEarly: false
+  });
+  if (error) {
+    return res.status(400).json({
+      error: error.details.map(d => d.message)
+    });
+  }
+  // Le rapporteur est en match : son attribution est consommée
+  if (value.reporter) clearAssignment(value.reporter);
+  // Un lot déjà reçu est acquitté sans être appliqué une seconde fois
+  recordMatchEvents({
+    ...value,
+    reporter: sanitizeString(value.reporter),
+    events: value.events.map(e => ({
+      ...e,
+      player: sanitizeString(e.player),
+      ...(e.victim !== undefined && { victim: sanitizeString(e.victim) })
+    })),
+    players: value.players.map(p => ({ ...p, name: sanitizeString(p.name) }))
+  });
   res.sendStatus(200);
 });
 
+app.get('/match/live/:matchId', (req, res) => {
+  const match = getLiveMatch(req.params.matchId);
+  if (!match) return res.sendStatus(404);
+  res.set('Cache-Control', 'no-cache');
+  res.json(match);
+});
+
 app.get('/player', (req, res) => {
   const { error } = playerSchema.validate(req.query, { abortEarly: false });
   if (error) {
@@ -516,7 +826,20 @@ app.get('/player', (req, res) => {
       error: error.details.map(d => d.message)
     });
   }
-  res.json({});
+  // Express calcule un ETag faible sur la réponse et renvoie 304 quand le
+  // plugin présente le même dans If-None-Match : pas de cache intermédiaire.
+  res.set('Cache-Control', 'no-cache');
+  res.json(playerState(req.query.player_id));
+});
+
+app.get('/player/stream', (req, res) => {
+  const { error } = playerSchema.validate(req.query, { abortEarly: false });
+  if (error) {
+    return res.status(400).json({
+      error: error.details.map(d => d.message)
+    });
+  }
+  openPlayerStream(req, res, req.query.player_id);
 });
 
 client.once('ready', async () => {
@@ -0,0 +1,116 @@
+// Matchs suivis en direct à partir des lots envoyés par le plugin
+// (mm_stream, POST /match/events).
+//
+// Chaque lot porte un identifiant de match et un numéro de séquence : un lot
+// déjà reçu (renvoi après une coupure réseau) est ignoré, un trou dans la
+// séquence signale un lot perdu. Les compteurs des joueurs arrivent sous
+// forme de variations et sont additionnés ici.
+
+// Un match sans nouveau lot depuis 2 heures est oublié.
+const MATCH_TTL = 2 * 60 * 60 * 1000;
+// Nombre maximal de matchs suivis en même temps ; le plus ancien est oublié.
+const MAX_LIVE_MATCHES = 500;
+// Derniers événements gardés par match (fil du direct).
+const MAX_RECENT_EVENTS = 50;
+
+const COUNTERS = [
+  'goals',
+  'assists',
+  'shots',
+  'saves',
+  'touches',
+  'clearances',
+  'demos',
+  'boostPickups',
+  'expectedGoals'
+];
+
+const matches = new Map(); // matchId -> état du match
+
+function expire(now) {
+  for (const [id, match] of matches) {
+    if (now - match.updatedAt > MATCH_TTL) matches.delete(id);
+  }
+  while (matches.size > MAX_LIVE_MATCHES) {
+    matches.delete(matches.keys().next().value);
+  }
+}
+
+// Applique un lot. Renvoie { duplicate: true } si ce lot a déjà été reçu.
+export function recordMatchEvents(batch) {
+  const now = Date.now();
+  expire(now);
+
+  let match = matches.get(batch.matchId);
+  if (!match) {
+    match = {
+      matchId: batch.matchId,
+      reporter: batch.reporter || '',
+      seqs: new Set(),
+      maxSeq: 0,
+      time: 0,
+      scoreBlue: 0,
+      scoreOrange: 0,
+      final: false,
+      players: new Map(),
+      events: [],
+      updatedAt: now
+    };
+    matches.set(batch.matchId, match);
+  }
+  if (match.seqs.has(batch.seq)) return { duplicate: true };
+  match.seqs.add(batch.seq);
+  match.updatedAt = now;
+
+  // Les lots peuvent arriver dans le désordre : le score et le temps ne
+  // sont repris que du lot le plus récent.
+  if (batch.seq > match.maxSeq) {
+    match.maxSeq = batch.seq;
+    match.time = batch.time;
+    match.scoreBlue = batch.scoreBlue;
+    match.scoreOrange = batch.scoreOrange;
+  }
+  if (batch.final) match.final = true;
+
+  for (const delta of batch.players) {
+    const player = match.players.get(delta.name) || { name: delta.name, team: delta.team };
+    player.team = delta.team;
+    for (const key of COUNTERS) {
+      if (delta[key]) player[key] = (player[key] || 0) + delta[key];
+    }
+    match.players.set(delta.name, player);
+  }
+
+  match.events.push(...batch.events);
+  match.events.sort((a, b) => a.time - b.time);
+  if (match.events.length > MAX_RECENT_EVENTS) {
+    match.events.splice(0, match.events.length - MAX_RECENT_EVENTS);
+  }
+  return { duplicate: false };
+}
+
+export function getLiveMatch(matchId) {
+  const match = matches.get(matchId);
+  if (!match || Date.now() - match.updatedAt > MATCH_TTL) return null;
+  // Lots manquants entre 1 et le dernier reçu
+  const missing = [];
+  for (let seq = 1; seq < match.maxSeq; seq++) {
+    if (!match.seqs.has(seq)) missing.push(seq);
+  }
+  return {
+    matchId: match.matchId,
+    reporter: match.reporter,
+    time: match.time,
+    scoreBlue: match.scoreBlue,
+    scoreOrange: match.scoreOrange,
+    final: match.final,
+    lastSeq: match.maxSeq,
+    missingSeqs: missing,
+    players: [...match.players.values()],
+    events: match.events
+  };
+}
+
+export function clearLiveMatches() {
+  matches.clear();
+}
@@ -0,0 +1,132 @@
+// Diffusion des identifiants de partie aux plugins connectés.
+//
+// Chaque joueur a au plus une attribution en cours (rl_name, rl_password,
+// queue_type éventuel). Les plugins l'obtiennent soit en interrogeant
+// GET /player, soit en gardant ouverte une connexion GET /player/stream
+// (Server-Sent Events) qui la reçoit dès sa création. Elle porte son
+// identifiant (`id`, croissant) pour que le plugin ignore une attribution
+// déjà traitée, et disparaît dès que le joueur est en match (premier lot de
+// /match/events) ou que son résultat arrive : un plugin relancé ne rejoint
+// pas une partie terminée.
+
+// Les salons temporaires d'un match expirent après 2 heures : une
+// attribution plus ancienne ne désigne plus une partie valide.
+const ASSIGNMENT_TTL = 2 * 60 * 60 * 1000;
+// Commentaire envoyé régulièrement pour que les proxys et le plugin
+// détectent une connexion coupée.
+const HEARTBEAT_INTERVAL = 25 * 1000;
+
+// Un joueur reste signalé en file au plus 30 minutes si son départ de la
+// file n'a pas été vu (bot redémarré, événement vocal perdu).
+const QUEUE_TTL = 30 * 60 * 1000;
+
+const assignments = new Map(); // player_id -> { id, data, createdAt }
+const queued = new Map(); // player_id -> date d'entrée en file
+const streams = new Map(); // player_id -> Set<res>
+// Identifiants croissants même après un redémarrage du bot, pour que le
+// Last-Event-ID d'un plugin ne masque pas une attribution plus récente.
+let sequence = 0;
+
+function currentAssignment(playerId) {
+  const entry = assignments.get(playerId);
+  if (!entry) return null;
+  if (Date.now() - entry.createdAt > ASSIGNMENT_TTL) {
+    assignments.delete(playerId);
+    return null;
+  }
+  return entry;
+}
+
+function toJson(entry) {
+  return { id: entry.id, ...entry.data };
+}
+
+function writeEvent(res, entry) {
+  res.write(`id: ${entry.id}\nevent: assignment\ndata: ${JSON.stringify(toJson(entry))}\n\n`);
+}
+
+// Enregistre la nouvelle attribution et la pousse aux connexions ouvertes.
+// Le joueur n'attend plus : il quitte la file.
+export function publishAssignment(playerId, data) {
+  sequence = Math.max(sequence + 1, Date.now());
+  const entry = { id: sequence, data, createdAt: Date.now() };
+  assignments.set(playerId, entry);
+  queued.delete(playerId);
+  for (const res of streams.get(playerId) || []) writeEvent(res, entry);
+}
+
+export function getAssignment(playerId) {
+  const entry = currentAssignment(playerId);
+  return entry ? toJson(entry) : null;
+}
+
+// Le joueur a rejoint sa partie ou l'a terminée : l'attribution n'est plus
+// renvoyée, ni par GET /player ni à l'ouverture du flux.
+export function clearAssignment(playerId) {
+  assignments.delete(playerId);
+}
+
+export function clearAssignments() {
+  assignments.clear();
+  queued.clear();
+}
+
+// Joueur dans une file de matchmaking ou dans un salon de match qui attend
+// ses identifiants : le plugin garde alors son interrogation rapide.
+export function setQueued(playerId, value) {
+  if (value) queued.set(playerId, Date.now());
+  else queued.delete(playerId);
+}
+
+export function isQueued(playerId) {
+  const since = queued.get(playerId);
+  if (since === undefined) return false;
+  if (Date.now() - since > QUEUE_TTL) {
+    queued.delete(playerId);
+    return false;
+  }
+  return true;
+}
+
+// Réponse de GET /player : l'attribution en cours, avec "queued": true
+// tant que le joueur attend un match.
+export function playerState(playerId) {
+  const data = getAssignment(playerId) || {};
+  return isQueued(playerId) ? { ...data, queued: true } : data;
+}
+
+// Ouvre le flux SSE d'un joueur. L'attribution en cours est renvoyée tout de
+// suite, sauf si le plugin l'a déjà reçue (en-tête Last-Event-ID).
+export function openPlayerStream(req, res, playerId) {
+  res.status(200).set({
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    Connection: 'keep-alive',
+    'X-Accel-Buffering': 'no'
+  });
+  res.flushHeaders();
+  res.write(`retry: 3000\n\n`);
+
+  const lastId = Number(req.get('Last-Event-ID')) || 0;
+  const entry = currentAssignment(playerId);
+  if (entry && entry.id > lastId) writeEvent(res, entry);
+
+  if (!streams.has(playerId)) streams.set(playerId, new Set());
+  streams.get(playerId).add(res);
+
+  const heartbeat = setInterval(() => res.write(': ping\n\n'), HEARTBEAT_INTERVAL);
+  heartbeat.unref?.();
+  req.on('close', () => {
+    clearInterval(heartbeat);
+    const set = streams.get(playerId);
+    if (!set) return;
+    set.delete(res);
+    if (set.size === 0) streams.delete(playerId);
+  });
+}
+
+export function openStreamCount() {
+  let count = 0;
+  for (const set of streams.values()) count += set.size;
+  return count;
+}
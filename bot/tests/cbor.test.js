@@ -0,0 +1,154 @@
+import request from 'supertest';
+import crypto from 'crypto';
+
+process.env.NODE_ENV = 'test';
+process.env.API_SECRET = 'secret-test';
+
+const { default: app } = await import('../index.js');
+const { decodeCbor } = await import('../cbor.js');
+
+// Encodeur minimal, au format du plugin : longueurs définies, flottants
+// en 32 bits.
+function head(major, value) {
+  if (value < 24) return Buffer.from([(major << 5) | value]);
+  if (value < 0x100) return Buffer.from([(major << 5) | 24, value]);
+  if (value < 0x10000) {
+    const b = Buffer.alloc(3);
+    b[0] = (major << 5) | 25;
+    b.writeUInt16BE(value, 1);
+    return b;
+  }
+  const b = Buffer.alloc(5);
+  b[0] = (major << 5) | 26;
+  b.writeUInt32BE(value, 1);
+  return b;
+}
+
+function encodeCbor(value) {
+  if (value === null) return Buffer.from([0xf6]);
+  if (typeof value === 'boolean') return Buffer.from([value ? 0xf5 : 0xf4]);
+  if (typeof value === 'string') {
+    const text = Buffer.from(value, 'utf8');
+    return Buffer.concat([head(3, text.length), text]);
+  }
+  if (typeof value === 'number') {
+    if (Number.isInteger(value)) return value >= 0 ? head(0, value) : head(1, -1 - value);
+    const b = Buffer.alloc(5);
+    b[0] = 0xfa;
+    b.writeFloatBE(value, 1);
+    return b;
+  }
+  if (Array.isArray(value)) {
+    return Buffer.concat([head(4, value.length), ...value.map(encodeCbor)]);
+  }
+  const entries = Object.entries(value);
+  return Buffer.concat([
+    head(5, entries.length),
+    ...entries.flatMap(([k, v]) => [encodeCbor(k), encodeCbor(v)])
+  ]);
+}
+
+const sign = body =>
+  crypto
+    .createHmac('sha256', process.env.API_SECRET)
+    .update(body)
+    .digest('hex');
+
+describe('decodeCbor', () => {
+  test('relit les types écrits par le plugin', () => {
+    const value = {
+      name: 'Équipe "A"',
+      goals: 3,
+      delta: -2,
+      big: 70000,
+      xg: 0.3,
+      ok: true,
+      none: null,
+      list: [1, 'deux', { trois: 3 }]
+    };
+    expect(decodeCbor(encodeCbor(value))).toEqual(value);
+  });
+
+  test('ramène les flottants 32 bits à leur écriture courte', () => {
+    expect(decodeCbor(encodeCbor(0.1))).toBe(0.1);
+    expect(decodeCbor(encodeCbor(2.171638))).toBe(2.171638);
+  });
+
+  test('accepte les longueurs indéfinies et les demi-flottants', () => {
+    expect(decodeCbor(Buffer.from([0xbf, 0x61, 0x61, 0x9f, 0x01, 0xff, 0xff]))).toEqual({ a: [1] });
+    expect(decodeCbor(Buffer.from([0xf9, 0x3c, 0x00]))).toBe(1);
+  });
+
+  test('rejette un document tronqué ou suivi d\'octets en trop', () => {
+    expect(() => decodeCbor(Buffer.from([0xa1, 0x61]))).toThrow();
+    expect(() => decodeCbor(Buffer.from([0xa0, 0x00]))).toThrow();
+  });
+
+  test('ne laisse pas une clé modifier le prototype', () => {
+    const decoded = decodeCbor(encodeCbor({ __proto__x: 1 }));
+    const polluted = decodeCbor(Buffer.concat([head(5, 1), encodeCbor('__proto__'), encodeCbor({ admin: true })]));
+    expect(decoded.__proto__x).toBe(1);
+    expect({}.admin).toBeUndefined();
+    expect(Object.getPrototypeOf(polluted)).toBe(Object.prototype);
+  });
+});
+
+describe('POST /match en CBOR', () => {
+  const payload = {
+    scoreBlue: 2,
+    scoreOrange: 1,
+    teamBlue: 'Bleu',
+    teamOrange: 'Orange',
+    map: 'Stadium',
+    mvp: 'Alice',
+    playedAt: 1700000000,
+    uploadId: '42',
+    scorers: ['Alice'],
+    players: [
+      { name: 'Alice', team: 0, score: 300, goals: 2, assists: 0, shots: 3, saves: 0, expectedGoals: 1.25,
+        shotContexts: { open_net: { count: 1, xg: 0.75 }, aerial: { count: 2, xg: 0.5 } } },
+      { name: 'Bob', team: 1, score: 120, goals: 1, assists: 0, shots: 1, saves: 2, expectedGoals: 0.4 }
+    ]
+  };
+
+  test('accepte un résultat CBOR signé', async () => {
+    const body = encodeCbor(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/cbor')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('accepte un envoi groupé CBOR', async () => {
+    const body = encodeCbor({ matches: [{ ...payload, uploadId: '43' }, { scoreBlue: 1 }] });
+    const res = await request(app)
+      .post('/match/batch')
+      .set('Content-Type', 'application/cbor')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+    expect(res.body.results).toEqual([200, 400]);
+  });
+
+  test('retourne 400 si le CBOR est invalide', async () => {
+    const body = Buffer.from([0xa1, 0x61]);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/cbor')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(400);
+  });
+
+  test('retourne 415 pour un format inconnu', async () => {
+    const body = Buffer.from('scoreBlue=1');
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/x-www-form-urlencoded')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(415);
+  });
+});
@@ -0,0 +1,67 @@
+import request from 'supertest';
+import crypto from 'crypto';
+
+process.env.NODE_ENV = 'test';
+process.env.API_SECRET = 'secret-test';
+
+const { default: app } = await import('../index.js');
+const { decodeHeatmap } = await import('../heatmap.js');
+
+const sign = body =>
+  crypto
+    .createHmac('sha256', process.env.API_SECRET)
+    .update(body)
+    .digest('hex');
+
+// 2 cases nulles, 5, 300 (deux octets), puis 4 cases nulles
+const sample = Buffer.from([0x00, 0x02, 0x05, 0xac, 0x02, 0x00, 0x04]).toString('base64');
+
+describe('decodeHeatmap', () => {
+  test('relit les cases et les suites de cases nulles', () => {
+    expect(Array.from(decodeHeatmap(sample, 8))).toEqual([0, 0, 5, 300, 0, 0, 0, 0]);
+  });
+
+  test('rejette une carte qui ne couvre pas la grille', () => {
+    expect(() => decodeHeatmap(sample, 7)).toThrow();
+    expect(() => decodeHeatmap(sample, 9)).toThrow();
+  });
+
+  test('rejette une carte tronquée', () => {
+    expect(() => decodeHeatmap(Buffer.from([0x05, 0xac]).toString('base64'), 2)).toThrow();
+  });
+});
+
+describe('POST /match avec cartes de présence', () => {
+  const payload = {
+    scoreBlue: 1,
+    scoreOrange: 0,
+    teamBlue: 'Bleu',
+    teamOrange: 'Orange',
+    scorers: ['Alice'],
+    mvp: 'Alice',
+    heatmap: { cols: 4, rows: 2, cellSize: 256, ball: sample },
+    players: [
+      { name: 'Alice', team: 0, score: 100, goals: 1, assists: 0, shots: 1, saves: 0, heatmap: sample }
+    ]
+  };
+
+  test('accepte les cartes du plugin', async () => {
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('rejette une carte qui n\'est pas en base64', async () => {
+    const body = JSON.stringify({ ...payload, players: [{ ...payload.players[0], heatmap: '%%%' }] });
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(400);
+  });
+});
@@ -1,10 +1,12 @@
 import request from 'supertest';
 import crypto from 'crypto';
+import zlib from 'zlib';
 
 process.env.NODE_ENV = 'test';
 process.env.API_SECRET = 'secret-test';
 
 const { default: app } = await import('../index.js');
+const { publishAssignment } = await import('../playerChannel.js');
 
 describe('POST /match', () => {
   const basePayload = {
@@ -44,6 +46,48 @@ describe('POST /match', () => {
     expect(res.status).toBe(200);
   });
 
+  test('accepte tous les champs joueur envoyés par le plugin', async () => {
+    const payload = {
+      ...basePayload,
+      scoreBlue: 3,
+      overtime: 47,
+      players: [
+        {
+          ...basePayload.players[0],
+          goals: 3,
+          boostPickups: 12,
+          wastedBoostPickups: 2,
+          boostFrequency: 0.04,
+          rotationQuality: 0.72,
+          role1Frequency: 0.3,
+          role2Frequency: 0.3,
+          role3Frequency: 0.2,
+          role4Frequency: 0.2,
+          cuts: 1,
+          clearances: 3,
+          defensiveChallenges: 2,
+          defensiveDemos: 0,
+          defenseTime: 140.5,
+          clutchSaves: 0,
+          blocks: 1,
+          ballTouches: 40,
+          highPressings: 2,
+          aerialTouches: 5,
+          missedOpenGoals: 0,
+          doubleCommits: 1,
+          xg: 0.8,
+          shotContexts: {}
+        }
+      ]
+    };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('x-signature', sign(body))
+      .send(payload);
+    expect(res.status).toBe(200);
+  });
+
   test('rejette une requête non signée', async () => {
     const res = await request(app).post('/match').send(basePayload);
     expect(res.status).toBe(401);
@@ -56,6 +100,50 @@ describe('POST /match', () => {
     expect(res.status).toBe(400);
   });
 
+  test('accepte un corps gzip signé sur les octets envoyés', async () => {
+    const body = zlib.gzipSync(JSON.stringify(basePayload));
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('Content-Encoding', 'gzip')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('rejette un corps gzip signé avant compression', async () => {
+    const json = JSON.stringify(basePayload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('Content-Encoding', 'gzip')
+      .set('x-signature', sign(json))
+      .send(zlib.gzipSync(json));
+    expect(res.status).toBe(401);
+  });
+
+  test('retourne 415 pour un encodage inconnu', async () => {
+    const body = Buffer.from(JSON.stringify(basePayload));
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('Content-Encoding', 'compress')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(415);
+  });
+
+  test('retourne 400 si le corps gzip est corrompu', async () => {
+    const body = Buffer.from('pas du gzip');
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('Content-Encoding', 'gzip')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(400);
+  });
+
   test('retourne 400 si le corps est invalide', async () => {
     const invalidPayload = { scoreBlue: 1, scoreOrange: 0 };
     const body = JSON.stringify(invalidPayload);
@@ -65,4 +153,152 @@ describe('POST /match', () => {
       .send(invalidPayload);
     expect(res.status).toBe(400);
   });
+
+  test('accepte un résultat renvoyé avec uploadId et playedAt', async () => {
+    const payload = { ...basePayload, uploadId: '1234567890', playedAt: 1700000000 };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('accepte la possession et le réseau de passes', async () => {
+    const payload = {
+      ...basePayload,
+      possession: {
+        blue: { time: 160.5, chains: 42, averageChain: 1.8 },
+        orange: { time: 120, chains: 40, averageChain: 1.5 },
+        passes: [{ from: 'Alice', to: 'Bob', count: 3 }]
+      }
+    };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('accepte les statistiques de session d\'un joueur', async () => {
+    const session = { matches: 3, xg: [0.8, 0.2, 0.9, 0.5, 1.1], saves: [1, 1, 1.6, 0, 2] };
+    const payload = { ...basePayload, players: [{ ...basePayload.players[0], session }] };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('rejette un indicateur de session mal formé', async () => {
+    const session = { matches: 3, xg: [0.8, 0.2] };
+    const payload = { ...basePayload, players: [{ ...basePayload.players[0], session }] };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(400);
+  });
+
+  test('accepte les latences du plugin', async () => {
+    const payload = {
+      ...basePayload,
+      perf: {
+        tickStats: { count: 6000, p50: 12.5, p99: 48, max: 310.2 },
+        upload: { count: 1, p50: 95000, p99: 95000, max: 95000 }
+      }
+    };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('traite un envoi groupé résultat par résultat', async () => {
+    const body = JSON.stringify({
+      matches: [
+        { ...basePayload, uploadId: 'a1', playedAt: 1700000000 },
+        { scoreBlue: 1 }
+      ]
+    });
+    const res = await request(app)
+      .post('/match/batch')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+    expect(res.body.results).toEqual([200, 400]);
+  });
+
+  test('rejette un envoi groupé non signé', async () => {
+    const res = await request(app)
+      .post('/match/batch')
+      .set('Content-Type', 'application/json')
+      .send(JSON.stringify({ matches: [basePayload] }));
+    expect(res.status).toBe(401);
+  });
+
+  test('retourne 400 si matches est absent', async () => {
+    const body = JSON.stringify({ results: [] });
+    const res = await request(app)
+      .post('/match/batch')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(400);
+  });
+});
+
+describe('GET /player', () => {
+  test('renvoie 304 quand la réponse est inchangée', async () => {
+    const first = await request(app).get('/player').query({ player_id: 'Alice' });
+    expect(first.status).toBe(200);
+    expect(first.headers.etag).toBeDefined();
+    expect(first.headers['cache-control']).toBe('no-cache');
+
+    const second = await request(app)
+      .get('/player')
+      .query({ player_id: 'Alice' })
+      .set('If-None-Match', first.headers.etag);
+    expect(second.status).toBe(304);
+  });
+
+  test('oublie l\'attribution quand le résultat du match arrive', async () => {
+    publishAssignment('Bob', { rl_name: 'salle-bob', rl_password: 'pw' });
+    const before = await request(app).get('/player').query({ player_id: 'Bob' });
+    expect(before.body).toMatchObject({ rl_name: 'salle-bob' });
+
+    const payload = {
+      scoreBlue: 2,
+      scoreOrange: 1,
+      players: [{ name: 'Bob', team: 1, score: 80, goals: 1, assists: 0, shots: 2, saves: 1 }],
+      duration: '5:00',
+      map: ''
+    };
+    const body = JSON.stringify(payload);
+    const res = await request(app)
+      .post('/match')
+      .set('Content-Type', 'application/json')
+      .set('x-signature', crypto.createHmac('sha256', process.env.API_SECRET).update(body).digest('hex'))
+      .send(body);
+    expect(res.status).toBe(200);
+
+    const after = await request(app).get('/player').query({ player_id: 'Bob' });
+    expect(after.body).toEqual({});
+  });
+
+  test('retourne 400 sans player_id', async () => {
+    const res = await request(app).get('/player');
+    expect(res.status).toBe(400);
+  });
 });
@@ -0,0 +1,113 @@
+import request from 'supertest';
+import crypto from 'crypto';
+import zlib from 'zlib';
+
+process.env.NODE_ENV = 'test';
+process.env.API_SECRET = 'secret-test';
+
+const { default: app } = await import('../index.js');
+const { clearLiveMatches } = await import('../liveMatches.js');
+
+const sign = body =>
+  crypto
+    .createHmac('sha256', process.env.API_SECRET)
+    .update(body)
+    .digest('hex');
+
+const send = batch => {
+  const body = JSON.stringify(batch);
+  return request(app)
+    .post('/match/events')
+    .set('Content-Type', 'application/json')
+    .set('x-signature', sign(body))
+    .send(body);
+};
+
+describe('POST /match/events', () => {
+  const firstBatch = {
+    matchId: '1700000000-ab12cd34',
+    seq: 1,
+    final: false,
+    time: 5,
+    scoreBlue: 0,
+    scoreOrange: 0,
+    events: [
+      { type: 'touch', time: 1.5, player: 'Alice', xg: 0.3 },
+      { type: 'demo', time: 3, player: 'Bob', victim: 'Alice' }
+    ],
+    players: [
+      { name: 'Alice', team: 0, touches: 1, expectedGoals: 0.3 },
+      { name: 'Bob', team: 1, demos: 1 }
+    ]
+  };
+
+  afterEach(() => clearLiveMatches());
+
+  test('additionne les variations et suit le score', async () => {
+    expect((await send(firstBatch)).status).toBe(200);
+    const goal = {
+      ...firstBatch,
+      seq: 2,
+      time: 8,
+      scoreBlue: 1,
+      events: [{ type: 'goal', time: 7.9, player: 'Alice', scoreBlue: 1, scoreOrange: 0 }],
+      players: [{ name: 'Alice', team: 0, goals: 1, touches: 1 }]
+    };
+    expect((await send(goal)).status).toBe(200);
+
+    const res = await request(app).get(`/match/live/${firstBatch.matchId}`);
+    expect(res.status).toBe(200);
+    expect(res.body.scoreBlue).toBe(1);
+    expect(res.body.lastSeq).toBe(2);
+    expect(res.body.missingSeqs).toEqual([]);
+    const alice = res.body.players.find(p => p.name === 'Alice');
+    expect(alice.goals).toBe(1);
+    expect(alice.touches).toBe(2);
+    expect(res.body.events).toHaveLength(3);
+  });
+
+  test('ignore un lot déjà reçu', async () => {
+    await send(firstBatch);
+    expect((await send(firstBatch)).status).toBe(200);
+    const res = await request(app).get(`/match/live/${firstBatch.matchId}`);
+    expect(res.body.players.find(p => p.name === 'Alice').touches).toBe(1);
+    expect(res.body.events).toHaveLength(2);
+  });
+
+  test('signale les lots manquants', async () => {
+    await send(firstBatch);
+    await send({ ...firstBatch, seq: 4, events: [], players: [] });
+    const res = await request(app).get(`/match/live/${firstBatch.matchId}`);
+    expect(res.body.missingSeqs).toEqual([2, 3]);
+  });
+
+  test('accepte un lot gzip signé sur les octets envoyés', async () => {
+    const body = zlib.gzipSync(JSON.stringify(firstBatch));
+    const res = await request(app)
+      .post('/match/events')
+      .set('Content-Type', 'application/json')
+      .set('Content-Encoding', 'gzip')
+      .set('x-signature', sign(body))
+      .send(body);
+    expect(res.status).toBe(200);
+  });
+
+  test('rejette un lot non signé', async () => {
+    const res = await request(app)
+      .post('/match/events')
+      .set('Content-Type', 'application/json')
+      .send(JSON.stringify(firstBatch));
+    expect(res.status).toBe(401);
+  });
+
+  test('retourne 400 sans numéro de séquence', async () => {
+    const { seq, ...rest } = firstBatch;
+    const res = await send(rest);
+    expect(res.status).toBe(400);
+  });
+
+  test('retourne 404 pour un match inconnu', async () => {
+    const res = await request(app).get('/match/live/inconnu');
+    expect(res.status).toBe(404);
+  });
+});
@@ -0,0 +1,98 @@
+import http from 'http';
+import request from 'supertest';
+
+process.env.NODE_ENV = 'test';
+process.env.API_SECRET = 'secret-test';
+
+const { default: app } = await import('../index.js');
+const { publishAssignment, clearAssignment, clearAssignments, openStreamCount, setQueued } = await import(
+  '../playerChannel.js'
+);
+
+// Lit le flux SSE jusqu'à ce que `until` apparaisse, puis ferme la connexion.
+const readStream = (port, headers, until, onOpen) =>
+  new Promise((resolve, reject) => {
+    const req = http.get({ port, path: '/player/stream?player_id=Alice', headers }, res => {
+      let buf = '';
+      res.setEncoding('utf8');
+      res.on('data', chunk => {
+        buf += chunk;
+        if (buf.includes(until)) {
+          res.destroy();
+          resolve({ res, buf });
+        }
+      });
+      if (onOpen) onOpen(res);
+    });
+    req.on('error', reject);
+  });
+
+describe('GET /player/stream', () => {
+  let server;
+  let port;
+
+  beforeAll(done => {
+    server = app.listen(0, () => {
+      port = server.address().port;
+      done();
+    });
+  });
+
+  afterAll(done => server.close(done));
+  afterEach(() => clearAssignments());
+
+  test('pousse une attribution publiée après la connexion', async () => {
+    const { res, buf } = await readStream(port, {}, 'salle-1', () =>
+      setTimeout(() => publishAssignment('Alice', { rl_name: 'salle-1', rl_password: 'pw' }), 50)
+    );
+    expect(res.headers['content-type']).toMatch(/text\/event-stream/);
+    expect(buf).toContain('event: assignment');
+    const id = buf.match(/^id: (\d+)$/m)[1];
+    expect(buf).toContain(`data: {"id":${id},"rl_name":"salle-1","rl_password":"pw"}`);
+  });
+
+  test('renvoie l\'attribution en cours sauf si déjà reçue', async () => {
+    publishAssignment('Alice', { rl_name: 'salle-2', rl_password: 'pw' });
+    const first = await readStream(port, {}, 'salle-2');
+    const id = first.buf.match(/^id: (\d+)$/m)[1];
+
+    const second = await readStream(port, { 'Last-Event-ID': id }, 'retry:');
+    expect(second.buf).not.toContain('salle-2');
+  });
+
+  test('ne renvoie plus une attribution consommée', async () => {
+    publishAssignment('Alice', { rl_name: 'salle-5', rl_password: 'pw' });
+    clearAssignment('Alice');
+    const { buf } = await readStream(port, {}, 'retry:');
+    expect(buf).not.toContain('salle-5');
+    const res = await request(app).get('/player').query({ player_id: 'Alice' });
+    expect(res.body).toEqual({});
+  });
+
+  test('libère la connexion à la déconnexion du plugin', async () => {
+    await readStream(port, {}, 'retry:');
+    await new Promise(resolve => setTimeout(resolve, 50));
+    expect(openStreamCount()).toBe(0);
+  });
+
+  test('GET /player renvoie la même attribution', async () => {
+    publishAssignment('Alice', { rl_name: 'salle-3', rl_password: 'pw' });
+    const res = await request(app).get('/player').query({ player_id: 'Alice' });
+    expect(res.body).toEqual({ id: expect.any(Number), rl_name: 'salle-3', rl_password: 'pw' });
+  });
+
+  test('GET /player signale le joueur en file jusqu\'à son attribution', async () => {
+    setQueued('Alice', true);
+    const queued = await request(app).get('/player').query({ player_id: 'Alice' });
+    expect(queued.body).toEqual({ queued: true });
+
+    publishAssignment('Alice', { rl_name: 'salle-4', rl_password: 'pw' });
+    const assigned = await request(app).get('/player').query({ player_id: 'Alice' });
+    expect(assigned.body).toEqual({ id: expect.any(Number), rl_name: 'salle-4', rl_password: 'pw' });
+  });
+
+  test('retourne 400 sans player_id', async () => {
+    const res = await request(app).get('/player/stream');
+    expect(res.status).toBe(400);
+  });
+});
@@ -7,7 +7,7 @@ REM ============================ À ADAPTER ============================
 set "VS_PATH=C:\Program Files\Microsoft Visual Studio\2022\Community"
 set "BM_SDK=D:\BakkesModSDK"
 set "VCPKG_ROOT=D:\Travail\Travaux\AuusaConnect\vcpkg"
-set "SRC=plugin\AuusaConnectPlugin.cpp"
+set "SRC=plugin\AuusaConnectPlugin.cpp plugin\MatchAnalytics.cpp plugin\BallPredictor.cpp plugin\Telemetry.cpp plugin\UploadWorker.cpp plugin\UploadJournal.cpp plugin\PlayerPoller.cpp plugin\PushClient.cpp plugin\AsyncLog.cpp plugin\MatchStream.cpp plugin\AnalyticsWorker.cpp plugin\PayloadWriter.cpp plugin\Heatmap.cpp plugin\SessionStats.cpp plugin\PerfStats.cpp plugin\Sha256.cpp plugin\Sha256Ni.cpp"
 set "DLL=AuusaConnect.dll"
 set "DEST=%APPDATA%\bakkesmod\bakkesmod\plugins"
 REM ===================================================================
@@ -24,7 +24,7 @@ cl /std:c++17 /LD /EHsc ^
     /I "%BM_SDK%\include" ^
     /I "%VCPKG_ROOT%\installed\x64-windows-static\include" ^
     /I "%VCPKG_ROOT%\installed\x64-windows\include" ^
-    "%SRC%" ^
+    %SRC% ^
     /link ^
     /LIBPATH:"%BM_SDK%\lib" ^
     /LIBPATH:"%VCPKG_ROOT%\installed\x64-windows-static\lib" ^
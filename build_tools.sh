@@ -0,0 +1,38 @@
+#!/bin/sh
+# Compile les outils hors jeu du plugin (Linux / macOS, C++17).
+# Dependances : nlohmann-json et zlib (paquets nlohmann-json3-dev et
+# zlib1g-dev sous Debian/Ubuntu).
+# auusa_push n'est compile que si libcurl est present (curl-config).
+# Variables facultatives : CXX, CXXFLAGS.
+set -e
+cd "$(dirname "$0")"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--O2 -Wall}"
+CORE="plugin/MatchAnalytics.cpp plugin/BallPredictor.cpp plugin/PayloadWriter.cpp plugin/Heatmap.cpp plugin/SessionStats.cpp plugin/PerfStats.cpp plugin/Telemetry.cpp plugin/XGBatch.cpp plugin/AsyncLog.cpp plugin/MatchStream.cpp plugin/AnalyticsWorker.cpp plugin/Sha256.cpp"
+
+mkdir -p build
+# Le noyau AVX2 et la compression SHA-NI sont les seuls fichiers compiles
+# avec des instructions etendues ; ils ne sont appeles qu'apres detection
+# du processeur.
+case "$(uname -m)" in
+    x86_64|amd64)
+        $CXX -std=c++17 $CXXFLAGS -mavx2 -c plugin/XGBatchAvx2.cpp -o build/XGBatchAvx2.o
+        $CXX -std=c++17 $CXXFLAGS -msha -msse4.1 -c plugin/Sha256Ni.cpp -o build/Sha256Ni.o
+        CORE="$CORE build/XGBatchAvx2.o build/Sha256Ni.o"
+        ;;
+esac
+echo "=== auusa_replay ==="
+$CXX -std=c++17 $CXXFLAGS plugin/tools/auusa_replay.cpp $CORE -pthread -o build/auusa_replay
+echo "=== auusa_check ==="
+$CXX -std=c++17 $CXXFLAGS plugin/tools/auusa_check.cpp plugin/UploadJournal.cpp $CORE -lz -pthread -o build/auusa_check
+echo "=== auusa_bench ==="
+$CXX -std=c++17 $CXXFLAGS plugin/tools/auusa_bench.cpp $CORE -pthread -o build/auusa_bench
+if command -v curl-config >/dev/null 2>&1; then
+    echo "=== auusa_push ==="
+    $CXX -std=c++17 $CXXFLAGS $(curl-config --cflags) plugin/tools/auusa_push.cpp plugin/PushClient.cpp \
+        $(curl-config --libs) -pthread -o build/auusa_push
+else
+    echo "curl-config introuvable : auusa_push ignore"
+fi
+echo "Outils generes dans build/"
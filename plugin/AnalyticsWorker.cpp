@@ -0,0 +1,345 @@
+#include "AnalyticsWorker.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+// Tronque sans couper un caractere UTF-8
+static void CopyText(char* dst, const std::string& src)
+{
+    size_t n = Utf8Prefix(src, AnalyticsCommand::TEXT_SIZE - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+AnalyticsWorker::~AnalyticsWorker()
+{
+    Stop();
+}
+
+void AnalyticsWorker::Start(LogFn logFn)
+{
+    if (thread.joinable())
+        return;
+    log = std::move(logFn);
+    stopping = false;
+    thread = std::thread(&AnalyticsWorker::Run, this);
+}
+
+void AnalyticsWorker::Stop()
+{
+    if (!thread.joinable())
+        return;
+    // Le surplus eventuel passe avant l'arret
+    Drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void AnalyticsWorker::Drain()
+{
+    // Chaque passe vide la file : le surplus y entre par morceaux
+    bool done;
+    do
+    {
+        done = FlushOverflow();
+        if (!thread.joinable())
+        {
+            ProcessPending();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        drainRequested = true;
+        wake.notify_all();
+        drained.wait(lock, [this] { return !drainRequested; });
+    } while (!done);
+}
+
+AnalyticsCommand* AnalyticsWorker::Claim()
+{
+    // Sans thread d'analyse (outils), la file est videe sur place
+    if (!thread.joinable() && !queue.Claim())
+        ProcessPending();
+    if (FlushOverflow())
+    {
+        if (AnalyticsCommand* cmd = queue.Claim())
+            return cmd;
+    }
+    // Derriere le surplus pour garder l'ordre des commandes
+    deferred.fetch_add(1, std::memory_order_relaxed);
+    claimedOverflow = true;
+    overflow.emplace_back();
+    return &overflow.back();
+}
+
+void AnalyticsWorker::Publish()
+{
+    if (claimedOverflow)
+    {
+        claimedOverflow = false;
+        return;
+    }
+    if (queue.Publish())
+        Notify();
+}
+
+bool AnalyticsWorker::FlushOverflow()
+{
+    while (!overflow.empty())
+    {
+        AnalyticsCommand* cmd = queue.Claim();
+        if (!cmd)
+            return false;
+        *cmd = overflow.front();
+        overflow.pop_front();
+        if (queue.Publish())
+            Notify();
+    }
+    return true;
+}
+
+void AnalyticsWorker::Notify()
+{
+    // Le verrou empeche le reveil de tomber entre le test de la file et la
+    // mise en attente du thread d'analyse.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    wake.notify_one();
+}
+
+void AnalyticsWorker::Run()
+{
+    for (;;)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue.Settle();
+            wake.wait(lock, [this] { return stopping || drainRequested || !queue.Empty(); });
+            stop = stopping;
+        }
+        ProcessPending();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Le thread du jeu est bloque dans Drain : plus rien n'arrive
+            if (drainRequested && queue.Empty())
+            {
+                drainRequested = false;
+                drained.notify_all();
+            }
+        }
+        if (stop)
+            break;
+    }
+}
+
+void AnalyticsWorker::ProcessPending()
+{
+    while (AnalyticsCommand* cmd = queue.Front())
+    {
+        try
+        {
+            Execute(*cmd);
+        }
+        catch (const std::exception& e)
+        {
+            Log(std::string("[Analyse] Exception : ") + e.what());
+        }
+        queue.Pop();
+    }
+}
+
+void AnalyticsWorker::Execute(const AnalyticsCommand& cmd)
+{
+    const FrameSnapshot& f = cmd.frame;
+    switch (cmd.op)
+    {
+    case AnalyticsOp::Reset:
+        analytics.Reset();
+        break;
+    case AnalyticsOp::Debug:
+        analytics.SetDebug(cmd.flag);
+        break;
+    case AnalyticsOp::Phase:
+        analytics.SetPhase(cmd.phase);
+        break;
+    case AnalyticsOp::Player:
+        analytics.AssignPlayer(cmd.slot, cmd.text[0], cmd.text[1], cmd.team);
+        break;
+    case AnalyticsOp::MatchStart:
+        analytics.OnMatchStart(f);
+        break;
+    case AnalyticsOp::Sample:
+        analytics.Sample(f);
+        stream.Tick(f.time);
+        break;
+    case AnalyticsOp::Touch:
+    {
+        // Une touche qui ajoute une tentative est un tir : son xG part avec elle
+        int slot = f.slot[cmd.index];
+        const PlayerStats* ps = analytics.Stats(slot);
+        size_t shots = ps ? ps->shots.size() : 0;
+        analytics.OnTouch(f, cmd.index);
+        if (stream.Active())
+        {
+            ps = analytics.Stats(slot);
+            stream.AddTouch(f.time, slot, ps && ps->shots.size() > shots ? ps->shots.back().xg : -1.f);
+        }
+        break;
+    }
+    case AnalyticsOp::Demolish:
+        analytics.OnDemolish(f, cmd.index);
+        stream.AddDemo(f.time, f.slot[cmd.index], cmd.slot);
+        break;
+    case AnalyticsOp::Boost:
+        analytics.OnBoost(cmd.slot, cmd.a, cmd.b);
+        break;
+    case AnalyticsOp::Goal:
+    {
+        int scoreBlue = static_cast<int>(cmd.a);
+        int scoreOrange = static_cast<int>(cmd.b);
+        if (analytics.OnGoal(f, scoreBlue, scoreOrange))
+            stream.AddGoal(f.time, analytics.LastTouchSlot(), scoreBlue, scoreOrange);
+        break;
+    }
+    case AnalyticsOp::StreamBegin:
+        stream.Begin(cmd.text[0], cmd.text[1], cmd.a);
+        break;
+    case AnalyticsOp::StreamEnd:
+        if (!stream.Active())
+            break;
+        stream.End(cmd.a);
+        Log("[Stream] " + std::to_string(stream.Sent()) + " lot(s) envoye(s), "
+            + std::to_string(stream.Lost()) + " perdu(s) (file d'envoi pleine)");
+        break;
+    case AnalyticsOp::StreamLimits:
+        stream.SetLimits(cmd.a, static_cast<size_t>(cmd.slot));
+        break;
+    }
+}
+
+void AnalyticsWorker::Reset()
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Reset;
+    Publish();
+}
+
+void AnalyticsWorker::SetDebug(bool enabled)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Debug;
+    cmd->flag = enabled;
+    Publish();
+}
+
+void AnalyticsWorker::SetPhase(GamePhase phase)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Phase;
+    cmd->phase = phase;
+    Publish();
+}
+
+void AnalyticsWorker::AssignPlayer(int slot, const std::string& uid, const std::string& name, int team)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Player;
+    cmd->slot = slot;
+    cmd->team = team;
+    CopyText(cmd->text[0], uid);
+    CopyText(cmd->text[1], name);
+    Publish();
+}
+
+void AnalyticsWorker::OnMatchStart(const FrameSnapshot& f)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::MatchStart;
+    cmd->frame = f;
+    Publish();
+}
+
+void AnalyticsWorker::Sample(const FrameSnapshot& f)
+{
+    AnalyticsCommand* cmd = FlushOverflow() ? queue.Claim() : nullptr;
+    if (!cmd)
+    {
+        droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    cmd->op = AnalyticsOp::Sample;
+    cmd->frame = f;
+    Publish();
+}
+
+void AnalyticsWorker::OnTouch(const FrameSnapshot& f, int self)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Touch;
+    cmd->index = self;
+    cmd->frame = f;
+    Publish();
+}
+
+void AnalyticsWorker::OnDemolish(const FrameSnapshot& f, int attacker, int victim)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Demolish;
+    cmd->index = attacker;
+    cmd->slot = victim;
+    cmd->frame = f;
+    Publish();
+}
+
+void AnalyticsWorker::OnBoost(int slot, float current, float maxBoost)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Boost;
+    cmd->slot = slot;
+    cmd->a = current;
+    cmd->b = maxBoost;
+    Publish();
+}
+
+void AnalyticsWorker::OnGoal(const FrameSnapshot& f, int scoreBlue, int scoreOrange)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::Goal;
+    cmd->a = static_cast<float>(scoreBlue);
+    cmd->b = static_cast<float>(scoreOrange);
+    cmd->frame = f;
+    Publish();
+}
+
+void AnalyticsWorker::StreamBegin(const std::string& matchId, const std::string& reporter, float now)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::StreamBegin;
+    cmd->a = now;
+    CopyText(cmd->text[0], matchId);
+    CopyText(cmd->text[1], reporter);
+    Publish();
+}
+
+void AnalyticsWorker::StreamEnd(float now)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::StreamEnd;
+    cmd->a = now;
+    Publish();
+}
+
+void AnalyticsWorker::StreamLimits(float flushInterval, size_t maxEvents)
+{
+    AnalyticsCommand* cmd = Claim();
+    cmd->op = AnalyticsOp::StreamLimits;
+    cmd->a = flushInterval;
+    cmd->slot = static_cast<int>(maxEvents);
+    Publish();
+}
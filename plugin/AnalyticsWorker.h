@@ -0,0 +1,138 @@
+#pragma once
+#include "MatchAnalytics.h"
+#include "MatchStream.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Calcul des statistiques hors du thread du jeu.
+//
+// Les hooks ne font que capturer la frame et deposer une commande de taille
+// fixe (frame comprise) dans une file SPSC ; le thread d'analyse possede
+// MatchAnalytics et MatchStream et execute toutes les analyses dans l'ordre
+// des commandes. Le thread du jeu tient lui-meme le registre des joueurs et
+// la phase de jeu dont ses hooks ont besoin.
+//
+// Le thread d'analyse dort sans delai tant que la file est vide ; le thread
+// du jeu ne le reveille que lorsqu'une commande arrive dans une file vide.
+//
+// File pleine : un echantillon est abandonne (le suivant integre le temps
+// ecoule) ; toute autre commande est mise de cote par le thread du jeu, dans
+// l'ordre, et reversee dans la file des qu'une case se libere. Le thread du
+// jeu n'attend donc jamais le thread d'analyse, sauf dans Drain() qui attend
+// que les commandes deposees soient traitees : les statistiques peuvent
+// alors etre lues depuis le thread du jeu jusqu'a la commande suivante.
+enum class AnalyticsOp : uint8_t
+{
+    Reset,
+    Debug,
+    Phase,
+    Player,
+    MatchStart,
+    Sample,
+    Touch,
+    Demolish,
+    Boost,
+    Goal,
+    StreamBegin,
+    StreamEnd,
+    StreamLimits
+};
+
+struct AnalyticsCommand
+{
+    static constexpr size_t TEXT_SIZE = 64;
+
+    AnalyticsOp op = AnalyticsOp::Sample;
+    GamePhase phase = GamePhase::Idle; // Phase
+    bool flag = false;                 // Debug
+    int slot = -1;  // Player, Boost : emplacement ; Demolish : victime ; StreamLimits : evenements
+    int index = -1; // Touch, Demolish : indice du joueur dans la frame
+    int team = -1;  // Player
+    float a = 0.f;  // Boost : boost actuel ; Goal : score bleu ; Stream* : temps ou delai
+    float b = 0.f;  // Boost : boost maximal ; Goal : score orange
+    char text[2][TEXT_SIZE] = {}; // Player : uid, nom ; StreamBegin : match, rapporteur
+    FrameSnapshot frame;          // MatchStart, Sample, Touch, Demolish, Goal
+};
+
+class AnalyticsWorker
+{
+public:
+    using LogFn = std::function<void(const std::string&)>;
+
+    static constexpr size_t CAPACITY = 256; // commandes, ~12 s d'echantillons a 20 Hz
+
+    AnalyticsWorker() : stream(analytics) {}
+    ~AnalyticsWorker();
+
+    void Start(LogFn logFn);
+    // Traite les commandes restantes puis arrete le thread.
+    void Stop();
+    // Attend que toutes les commandes deposees soient traitees ; sans thread,
+    // les traite sur l'appelant.
+    void Drain();
+
+    // Reservees au thread du jeu (producteur unique).
+    void Reset();
+    void SetDebug(bool enabled);
+    void SetPhase(GamePhase phase);
+    void AssignPlayer(int slot, const std::string& uid, const std::string& name, int team);
+    void OnMatchStart(const FrameSnapshot& f);
+    void Sample(const FrameSnapshot& f);
+    void OnTouch(const FrameSnapshot& f, int self);
+    void OnDemolish(const FrameSnapshot& f, int attacker, int victim);
+    void OnBoost(int slot, float current, float maxBoost);
+    void OnGoal(const FrameSnapshot& f, int scoreBlue, int scoreOrange);
+    void StreamBegin(const std::string& matchId, const std::string& reporter, float now);
+    void StreamEnd(float now);
+    void StreamLimits(float flushInterval, size_t maxEvents);
+
+    // A configurer avant Start, a lire apres Drain.
+    MatchAnalytics& Analytics() { return analytics; }
+    const MatchAnalytics& Analytics() const { return analytics; }
+    MatchStream& Stream() { return stream; }
+
+    uint64_t DroppedSamples() const { return droppedSamples.load(std::memory_order_relaxed); }
+    // Commandes mises de cote faute de place dans la file
+    uint64_t Deferred() const { return deferred.load(std::memory_order_relaxed); }
+
+private:
+    // Case a remplir : dans la file, ou dans le surplus si elle est pleine
+    AnalyticsCommand* Claim();
+    void Publish();
+    // Reverse le surplus dans la file tant qu'il y a de la place ; vrai si
+    // le surplus est vide.
+    bool FlushOverflow();
+    void Notify();
+    void Run();
+    void ProcessPending();
+    void Execute(const AnalyticsCommand& cmd);
+    void Log(const std::string& msg) const
+    {
+        if (log)
+            log(msg);
+    }
+
+    MatchAnalytics analytics;
+    MatchStream stream;
+    SpscQueue<AnalyticsCommand, CAPACITY> queue;
+    std::atomic<uint64_t> droppedSamples{0};
+    std::atomic<uint64_t> deferred{0};
+    // Propres au thread du jeu
+    std::deque<AnalyticsCommand> overflow;
+    bool claimedOverflow = false;
+
+    LogFn log;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    bool stopping = false;
+    bool drainRequested = false;
+};
@@ -0,0 +1,181 @@
+#include "AsyncLog.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+static const char TRUNCATED[] = " [...]";
+
+AsyncLog::AsyncLog() : slots(new Slot[CAPACITY])
+{
+    for (size_t i = 0; i < CAPACITY; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+AsyncLog::~AsyncLog()
+{
+    Close();
+}
+
+bool AsyncLog::Open(const std::filesystem::path& filePath, uint64_t maxSize, int keep)
+{
+    if (thread.joinable())
+        return true;
+    path = filePath;
+    maxBytes = maxSize;
+    keepFiles = std::max(keep, 1);
+
+    std::error_code ec;
+    fileBytes = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (ec)
+        fileBytes = 0;
+    file.open(path, std::ios::app | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    stopping = false;
+    thread = std::thread(&AsyncLog::Run, this);
+    return true;
+}
+
+void AsyncLog::Close()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    file.close();
+}
+
+bool AsyncLog::Write(LogLevel level, const char* text, size_t size)
+{
+    if (!Enabled(level))
+        return false;
+
+    size_t pos = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+        slot = &slots[pos & (CAPACITY - 1)];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Case encore occupee par un message non ecrit : tampon plein
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (size > SLOT_TEXT)
+    {
+        // Coupe sans separer un caractere UTF-8 (textes accentues, reponses du bot)
+        size_t keep = Utf8Prefix(std::string_view(text, size), SLOT_TEXT - (sizeof(TRUNCATED) - 1));
+        std::memcpy(slot->text, text, keep);
+        std::memcpy(slot->text + keep, TRUNCATED, sizeof(TRUNCATED) - 1);
+        size = keep + sizeof(TRUNCATED) - 1;
+    }
+    else
+    {
+        std::memcpy(slot->text, text, size);
+    }
+    slot->size = static_cast<uint16_t>(size);
+    slot->level = static_cast<uint8_t>(level);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLog::Run()
+{
+    std::string batch;
+    batch.reserve(CAPACITY * 64);
+    for (;;)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, FLUSH_INTERVAL, [this] { return stopping; });
+            stop = stopping;
+        }
+        // Un lot plein signale un tampon encore charge : on enchaine
+        size_t n;
+        do
+        {
+            n = Drain(batch);
+            Flush(batch);
+        } while (n == CAPACITY);
+        if (stop)
+            break;
+    }
+}
+
+// Recopie les messages publies, dans l'ordre, et libere leurs cases. Un lot
+// ne depasse pas CAPACITY messages pour que la rotation reste proche de
+// maxBytes meme si les producteurs ecrivent en continu.
+size_t AsyncLog::Drain(std::string& batch)
+{
+    size_t n = 0;
+    for (; n < CAPACITY; ++n)
+    {
+        Slot& slot = slots[tail & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+            break;
+        batch.append(slot.text, slot.size);
+        batch += '\n';
+        slot.sequence.store(tail + CAPACITY, std::memory_order_release);
+        ++tail;
+        written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops)
+    {
+        batch += "[Log] " + std::to_string(drops - reportedDrops) + " message(s) perdu(s), tampon plein\n";
+        reportedDrops = drops;
+    }
+    return n;
+}
+
+void AsyncLog::Flush(std::string& batch)
+{
+    if (batch.empty())
+        return;
+    if (maxBytes > 0 && fileBytes > 0 && fileBytes + batch.size() > maxBytes)
+        Rotate();
+    file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    file.flush();
+    fileBytes += batch.size();
+    batch.clear();
+}
+
+void AsyncLog::Rotate()
+{
+    file.close();
+    std::error_code ec;
+    auto numbered = [this](int n) {
+        std::filesystem::path p = path;
+        p += "." + std::to_string(n);
+        return p;
+    };
+    std::filesystem::remove(numbered(keepFiles), ec);
+    for (int n = keepFiles - 1; n >= 1; --n)
+        std::filesystem::rename(numbered(n), numbered(n + 1), ec);
+    std::filesystem::rename(path, numbered(1), ec);
+
+    file.open(path, std::ios::app | std::ios::binary);
+    fileBytes = 0;
+    rotations.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Journal fichier asynchrone.
+//
+// Write() copie le message dans un tampon circulaire de taille fixe, sans
+// verrou ni allocation, depuis n'importe quel thread (jeu, envois, flux).
+// Un thread d'ecriture vide le tampon toutes les FLUSH_INTERVAL et ecrit le
+// lot en une seule fois. Tampon plein : le message est perdu et compte ; le
+// nombre de pertes est ecrit dans le fichier des que la place revient.
+// Au-dela de maxBytes, le fichier est renomme en .1 (les .1, .2... sont
+// decales, keepFiles anciens fichiers au plus) et un nouveau fichier est
+// ouvert.
+//
+// Le niveau est verifie avant toute copie ; les appelants qui construisent
+// un message couteux testent Enabled() avant de le formater.
+class AsyncLog
+{
+public:
+    static constexpr size_t CAPACITY = 1024;   // messages, puissance de 2
+    static constexpr size_t SLOT_TEXT = 496;   // octets par message, au-dela tronque
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(50);
+
+    AsyncLog();
+    ~AsyncLog();
+
+    // Ouvre le fichier en ajout et demarre le thread d'ecriture.
+    bool Open(const std::filesystem::path& path, uint64_t maxBytes, int keepFiles);
+    // Ecrit les messages en attente puis arrete le thread.
+    void Close();
+
+    void SetLevel(LogLevel level) { minLevel.store(level, std::memory_order_relaxed); }
+    bool Enabled(LogLevel level) const { return level >= minLevel.load(std::memory_order_relaxed); }
+
+    // Renvoie false si le message a ete ignore (niveau) ou perdu (tampon plein).
+    bool Write(LogLevel level, const char* text, size_t size);
+    bool Write(LogLevel level, const std::string& text) { return Write(level, text.data(), text.size()); }
+
+    uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t Written() const { return written.load(std::memory_order_relaxed); }
+    uint64_t Rotations() const { return rotations.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        uint16_t size;
+        uint8_t level;
+        char text[SLOT_TEXT];
+    };
+
+    void Run();
+    size_t Drain(std::string& batch);
+    void Flush(std::string& batch);
+    void Rotate();
+
+    // File multi-producteurs / consommateur unique (numeros de sequence par
+    // case) : un producteur reserve une case en avancant head, la remplit,
+    // puis publie son numero ; le thread d'ecriture lit dans l'ordre de tail.
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) size_t tail = 0;
+    alignas(64) std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> rotations{0};
+    std::atomic<LogLevel> minLevel{LogLevel::Info};
+
+    std::filesystem::path path;
+    std::ofstream file;
+    uint64_t fileBytes = 0;
+    uint64_t maxBytes = 0;
+    int keepFiles = 0;
+    uint64_t reportedDrops = 0;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
@@ -2,25 +2,35 @@
 #include "bakkesmod/plugin/bakkesmodplugin.h"
 #include "bakkesmod/wrappers/WrapperStructs.h"
 #include "bakkesmod/wrappers/MatchmakingWrapper.h"
-#include <cpr/cpr.h>
+#include "AnalyticsWorker.h"
+#include "MatchAnalytics.h"
+#include "PerfStats.h"
+#include "SessionStats.h"
+#include "Telemetry.h"
+#include "UploadWorker.h"
+#include "AsyncLog.h"
+#include "PlayerPoller.h"
+#include "PushClient.h"
+#include "Sha256.h"
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <filesystem>
-#include <map>
 #include <cmath>
 #include <algorithm>
 #include <utility>
-#include <thread>
 #include <memory>
+#include <functional>
+#include <thread>
 #include <exception>
+#include <chrono>
+#include <ctime>
 #include <windows.h>
-#include <bcrypt.h>
-#include <iomanip>
 #include <sstream>
 #include <cstdlib>
+#include <random>
 
 #undef min
 #undef max
@@ -28,118 +38,18 @@
 using json = nlohmann::json;
 
 static constexpr const char* DEFAULT_API_BASE = "https://34.32.118.126:3000";
-
-static std::string hmac_sha256(const std::string& key, const std::string& data)
+// matchmaking.log est renomme en .1 au-dela de cette taille ; .1 a .3 sont gardes
+static constexpr uint64_t LOG_MAX_BYTES = 5 * 1024 * 1024;
+static constexpr int LOG_KEEP_FILES = 3;
+// Lots du flux de match en attente d'envoi : le reste de la file reste
+// libre pour les resultats de fin de match
+static constexpr size_t STREAM_MAX_PENDING = UploadWorker::MAX_PENDING / 2;
+
+static Vec3 ToVec3(const Vector& v)
 {
-    BCRYPT_ALG_HANDLE hAlg = nullptr;
-    BCRYPT_HASH_HANDLE hHash = nullptr;
-    DWORD objLen = 0, dataLen = 0;
-    std::vector<BYTE> obj; // buffer pour l'objet de hachage
-    BYTE hash[32];
-
-    NTSTATUS status = BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_SHA256_ALGORITHM, nullptr,
-                                                   BCRYPT_ALG_HANDLE_HMAC_FLAG);
-    if (!BCRYPT_SUCCESS(status))
-        throw std::runtime_error("BCryptOpenAlgorithmProvider failed");
-
-    status = BCryptGetProperty(hAlg, BCRYPT_OBJECT_LENGTH,
-                               reinterpret_cast<PBYTE>(&objLen), sizeof(DWORD), &dataLen, 0);
-    if (!BCRYPT_SUCCESS(status)) {
-        BCryptCloseAlgorithmProvider(hAlg, 0);
-        throw std::runtime_error("BCryptGetProperty failed");
-    }
-
-    obj.resize(objLen);
-    status = BCryptCreateHash(hAlg, &hHash, obj.data(), objLen,
-                              reinterpret_cast<PBYTE>(const_cast<char*>(key.data())),
-                              static_cast<ULONG>(key.size()), 0);
-    if (!BCRYPT_SUCCESS(status)) {
-        BCryptCloseAlgorithmProvider(hAlg, 0);
-        throw std::runtime_error("BCryptCreateHash failed");
-    }
-
-    status = BCryptHashData(hHash, reinterpret_cast<PBYTE>(const_cast<char*>(data.data())),
-                            static_cast<ULONG>(data.size()), 0);
-    if (!BCRYPT_SUCCESS(status)) {
-        BCryptDestroyHash(hHash);
-        BCryptCloseAlgorithmProvider(hAlg, 0);
-        throw std::runtime_error("BCryptHashData failed");
-    }
-
-    status = BCryptFinishHash(hHash, hash, sizeof(hash), 0);
-    BCryptDestroyHash(hHash);
-    BCryptCloseAlgorithmProvider(hAlg, 0);
-    if (!BCRYPT_SUCCESS(status))
-        throw std::runtime_error("BCryptFinishHash failed");
-
-    std::ostringstream oss;
-    for (BYTE b : hash)
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
-    return oss.str();
+    return {v.X, v.Y, v.Z};
 }
 
-struct PlayerStats
-{
-    int boostPickups = 0;
-    int wastedBoosts = 0;
-    int smallPads = 0;
-    int bigPads = 0;
-    float lastBoost = -1.f;
-
-    // Statistiques offensives
-    int goals = 0;
-    int assists = 0;
-    int shotsOnTarget = 0;
-    int offensiveDemos = 0;
-
-    // Statistiques defensives
-    int clearances = 0;
-    int challengesWon = 0;
-    int defensiveDemos = 0;
-    float defenseTime = 0.f;
-    int clutchSaves = 0;
-    int blocks = 0;
-
-    // Vision & soutien
-    int usefulPasses = 0;
-    int cleanClears = 0;
-    int missedOpenGoals = 0;
-    int doubleCommits = 0;
-    int aerialTouches = 0;
-    int highPressings = 0;
-    int ballTouches = 0;
-
-    // Suivi des roles de rotation
-    float roleTime[3] = {0.f, 0.f, 0.f};
-    int cuts = 0;
-    float aggressiveTime = 0.f;
-    float passiveTime = 0.f;
-    float ballchaseTime = 0.f;
-    int lastRole = -1;
-    float firstStreak = 0.f;
-    float thirdStreak = 0.f;
-
-    // Etats internes
-    bool inAttack = false;
-    float timeSinceAttack = 0.f;
-    int prevSaves = 0;
-
-    // Garde-fous pour la comptabilisation des evenements
-    float lastDuelTime = -10.f;
-    float lastMissedOpenGoalTime = -10.f;
-    float lastHighPressTime = -10.f;
-
-    std::vector<float> xgAttempts;
-    std::vector<std::string> xgContext;
-};
-
-struct DefenderInfo {
-    Vector pos;
-    float boost;
-    bool padNearby;
-    float distance;
-};
-
 class AuusaConnectPlugin : public BakkesMod::Plugin::BakkesModPlugin
 {
 public:
@@ -150,32 +60,98 @@ private:
     void HookEvents();
     void OnMatchStart(ServerWrapper server, void* params, std::string eventName);
     void TickStats();
+    void StartSampler();
+    void StopSampler();
+    void OnFrameTick();
+    void SetPhase(GamePhase next);
+    void StartRecording();
+    void StopRecording();
+    void RecordFrame(const FrameSnapshot& f, bool sample);
+    void RecordEvent(uint8_t type, int slot, int other = -1, float a = 0.f, float b = 0.f);
+    void UpdatePhase(ServerWrapper server);
     void OnHitBall(CarWrapper car, void* params, std::string eventName);
     void OnCarDemolish(CarWrapper car, void* params, std::string eventName);
     void OnBoostCollected(CarWrapper car, void* params, std::string eventName);
     void OnGameEnd();
     void OnGoalScored(std::string eventName);
-    std::string DetectShotContext(CarWrapper car, BallWrapper ball, int team, bool openNet, float gameTime, bool isAerial);
-    static float ComputeXGAdvanced(float distance, float angle, float ballSpeed, float playerBoost, bool isAerial, const std::vector<DefenderInfo>& defenders, bool hardRebound, bool panicShot, bool openNet, bool qualityAction);
-
-    void PollSupabase();
+    // sample : la frame sert a l'echantillon de TickStats
+    const FrameSnapshot& CaptureFrame(ServerWrapper server, bool sample = false);
+    int RegisterPlayer(PriWrapper pri);
+
+    void UpdatePollMode();
+    void SchedulePollMode();
+    void HandleInstructions(const json& instr);
+    void LoadAssignmentId();
+    void SaveAssignmentId();
+    void StartPush();
+    void StartStream(ServerWrapper server);
+    void StopStream(float now);
     void LoadConfig();
 
-    std::map<std::string, PlayerStats> stats;
-    std::string lastTouchPlayer;
-    float lastTouchTime = 0.f;
-    bool lastTouchAerial = false;
-    std::string lastTeamTouchPlayer[2];
-    float lastTeamTouchTime[2] = {0.f, 0.f};
-    Vector lastBallLocation{0.f, 0.f, 0.f};
-    Vector lastBallVel;
-    float lastUpdate = 0.f;
-    int lastTotalScore = 0;
+    // Statistiques du match, calculees par le thread d'analyse (voir
+    // AnalyticsWorker.h). Le thread du jeu garde le registre des joueurs, la
+    // phase de jeu et la derniere frame lue.
+    AnalyticsWorker worker;
+    PlayerRegistry registry;
+    GamePhase phase = GamePhase::Idle;
+    float lastSampleTime = 0.f;
+    int lastGoalTotal = 0;
+    FrameSnapshot frame;
+    // Agregats des matchs joues depuis le chargement du plugin (mm_session_stats)
+    SessionStats session;
+
+    // Latence des hooks et des requetes (mm_perf) ; declaree avant les
+    // threads reseau qui y ecrivent
+    PerfStats perf;
+    bool perfUpload = false;
+
+    // Envoi des statistiques de fin de match ; le resultat est ecrit dans
+    // un tampon reserve une fois, au format choisi par UPLOAD_FORMAT
+    UploadWorker uploader;
+    PayloadWriter payloadWriter;
+    PayloadFormat uploadFormat = PayloadFormat::Json;
+    std::mt19937_64 uploadIds{std::random_device{}()};
+    // Evenements envoyes pendant le match (mm_stream), par le thread d'analyse
+    bool streamEnabled = false;
+    bool streaming = false;
+
+    // Interrogation de /player ; le mode est recalcule sur le thread du jeu
+    PlayerPoller poller;
+    PlayerPoller::Mode pollMode = PlayerPoller::Mode::Paused;
+    // Flux /player/stream (mm_push) ; l'interrogation est suspendue tant
+    // qu'il est ouvert
+    PushClient push;
+    bool pushEnabled = true;
+
+    // Enregistrement de la telemetrie (mm_record)
+    bool recordEnabled = false;
+    TelemetryWriter recorder;
+    int recordedSaves[MAX_SLOTS] = {};
+
+    // Echantillonneur cale sur la frame du jeu (voir StartSampler)
+    bool samplerAttached = false;
+    float samplePeriod = 1.f / 20.f;
+    int sampleCount = 0;
+    double sampleTotalUs = 0.0;
+    double sampleMaxUs = 0.0;
     bool debugEnabled = false;
-    std::ofstream logFile;
-    void Log(const std::string& msg);
+    // Journal fichier ecrit par un thread dedie ; la console n'est touchee
+    // que depuis le thread du jeu
+    AsyncLog logger;
+    std::thread::id gameThread;
+    void Log(const std::string& msg, LogLevel level = LogLevel::Info);
+    // Jeton detruit a la fin de onUnload : une tache postee par un autre
+    // thread (Execute) ou differee (SetTimeout) qui s'execute apres le
+    // dechargement ne touche plus au plugin. Les threads sont arretes avant
+    // sa destruction, ils peuvent donc le copier sans verrou.
+    std::shared_ptr<bool> alive;
+    void RunOnGameThread(std::function<void()> fn);
     std::string lastServerName;
     std::string lastServerPassword;
+    // Identifiant de la derniere attribution traitee, garde dans
+    // assignment.id : le bot peut rejouer une attribution deja utilisee
+    // (GET /player, reconnexion du flux, plugin recharge).
+    uint64_t lastAssignmentId = 0;
     bool apiDisabled = false;
     std::string botEndpoint = std::string(DEFAULT_API_BASE) + "/match";
     std::string apiSecret;
@@ -183,122 +159,170 @@ private:
     bool autoJoined = false;
 };
 
-static PriWrapper GetPriByName(ServerWrapper server, const std::string& name)
+const FrameSnapshot& AuusaConnectPlugin::CaptureFrame(ServerWrapper server, bool sample)
 {
-    ArrayWrapper<PriWrapper> pris = server.GetPRIs();
-    for (int i = 0; i < pris.Count(); ++i)
+    // Plusieurs evenements peuvent survenir dans la meme frame : on ne relit
+    // le jeu que si le temps de partie a avance.
+    float now = server.GetSecondsElapsed();
+    if (now == frame.time)
     {
-        PriWrapper pri = pris.Get(i);
-        if (pri && pri.GetPlayerName().ToString() == name)
-            return pri;
+        // Frame deja enregistree sans marque d'echantillon
+        if (sample)
+            RecordEvent(TELEMETRY_SAMPLE, -1);
+        return frame;
     }
-    // Constructeur par défaut non disponible, on renvoie un wrapper nul
-    return PriWrapper(0);
-}
 
-static bool WasLastShotOnGoal(const BallWrapper& ball)
-{
-    // Cette fonction est absente dans certaines versions du SDK.
-    // On renvoie simplement false si elle n'est pas disponible.
-    return false;
-}
+    frame.time = now;
+    BallWrapper ball = server.GetBall();
+    frame.hasBall = static_cast<bool>(ball);
+    if (ball)
+    {
+        frame.ballPos = ToVec3(ball.GetLocation());
+        frame.ballVel = ToVec3(ball.GetVelocity());
+    }
 
-float AuusaConnectPlugin::ComputeXGAdvanced(float distance, float angle, float ballSpeed, float playerBoost, bool isAerial, const std::vector<DefenderInfo>& defenders, bool hardRebound, bool panicShot, bool openNet, bool qualityAction)
-{
-    float xg = 0.05f;
-    xg += std::exp(-distance / 2500.f) * 0.25f;
-    xg += std::clamp(1.f - angle / 1.57f, 0.f, 1.f) * 0.2f;
-    xg += std::clamp(ballSpeed / 4000.f, 0.f, 1.f) * 0.05f;
-    if (playerBoost > 20.f)
-        xg += 0.02f;
-
-    float openBonus = 0.f;
-    if (openNet)
+    frame.Clear();
+    ArrayWrapper<PriWrapper> pris = server.GetPRIs();
+    for (int i = 0; i < pris.Count() && frame.count < MAX_PLAYERS; ++i)
     {
-        openBonus = 0.25f;
-        for (const auto& d : defenders)
+        PriWrapper pri = pris.Get(i);
+        if (!pri)
+            continue;
+        int team = pri.GetTeamNum2();
+        if (team != 0 && team != 1)
+            continue; // spectateurs
+
+        int slot = registry.Find(pri.memory_address);
+        if (slot < 0)
+            slot = RegisterPlayer(pri);
+        if (slot < 0)
+            continue;
+        PlayerRegistry::Entry& entry = registry.entries[slot];
+        if (entry.team != team)
         {
-            if (d.distance < 1000.f)
-                openBonus -= 0.1f;
-            else if (d.distance < 1500.f)
-                openBonus -= 0.05f;
+            entry.team = team;
+            worker.AssignPlayer(slot, entry.uid, entry.name, team);
         }
-        if (openBonus > 0.f)
-            xg += openBonus;
+
+        int k = frame.count++;
+        frame.pri[k] = pri.memory_address;
+        frame.slot[k] = slot;
+        frame.indexOfSlot[slot] = k;
+        frame.team[k] = team;
+        frame.saves[k] = pri.GetMatchSaves();
+
+        CarWrapper car = pri.GetCar();
+        frame.hasCar[k] = static_cast<bool>(car);
+        if (!car)
+        {
+            frame.boost[k] = 0.f;
+            frame.onGround[k] = false;
+            continue;
+        }
+        frame.pos[k] = ToVec3(car.GetLocation());
+        frame.vel[k] = ToVec3(car.GetVelocity());
+        BoostWrapper boost = car.GetBoostComponent();
+        frame.boost[k] = boost ? boost.GetCurrentBoostAmount() : -1.f;
+        frame.onGround[k] = car.AnyWheelTouchingGround();
     }
 
-    int defCount = 0;
-    for (const auto& d : defenders)
+    // Un joueur absent de la liste des PRI a quitte la partie : son
+    // emplacement est conserve pour une eventuelle reconnexion.
+    for (int s = 0; s < registry.count; ++s)
     {
-        if (d.distance < 1500.f && d.boost > 30.f && defCount < 3)
+        if (registry.entries[s].pri != 0 && frame.indexOfSlot[s] < 0)
         {
-            xg -= 0.04f;
-            ++defCount;
+            registry.entries[s].pri = 0;
+            if (debugEnabled)
+                Log("[Registry] " + registry.entries[s].name + " a quitte la partie", LogLevel::Debug);
         }
     }
 
-    if (hardRebound)
-        xg -= 0.05f;
-    if (panicShot)
-        xg -= 0.05f;
-    if (qualityAction)
-        xg += 0.05f;
-
-    return std::clamp(xg, 0.f, 0.95f);
+    if (recorder.IsOpen())
+        RecordFrame(frame, sample);
+    return frame;
 }
 
-std::string AuusaConnectPlugin::DetectShotContext(CarWrapper car, BallWrapper ball, int team, bool openNet, float gameTime, bool isAerial)
+int AuusaConnectPlugin::RegisterPlayer(PriWrapper pri)
 {
-    std::vector<std::string> ctx;
-    BoostWrapper boost = car.GetBoostComponent();
-    float b = boost ? boost.GetCurrentBoostAmount() : 0.f;
-    Vector vel = ball.GetVelocity();
-
-    if (lastTouchPlayer == car.GetPRI().GetPlayerName().ToString() && gameTime - lastTouchTime < 1.f && lastTouchAerial && isAerial)
-        ctx.push_back("double_tap");
-
-    if (b < 5.f && vel.magnitude() > 2500.f)
-        ctx.push_back("panic_shot");
-
-    float targetY = team == 0 ? 5120.f : -5120.f;
-    if (std::fabs(lastBallLocation.Y - targetY) < 300.f && std::fabs(lastBallLocation.Z) > 800.f)
-        ctx.push_back("backboard");
-
-    if (!lastTouchPlayer.empty() && lastTouchPlayer != car.GetPRI().GetPlayerName().ToString())
+    std::string uid = pri.GetUniqueIdWrapper().GetIdString();
+    std::string name = pri.GetPlayerName().ToString();
+    int slot = registry.Register(pri.memory_address, uid, name, pri.GetTeamNum2());
+    if (slot < 0)
     {
-        PriWrapper prevPri = GetPriByName(gameWrapper->GetCurrentGameState(), lastTouchPlayer);
-        if (prevPri && prevPri.GetTeamNum2() == team && gameTime - lastTouchTime < 1.5f && std::fabs(ball.GetLocation().X) < 700.f)
-            ctx.push_back("perfect_center");
+        Log("[Registry] Registre plein, " + name + " ignore");
+        return -1;
     }
+    worker.AssignPlayer(slot, uid, name, pri.GetTeamNum2());
+    if (debugEnabled)
+        Log("[Registry] " + name + " -> emplacement " + std::to_string(slot), LogLevel::Debug);
 
-    if (openNet)
-        ctx.push_back("open_net");
-
-    if (isAerial)
-        ctx.push_back("aerial");
-
-    std::string res;
-    for (size_t i = 0; i < ctx.size(); ++i)
+    if (recorder.IsOpen())
     {
-        res += ctx[i];
-        if (i + 1 < ctx.size())
-            res += " + ";
+        TelemetryPlayer rec{};
+        rec.type = TELEMETRY_PLAYER;
+        rec.slot = static_cast<uint8_t>(slot);
+        rec.team = static_cast<uint8_t>(pri.GetTeamNum2());
+        TelemetryCopyString(rec.name, sizeof(rec.name), name);
+        TelemetryCopyString(rec.uid, sizeof(rec.uid), uid);
+        recorder.WritePlayer(rec);
     }
-    return res;
+    return slot;
 }
 
 void AuusaConnectPlugin::onLoad()
 {
+    gameThread = std::this_thread::get_id();
+    alive = std::make_shared<bool>(true);
+    worker.Analytics().SetLogger([this](const std::string& msg) { Log(msg, LogLevel::Debug); });
     cvarManager->registerCvar("mm_debug", "0", "Active le mode debug").addOnValueChanged([this](std::string, CVarWrapper cvar){
         debugEnabled = cvar.getBoolValue();
+        logger.SetLevel(debugEnabled ? LogLevel::Debug : LogLevel::Info);
+        worker.SetDebug(debugEnabled);
+        poller.SetDebug(debugEnabled);
+        push.SetDebug(debugEnabled);
     });
+    cvarManager->registerCvar("mm_sample_hz", "20", "Frequence d'echantillonnage des statistiques (Hz)", true, true, 1.f, true, 120.f)
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            samplePeriod = 1.f / std::clamp(cvar.getFloatValue(), 1.f, 120.f);
+        });
+    cvarManager->registerCvar("mm_record", "0", "Enregistre la telemetrie des matchs dans le dossier de donnees")
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            recordEnabled = cvar.getBoolValue();
+        });
+    cvarManager->registerCvar("mm_stream", "0", "Envoie buts, demolitions, touches et statistiques pendant le match")
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            streamEnabled = cvar.getBoolValue();
+        });
+    cvarManager->registerCvar("mm_stream_interval", "5", "Delai maximal entre deux envois du flux de match (secondes)", true, true, 1.f, true, 60.f)
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            worker.StreamLimits(cvar.getFloatValue(), static_cast<size_t>(cvarManager->getCvar("mm_stream_events").getIntValue()));
+        });
+    cvarManager->registerCvar("mm_stream_events", "64", "Nombre d'evenements declenchant un envoi du flux de match", true, true, 8.f, true, 512.f)
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            worker.StreamLimits(cvarManager->getCvar("mm_stream_interval").getFloatValue(), static_cast<size_t>(cvar.getIntValue()));
+        });
+    cvarManager->registerCvar("mm_push", "1", "Recoit les parties attribuees par un flux permanent (sinon interrogation seule)")
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            pushEnabled = cvar.getBoolValue();
+            if (pushEnabled)
+                StartPush();
+            else
+                push.Stop();
+            UpdatePollMode();
+        });
+    cvarManager->registerCvar("mm_perf_upload", "0", "Joint au resultat de match la latence des hooks et des requetes")
+        .addOnValueChanged([this](std::string, CVarWrapper cvar){
+            perfUpload = cvar.getBoolValue();
+        });
     cvarManager->registerCvar("mm_player_id", "unknown", "Pseudo du joueur en jeu")
         .addOnValueChanged([this](std::string, CVarWrapper cvar){
             std::string val = cvar.getStringValue();
             if(!val.empty() && val != "unknown")
             {
-                apiDisabled = false;
-                PollSupabase();
+                poller.SetPlayerId(val);
+                push.SetPlayerId(val);
+                UpdatePollMode();
             }
         });
 
@@ -326,24 +350,111 @@ void AuusaConnectPlugin::onLoad()
         PERMISSION_ALL);
     cvarManager->registerNotifier(
         "mm_poll_now",
-        [this](std::vector<std::string>) { PollSupabase(); },
+        [this](std::vector<std::string>) { poller.PollNow(); },
         "Force une verification immediate du serveur",
         PERMISSION_ALL);
+    cvarManager->registerNotifier(
+        "mm_session_stats",
+        [this](std::vector<std::string> args) {
+            if (args.size() > 1 && args[1] == "reset")
+            {
+                session.Reset();
+                Log("[Session] Statistiques de session remises a zero");
+                return;
+            }
+            Log("[Session] " + std::to_string(session.Matches()) + " match(s) depuis le chargement du plugin");
+            for (const SessionPlayer& player : session.Players())
+                Log("[Session] " + SessionStats::Describe(player));
+        },
+        "Affiche les statistiques cumulees de la session (\"reset\" pour les remettre a zero)",
+        PERMISSION_ALL);
+    cvarManager->registerNotifier(
+        "mm_perf",
+        [this](std::vector<std::string> args) {
+            if (args.size() > 1 && args[1] == "reset")
+            {
+                perf.Reset();
+                Log("[Perf] Mesures remises a zero");
+                return;
+            }
+            for (int hook = 0; hook < PERF_HOOK_COUNT; ++hook)
+                Log("[Perf] " + perf.Describe(static_cast<PerfHook>(hook)));
+        },
+        "Affiche le nombre d'appels et la latence (p50, p99, max) de chaque hook et requete (\"reset\" pour les remettre a zero)",
+        PERMISSION_ALL);
     debugEnabled = cvarManager->getCvar("mm_debug").getBoolValue();
+    logger.SetLevel(debugEnabled ? LogLevel::Debug : LogLevel::Info);
+    worker.SetDebug(debugEnabled);
+    poller.SetDebug(debugEnabled);
+    push.SetDebug(debugEnabled);
+    pushEnabled = cvarManager->getCvar("mm_push").getBoolValue();
+    recordEnabled = cvarManager->getCvar("mm_record").getBoolValue();
+    streamEnabled = cvarManager->getCvar("mm_stream").getBoolValue();
+    perfUpload = cvarManager->getCvar("mm_perf_upload").getBoolValue();
+    worker.StreamLimits(cvarManager->getCvar("mm_stream_interval").getFloatValue(),
+                     static_cast<size_t>(cvarManager->getCvar("mm_stream_events").getIntValue()));
+    samplePeriod = 1.f / std::clamp(cvarManager->getCvar("mm_sample_hz").getFloatValue(), 1.f, 120.f);
     std::filesystem::path logPath = gameWrapper->GetDataFolder() / "matchmaking.log";
-    logFile.open(logPath.string(), std::ios::app);
+    if (!logger.Open(logPath, LOG_MAX_BYTES, LOG_KEEP_FILES))
+        cvarManager->log("[Log] Impossible d'ouvrir " + logPath.string());
     Log("Plugin loaded");
     LoadConfig();
+    LoadAssignmentId();
+    // Les resultats non envoyes survivent a un plantage ou a une panne du bot
+    uploader.SetJournal((gameWrapper->GetDataFolder() / "uploads.journal").string());
+    uploader.SetLatency(&perf.Hook(PERF_UPLOAD));
+    poller.SetLatency(&perf.Hook(PERF_POLL));
+    uploader.Start([this](const std::string& msg) { Log(msg); });
+    // Les lots du flux sont deposes par le thread d'analyse
+    worker.Stream().SetSubmit([this, url = botEndpoint + "/events"](std::shared_ptr<const StreamBatch> batch) {
+        UploadWorker::Job job;
+        job.url = url;
+        job.build = [batch] { return batch->ToJson(); };
+        job.quiet = true;
+        // Le dernier lot peut prendre toute la file sauf la place du resultat
+        return uploader.Enqueue(std::move(job), batch->final ? UploadWorker::MAX_PENDING - 1 : STREAM_MAX_PENDING);
+    });
+    worker.Start([this](const std::string& msg) { Log(msg); });
     HookEvents();
 
-    PollSupabase();
+    poller.Start(
+        DEFAULT_API_BASE,
+        [this](const std::string& msg) { Log(msg); },
+        [this](const json& instr) { RunOnGameThread([this, instr] { HandleInstructions(instr); }); });
+    if (pushEnabled)
+        StartPush();
+    SchedulePollMode();
+}
+
+void AuusaConnectPlugin::StartPush()
+{
+    if (lastAssignmentId != 0)
+        push.SetLastEventId(std::to_string(lastAssignmentId));
+    push.Start(
+        DEFAULT_API_BASE,
+        [this](const std::string& msg) { Log(msg); },
+        [this](const json& instr) { RunOnGameThread([this, instr] { HandleInstructions(instr); }); });
 }
 
 void AuusaConnectPlugin::onUnload()
 {
+    StopSampler();
+    StopRecording();
+    StopStream(frame.time);
+    // Derniers lots du flux remis au thread d'envoi avant son arret
+    worker.Stop();
+    uploader.Stop();
+    push.Stop();
+    poller.Stop();
+    if (uploader.Backlog() > 0)
+        Log("[Stats] " + std::to_string(uploader.Backlog()) + " resultat(s) en attente dans le journal, renvoi au prochain chargement");
+    Log("[Push] Bilan du flux : " + push.Summary());
+    Log("[API] Bilan de l'interrogation : " + poller.Summary());
     Log("Plugin unloaded");
-    if (logFile.is_open())
-        logFile.close();
+    if (logger.Dropped() > 0)
+        cvarManager->log("[Log] " + std::to_string(logger.Dropped()) + " message(s) perdu(s) depuis le chargement");
+    logger.Close();
+    alive.reset();
 }
 
 void AuusaConnectPlugin::LoadConfig()
@@ -355,9 +466,12 @@ void AuusaConnectPlugin::LoadConfig()
 
     botEndpoint = getEnv("BOT_ENDPOINT");
     apiSecret = getEnv("API_SECRET");
+    std::string compression = getEnv("UPLOAD_COMPRESSION");
+    std::string compressMin = getEnv("UPLOAD_COMPRESSION_MIN_BYTES");
+    std::string format = getEnv("UPLOAD_FORMAT");
 
     std::filesystem::path path = gameWrapper->GetDataFolder() / "config.json";
-    if (botEndpoint.empty() || apiSecret.empty())
+    if (botEndpoint.empty() || apiSecret.empty() || compression.empty() || compressMin.empty() || format.empty())
     {
         std::ifstream file(path);
         if (!file.is_open())
@@ -375,6 +489,10 @@ void AuusaConnectPlugin::LoadConfig()
             {
                 if (botEndpoint.empty()) botEndpoint = cfg.value("BOT_ENDPOINT", "");
                 if (apiSecret.empty()) apiSecret = cfg.value("API_SECRET", "");
+                if (compression.empty()) compression = cfg.value("UPLOAD_COMPRESSION", "");
+                if (format.empty()) format = cfg.value("UPLOAD_FORMAT", "");
+                if (compressMin.empty() && cfg.contains("UPLOAD_COMPRESSION_MIN_BYTES"))
+                    compressMin = cfg["UPLOAD_COMPRESSION_MIN_BYTES"].dump();
 
                 for (auto& [key, val] : cfg.items())
                 {
@@ -393,120 +511,170 @@ void AuusaConnectPlugin::LoadConfig()
     Log("[Config] BOT_ENDPOINT=" + botEndpoint);
     if (apiSecret.empty())
         Log("[Config] API_SECRET manquant");
+    // Signataire cree une fois pour la session ; les envois ne hachent
+    // plus que leur corps
+    HmacSha256 signer(apiSecret);
+    if (signer.HasKey())
+        Log(std::string("[Config] Signature HMAC-SHA256 (") + Sha256KernelName(signer.Kernel()) + ")");
+    uploader.SetSigner(std::move(signer));
+
+    // Compression des resultats envoyes : gzip par defaut, a partir de 1 Ko
+    UploadCompression mode = UploadCompression::Gzip;
+    if (compression == "none")
+        mode = UploadCompression::None;
+    else if (compression == "zstd")
+        mode = UploadCompression::Zstd;
+    else if (!compression.empty() && compression != "gzip")
+        Log("[Config] UPLOAD_COMPRESSION inconnu (" + compression + "), gzip utilise");
+    if (!UploadWorker::Available(mode))
+    {
+        Log("[Config] zstd non disponible dans cette version du plugin, gzip utilise");
+        mode = UploadCompression::Gzip;
+    }
+    size_t minBytes = UploadWorker::DEFAULT_MIN_COMPRESS;
+    if (!compressMin.empty())
+    {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(compressMin.c_str(), &end, 10);
+        if (end && *end == '\0')
+            minBytes = static_cast<size_t>(value);
+        else
+            Log("[Config] UPLOAD_COMPRESSION_MIN_BYTES invalide : " + compressMin);
+    }
+    uploader.SetCompression(mode, minBytes);
+    Log(std::string("[Config] Compression des envois : ") + UploadWorker::CompressionName(mode)
+        + (mode == UploadCompression::None ? "" : " a partir de " + std::to_string(minBytes) + " octets"));
+
+    // Format du resultat de fin de match : JSON par defaut, CBOR si le bot
+    // l'accepte (sinon repli en JSON sur 415)
+    uploadFormat = PayloadFormat::Json;
+    if (format == "cbor")
+        uploadFormat = PayloadFormat::Cbor;
+    else if (!format.empty() && format != "json")
+        Log("[Config] UPLOAD_FORMAT inconnu (" + format + "), json utilise");
+    Log(std::string("[Config] Format des resultats : ") + PayloadFormatName(uploadFormat));
 }
 
-void AuusaConnectPlugin::PollSupabase()
+void AuusaConnectPlugin::SchedulePollMode()
 {
+    UpdatePollMode();
+    std::weak_ptr<bool> token = alive;
+    gameWrapper->SetTimeout([this, token](GameWrapper*) {
+        if (!token.expired())
+            SchedulePollMode();
+    }, 3.0f);
+}
+
+void AuusaConnectPlugin::UpdatePollMode()
+{
+    std::string playerId = cvarManager->getCvar("mm_player_id").getStringValue();
+    bool missingId = playerId.empty() || playerId == "unknown";
+    if (missingId && !apiDisabled)
+        Log("mm_player_id manquant ou \"unknown\". Le pseudo du joueur n'a pas pu etre recupere.");
+    apiDisabled = missingId;
+
+    // Ne pas interroger le serveur si l'on est déjà dans une partie en ligne.
+    // `IsInGame()` renvoie également vrai en entraînement ou en freeplay :
+    // on y interroge seulement moins souvent.
+    PlayerPoller::Mode mode = PlayerPoller::Mode::Normal;
+    std::string reason;
     if (apiDisabled)
+        reason = "pseudo inconnu";
+    else if (creatingMatch)
+        reason = "match en cours de création";
+    else if (autoJoined)
+        reason = "en attente de rejoindre la partie";
+    else if (gameWrapper->IsInOnlineGame())
+        reason = "déjà en partie en ligne";
+    else if (pushEnabled && push.Connected())
+        reason = "flux push ouvert";
+    if (!reason.empty())
+        mode = PlayerPoller::Mode::Paused;
+    else if (gameWrapper->IsInGame())
+        mode = PlayerPoller::Mode::Slow;
+
+    if (mode == pollMode)
         return;
+    pollMode = mode;
+    poller.SetMode(mode);
+    if (mode == PlayerPoller::Mode::Paused)
+        Log("[API] Interrogation suspendue : " + reason);
+    else if (mode == PlayerPoller::Mode::Slow)
+        Log("[API] Interrogation ralentie (entraînement ou freeplay)");
+    else
+        Log("[API] Interrogation active");
+}
 
-    if (creatingMatch)
+void AuusaConnectPlugin::HandleInstructions(const json& instr)
+{
+    std::string name = instr.value("rl_name", "");
+    std::string password = instr.value("rl_password", "");
+    std::string queueType = instr.value("queue_type", "");
+    if (name.empty())
     {
-        Log("[API] Requête ignorée : match en cours de création");
-        gameWrapper->SetTimeout(std::bind(&AuusaConnectPlugin::PollSupabase, this), 3.0f);
+        // {"queued": true} seul : le joueur attend encore son match
+        if (!instr.value("queued", false))
+            Log("[API] Champ rl_name absent, aucune action");
         return;
     }
-
-    if (autoJoined)
+    uint64_t id = instr.value("id", uint64_t{0});
+    if (id != 0 && id <= lastAssignmentId)
     {
-        Log("[API] Requête ignorée : en attente de rejoindre la partie");
-        gameWrapper->SetTimeout(std::bind(&AuusaConnectPlugin::PollSupabase, this), 3.0f);
+        Log("[API] Attribution " + std::to_string(id) + " deja traitee, ignoree", LogLevel::Debug);
         return;
     }
+    lastServerName = name;
+    lastServerPassword = password;
+    Log("[API] rl_name=" + name + ", rl_password=" + password);
 
-    // Ne pas interroger le serveur si l'on est déjà dans une partie en ligne.
-    // `IsInGame()` renvoie également vrai en entraînement ou en freeplay,
-    // ce qui empêchait toute requête lorsqu'on attendait dans ces modes.
-    if (gameWrapper->IsInOnlineGame())
+    // Le flux et l'interrogation peuvent livrer la meme attribution
+    if (creatingMatch || autoJoined)
     {
-        Log("[API] Requête ignorée : déjà en partie en ligne");
-        gameWrapper->SetTimeout(std::bind(&AuusaConnectPlugin::PollSupabase, this), 3.0f);
+        Log("[API] Attribution ignoree : partie deja en cours de creation ou de connexion");
         return;
     }
 
-    std::string playerId = cvarManager->getCvar("mm_player_id").getStringValue();
-    if (playerId.empty() || playerId == "unknown")
-    {
-        Log("mm_player_id manquant ou \"unknown\". Le pseudo du joueur n'a pas pu etre recupere.");
-        apiDisabled = true;
+    auto mm = gameWrapper->GetMatchmakingWrapper();
+    if (!mm)
         return;
+    if (!queueType.empty())
+    {
+        CustomMatchSettings settings{};
+        settings.ServerName = name;
+        settings.Password = password;
+        settings.MapName = "Stadium_P";
+        settings.MaxPlayerCount = 2; // 1v1
+        creatingMatch = true;
+        mm.CreatePrivateMatch(Region::EU, static_cast<int>(PlaylistIds::PrivateMatch), settings);
+        gameWrapper->Toast("AuusaConnect", "\xF0\x9F\x8E\xAE Partie créée automatiquement", "default", 3.0f);
     }
-    gameWrapper->SetTimeout(std::bind(&AuusaConnectPlugin::PollSupabase, this), 3.0f);
+    else
+    {
+        autoJoined = true;
+        mm.JoinPrivateMatch(name, password);
+        gameWrapper->Toast("AuusaConnect", "\xF0\x9F\x8E\xAE Partie rejointe automatiquement", "default", 3.0f);
+    }
+    if (id != 0)
+    {
+        lastAssignmentId = id;
+        SaveAssignmentId();
+    }
+    UpdatePollMode();
+}
 
-    std::thread([this, playerId]() {
-        try
-        {
-            cpr::Response r = cpr::Get(
-                cpr::Url{std::string(DEFAULT_API_BASE) + "/player"},
-                cpr::Parameters{{"player_id", playerId}},
-                cpr::VerifySsl{false});
-            if (r.error.code != cpr::ErrorCode::OK)
-            {
-                Log(std::string("[API] Erreur reseau : ") + r.error.message);
-                return;
-            }
-            if (r.status_code != 200)
-            {
-                Log("[API] Erreur HTTP " + std::to_string(r.status_code) + ": " + r.text);
-                return;
-            }
-            auto instr = json::parse(r.text, nullptr, false);
-            if (!instr.is_object())
-            {
-                Log("[API] Réponse JSON vide ou invalide: " + r.text);
-                return;
-            }
-            std::string name = instr.value("rl_name", "");
-            std::string password = instr.value("rl_password", "");
-            std::string queueType = instr.value("queue_type", "");
-            if (name.empty())
-            {
-                Log("[API] Champ rl_name absent, aucune action");
-                return;
-            }
-            lastServerName = name;
-            lastServerPassword = password;
-            Log("[API] rl_name=" + name + ", rl_password=" + password);
-            if (!queueType.empty())
-            {
-                gameWrapper->Execute([this, name, password](GameWrapper* gw) {
-                    auto mm = gw->GetMatchmakingWrapper();
-                    if (mm)
-                    {
-                        CustomMatchSettings settings{};
-                        settings.ServerName = name;
-                        settings.Password = password;
-                        settings.MapName = "Stadium_P";
-                        settings.MaxPlayerCount = 2; // 1v1
-                        creatingMatch = true;
-                        mm.CreatePrivateMatch(Region::EU, static_cast<int>(PlaylistIds::PrivateMatch), settings);
-                        gw->Toast("AuusaConnect", "\xF0\x9F\x8E\xAE Partie créée automatiquement", "default", 3.0f);
-                    }
-                });
-            }
-            else if (!autoJoined)
-            {
-                autoJoined = true;
-                gameWrapper->Execute([this, name, password](GameWrapper* gw) {
-                    auto mm = gw->GetMatchmakingWrapper();
-                    if (mm)
-                    {
-                        mm.JoinPrivateMatch(name, password);
-                        gw->Toast("AuusaConnect", "\xF0\x9F\x8E\xAE Partie rejointe automatiquement", "default", 3.0f);
-                    }
-                });
-            }
+void AuusaConnectPlugin::LoadAssignmentId()
+{
+    std::ifstream file(gameWrapper->GetDataFolder() / "assignment.id");
+    if (!(file >> lastAssignmentId))
+        lastAssignmentId = 0;
+}
 
-        }
-        catch (const std::exception& e)
-        {
-            Log(std::string("[API] Exception: ") + e.what());
-        }
-        catch (...)
-        {
-            Log("[API] Exception inconnue lors de la requete");
-        }
-    }).detach();
+void AuusaConnectPlugin::SaveAssignmentId()
+{
+    std::filesystem::path path = gameWrapper->GetDataFolder() / "assignment.id";
+    std::ofstream file(path, std::ios::trunc);
+    if (!(file << lastAssignmentId))
+        Log("[API] Impossible d'ecrire " + path.string(), LogLevel::Warning);
 }
 
 void AuusaConnectPlugin::HookEvents()
@@ -547,202 +715,248 @@ void AuusaConnectPlugin::HookEvents()
         "Function TAGame.GameEvent_Soccar_TA.EventGoalScored",
         std::bind(&AuusaConnectPlugin::OnGoalScored, this, std::placeholders::_1));
     Log("[HOOK] EventGoalScored OK");
+
+    gameWrapper->HookEventPost(
+        "Function GameEvent_Soccar_TA.Countdown.BeginState",
+        [this](std::string) { if (phase != GamePhase::Idle) SetPhase(GamePhase::Countdown); });
+    Log("[HOOK] Countdown OK");
+
+    gameWrapper->HookEventPost(
+        "Function GameEvent_Soccar_TA.Active.StartRound",
+        [this](std::string) { if (phase != GamePhase::Idle) SetPhase(GamePhase::Live); });
+    Log("[HOOK] StartRound OK");
+
+    // Partie quittee sans EventMatchEnded (retour au menu, deconnexion)
+    gameWrapper->HookEvent(
+        "Function TAGame.GameEvent_Soccar_TA.Destroyed",
+        [this](std::string) {
+            StopSampler();
+            SetPhase(GamePhase::Idle);
+            StopRecording();
+            StopStream(frame.time);
+        });
+    Log("[HOOK] GameEvent Destroyed OK");
     // On gère les démolitions directement dans OnCarDemolish,
     // cette écoute n'est plus nécessaire.
 }
-
 void AuusaConnectPlugin::OnMatchStart(ServerWrapper server, void* /*params*/, std::string /*eventName*/)
 {
-    lastTotalScore = 0;
-    stats.clear();
-    lastUpdate = 0.f;
-    lastTouchPlayer.clear();
-    lastTouchTime = 0.f;
-    lastTeamTouchPlayer[0].clear();
-    lastTeamTouchPlayer[1].clear();
-    lastTeamTouchTime[0] = lastTeamTouchTime[1] = 0.f;
-    lastBallLocation = server.GetBall().GetLocation();
-    ArrayWrapper<PriWrapper> pris = server.GetPRIs();
-    for (int i = 0; i < pris.Count(); ++i)
-    {
-        PriWrapper pri = pris.Get(i);
-        if (!pri)
-            continue;
-        CarWrapper car = pri.GetCar();
-        if (!car)
-            continue;
-        BoostWrapper boost = car.GetBoostComponent();
-        if (!boost)
-            continue;
-        stats[pri.GetPlayerName().ToString()].lastBoost = boost.GetCurrentBoostAmount();
-    }
-
-    TickStats();
+    registry.Reset();
+    lastGoalTotal = 0;
+    worker.Reset();
+    frame = FrameSnapshot{};
+    StartRecording();
+    SetPhase(GamePhase::Countdown);
+    worker.OnMatchStart(CaptureFrame(server));
+    StartStream(server);
+
+    StartSampler();
 }
 
-void AuusaConnectPlugin::TickStats()
+void AuusaConnectPlugin::StartStream(ServerWrapper server)
 {
-    ServerWrapper sw = gameWrapper->GetCurrentGameState();
-    if (sw)
-    {
-        float now = sw.GetSecondsElapsed();
-        float dt = lastUpdate > 0.f ? now - lastUpdate : 0.f;
-        lastUpdate = now;
-
-        BallWrapper ball = sw.GetBall();
-        if (ball)
-            lastBallVel = ball.GetVelocity();
-
-        ArrayWrapper<PriWrapper> pris = sw.GetPRIs();
-        Vector ballLoc = ball.GetLocation();
-        std::vector<std::pair<PriWrapper, float>> teamPlayers[2];
-        for (int i = 0; i < pris.Count(); ++i)
-        {
-            PriWrapper pri = pris.Get(i);
-            if (!pri)
-                continue;
-
-            std::string name = pri.GetPlayerName().ToString();
-            CarWrapper car = pri.GetCar();
-            if (!car)
-                continue;
-            BoostWrapper boost = car.GetBoostComponent();
+    StopStream(frame.time);
+    if (!streamEnabled || gameWrapper->IsInFreeplay())
+        return;
 
-            PlayerStats &ps = stats[name];
-            if (boost)
-            {
-                // Mise a jour simple de la valeur actuelle pour permettre un suivi correct
-                // dans l'evenement OnBoostCollected sans compter deux fois les pickups.
-                ps.lastBoost = boost.GetCurrentBoostAmount();
-            }
+    // Identifiant propre a ce client : le serveur regroupe les lots par match
+    // et ignore ceux qu'il a deja recus (matchId, seq)
+    static std::mt19937_64 rng{std::random_device{}()};
+    std::ostringstream id;
+    id << std::time(nullptr) << '-' << std::hex << (rng() & 0xFFFFFFFFull);
+    worker.StreamBegin(id.str(), cvarManager->getCvar("mm_player_id").getStringValue(), server.GetSecondsElapsed());
+    streaming = true;
+    Log("[Stream] Flux du match " + id.str() + " vers " + botEndpoint + "/events");
+}
 
-            Vector pos = car.GetLocation();
-            int team = pri.GetTeamNum2();
-            bool playerInOppHalf = (team == 0 && pos.Y > 0) || (team == 1 && pos.Y < 0);
-            bool ballInOppHalf = (team == 0 && ballLoc.Y > 0) || (team == 1 && ballLoc.Y < 0);
-            bool recentlyTouched = (lastTouchPlayer == name && now - lastTouchTime < 0.5f);
-            bool cooldown = (now - ps.lastHighPressTime < 2.f);
-            bool oppClose = false;
+void AuusaConnectPlugin::StopStream(float now)
+{
+    if (!streaming)
+        return;
+    // Le bilan des lots est journalise par le thread d'analyse
+    worker.StreamEnd(now);
+    streaming = false;
+}
 
-            if (playerInOppHalf && ballInOppHalf && !recentlyTouched && !cooldown)
-            {
-                PriWrapper possPri = GetPriByName(sw, lastTouchPlayer);
-                if (possPri && possPri.GetTeamNum2() != team)
-                {
-                    CarWrapper oppCar = possPri.GetCar();
-                    if (oppCar)
-                    {
-                        Vector oppPos = oppCar.GetLocation();
-                        float oppDist = (oppPos - pos).magnitude();
-                        bool between = (team == 0) ? (oppPos.Y < pos.Y) : (oppPos.Y > pos.Y);
-                        if (oppDist < 2000.f && between)
-                            oppClose = true;
-                    }
-                }
-            }
+void AuusaConnectPlugin::SetPhase(GamePhase next)
+{
+    GamePhase prev = phase;
+    if (next == prev)
+        return;
+    if (debugEnabled)
+        Log(std::string("[Phase] ") + GamePhaseName(prev) + " -> " + GamePhaseName(next), LogLevel::Debug);
+    phase = next;
+    // Comme MatchAnalytics::SetPhase : le temps hors jeu n'est pas integre
+    if (next == GamePhase::Live)
+        lastSampleTime = 0.f;
+    worker.SetPhase(next);
+    RecordEvent(TELEMETRY_PHASE, static_cast<int>(next));
+}
 
-            if (oppClose)
-            {
-                ps.highPressings++;
-                ps.lastHighPressTime = now;
-                if (debugEnabled) Log("[DEBUG] High pressing compté pour " + name);
-            }
-            bool inDef = (team == 0) ? pos.Y < 0 : pos.Y > 0;
-            if (inDef)
-                ps.defenseTime += dt;
+void AuusaConnectPlugin::StartRecording()
+{
+    StopRecording();
+    std::fill(std::begin(recordedSaves), std::end(recordedSaves), 0);
+    if (!recordEnabled)
+        return;
 
-            int saves = pri.GetMatchSaves();
-            if (saves > ps.prevSaves)
-            {
-                ps.prevSaves = saves;
-                bool lastDef = true;
-                for (int j = 0; j < pris.Count(); ++j)
-                {
-                    if (j == i)
-                        continue;
-                    PriWrapper mate = pris.Get(j);
-                    if (!mate || mate.GetTeamNum2() != team)
-                        continue;
-                    CarWrapper mcar = mate.GetCar();
-                    if (!mcar)
-                        continue;
-                    Vector mpos = mcar.GetLocation();
-                    if ((team == 0 && mpos.Y < pos.Y) || (team == 1 && mpos.Y > pos.Y))
-                    {
-                        lastDef = false;
-                        break;
-                    }
-                }
-                if (lastDef)
-                    ps.clutchSaves++;
-            }
+    std::filesystem::path dir = gameWrapper->GetDataFolder() / "telemetry";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::time_t now = std::time(nullptr);
+    std::filesystem::path path = dir / ("match_" + std::to_string(static_cast<long long>(now)) + ".amt");
+    if (!recorder.Open(path.string(), 1.f / samplePeriod, static_cast<int64_t>(now)))
+    {
+        Log("[Telemetry] Impossible d'ouvrir " + path.string());
+        return;
+    }
+    Log("[Telemetry] Enregistrement dans " + path.string());
+}
 
-            float dist = (pos - ballLoc).magnitude();
-            teamPlayers[team].push_back({pri, dist});
-        }
+void AuusaConnectPlugin::StopRecording()
+{
+    if (!recorder.IsOpen())
+        return;
+    uint64_t size = recorder.Size();
+    recorder.Close();
+    Log("[Telemetry] Enregistrement termine (" + std::to_string(size / 1024) + " Ko)");
+}
 
-        for (int t = 0; t < 2; ++t)
+void AuusaConnectPlugin::RecordFrame(const FrameSnapshot& f, bool sample)
+{
+    TelemetryFrame rec;
+    TelemetryLane lanes[MAX_PLAYERS];
+    TelemetryEncodeFrame(f, rec, lanes);
+    if (sample)
+        rec.flags |= TELEMETRY_FRAME_SAMPLE;
+    recorder.WriteFrame(rec, lanes);
+
+    // Le compteur d'arrets change rarement : il est enregistre comme evenement
+    for (int i = 0; i < f.count; ++i)
+    {
+        if (f.saves[i] != recordedSaves[f.slot[i]])
         {
-            auto &vec = teamPlayers[t];
-            std::sort(vec.begin(), vec.end(), [](const auto &a, const auto &b){ return a.second < b.second; });
-            for (size_t j = 0; j < vec.size(); ++j)
-            {
-                PriWrapper pri = vec[j].first;
-                if (!pri)
-                    continue;
-                std::string name = pri.GetPlayerName().ToString();
-                PlayerStats &ps = stats[name];
+            recordedSaves[f.slot[i]] = f.saves[i];
+            RecordEvent(TELEMETRY_SAVES, f.slot[i], -1, static_cast<float>(f.saves[i]));
+        }
+    }
+}
 
-                int role = static_cast<int>(j) + 1;
-                if (role <= 3)
-                    ps.roleTime[role - 1] += dt;
+void AuusaConnectPlugin::RecordEvent(uint8_t type, int slot, int other, float a, float b)
+{
+    if (!recorder.IsOpen())
+        return;
+    TelemetryEvent ev{};
+    ev.type = type;
+    ev.slot = static_cast<uint8_t>(slot < 0 ? 0xFF : slot);
+    ev.other = static_cast<uint8_t>(other < 0 ? 0xFF : other);
+    ev.time = frame.time;
+    ev.a = a;
+    ev.b = b;
+    recorder.WriteEvent(ev);
+}
 
-                ps.timeSinceAttack += dt;
+// Filet de securite si un hook de changement d'etat n'a pas ete recu :
+// l'etat du round et la pause sont verifies a chaque frame.
+void AuusaConnectPlugin::UpdatePhase(ServerWrapper server)
+{
+    bool paused = gameWrapper->IsPaused();
+    bool roundActive = server.GetbRoundActive() != 0;
+    switch (phase)
+    {
+    case GamePhase::Live:
+        if (paused)
+            SetPhase(GamePhase::Paused);
+        break;
+    case GamePhase::Paused:
+        if (!paused)
+            SetPhase(GamePhase::Live);
+        break;
+    case GamePhase::Countdown:
+    case GamePhase::GoalReplay:
+        if (roundActive && !paused)
+            SetPhase(GamePhase::Live);
+        break;
+    default:
+        break;
+    }
+}
 
-                if (ps.lastRole != -1 && role < ps.lastRole - 1)
-                    ps.cuts++;
+// Les statistiques de rotation sont echantillonnees depuis le tick de rendu
+// du jeu, au plus mm_sample_hz fois par seconde, et integrees avec le temps
+// de partie reellement ecoule. Le hook n'est actif que pendant un match.
+void AuusaConnectPlugin::StartSampler()
+{
+    sampleCount = 0;
+    sampleTotalUs = 0.0;
+    sampleMaxUs = 0.0;
+    if (samplerAttached)
+        return;
+    gameWrapper->HookEvent(
+        "Function Engine.GameViewportClient.Tick",
+        [this](std::string) { OnFrameTick(); });
+    samplerAttached = true;
+}
 
-                if (role == 1)
-                    ps.firstStreak += dt;
-                else
-                {
-                    if (ps.firstStreak > 5.f)
-                        ps.aggressiveTime += ps.firstStreak;
-                    ps.firstStreak = 0.f;
-                }
+void AuusaConnectPlugin::StopSampler()
+{
+    if (!samplerAttached)
+        return;
+    gameWrapper->UnhookEvent("Function Engine.GameViewportClient.Tick");
+    samplerAttached = false;
+    if (debugEnabled && sampleCount > 0)
+    {
+        Log("[Sampler] " + std::to_string(sampleCount) + " echantillons, moyenne "
+            + std::to_string(sampleTotalUs / sampleCount) + " us, max "
+            + std::to_string(sampleMaxUs) + " us", LogLevel::Debug);
+    }
+}
 
-                if (role == 3)
-                    ps.thirdStreak += dt;
-                else
-                {
-                    if (ps.thirdStreak > 5.f)
-                        ps.passiveTime += ps.thirdStreak;
-                    ps.thirdStreak = 0.f;
-                }
+void AuusaConnectPlugin::OnFrameTick()
+{
+    ServerWrapper sw = gameWrapper->GetCurrentGameState();
+    if (!sw)
+        return;
+    UpdatePhase(sw);
+    if (phase != GamePhase::Live)
+        return;
+    if (lastSampleTime > 0.f && sw.GetSecondsElapsed() - lastSampleTime < samplePeriod)
+        return;
 
-                if (ps.inAttack)
-                {
-                    if (ps.timeSinceAttack > 3.f && role != 3)
-                        ps.ballchaseTime += dt;
-                    if (role == 3 && ps.timeSinceAttack > 1.f)
-                        ps.inAttack = false;
-                }
+    auto start = std::chrono::steady_clock::now();
+    TickStats();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    perf.Hook(PERF_TICK_STATS).Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    double us = std::chrono::duration<double, std::micro>(elapsed).count();
+    sampleCount++;
+    sampleTotalUs += us;
+    sampleMaxUs = std::max(sampleMaxUs, us);
+}
 
-                ps.lastRole = role;
-            }
-        }
-    }
-    gameWrapper->SetTimeout(std::bind(&AuusaConnectPlugin::TickStats, this), 0.1f);
+void AuusaConnectPlugin::TickStats()
+{
+    ServerWrapper sw = gameWrapper->GetCurrentGameState();
+    if (!sw)
+        return;
+    const FrameSnapshot& f = CaptureFrame(sw, true);
+    worker.Sample(f);
+    lastSampleTime = f.time;
 }
 
 void AuusaConnectPlugin::OnGameEnd()
 {
+    PerfScope scope(&perf.Hook(PERF_GAME_END));
     try
     {
         Log("[OnGameEnd] Debut du traitement");
+        StopSampler();
+        SetPhase(GamePhase::Podium);
+        // Dernier lot du flux avant le resultat complet
+        StopStream(frame.time);
 
         creatingMatch = false;
         autoJoined = false;
+        poller.NoteActivity();
 
         // Nettoie les cvars Rocket League afin d'eviter toute reutilisation accidentelle
         auto clearCvar = [this](const std::string& name)
@@ -760,11 +974,15 @@ void AuusaConnectPlugin::OnGameEnd()
 
         ServerWrapper sw = gameWrapper->GetCurrentGameState();
         if (!sw)
+        {
+            StopRecording();
             return;
+        }
 
     if (gameWrapper->IsInFreeplay())
     {
         Log("Statistiques non generees : session freeplay");
+        StopRecording();
         return;
     }
 
@@ -772,6 +990,7 @@ void AuusaConnectPlugin::OnGameEnd()
     if (prisCheck.Count() < 2)
     {
         Log("Statistiques non generees : nombre de joueurs insuffisant pour analyser un match.");
+        StopRecording();
         return;
     }
 
@@ -786,166 +1005,105 @@ void AuusaConnectPlugin::OnGameEnd()
     std::string orangeName = orangeTeam.GetTeamName().ToString();
     std::string mapName = gameWrapper->GetCurrentMap();
 
-    ArrayWrapper<PriWrapper> pris = sw.GetPRIs();
-    json players = json::array();
-    json scorers = json::array();
-    std::string mvp = "";
-    int bestScore = -1;
+    MatchSummary summary;
+    summary.scoreBlue = scoreBlue;
+    summary.scoreOrange = scoreOrange;
+    summary.teamBlue = blueName;
+    summary.teamOrange = orangeName;
+    summary.map = mapName;
+    summary.secondsElapsed = sw.GetSecondsElapsed();
+    summary.totalGameTime = sw.GetTotalGameTimePlayed();
 
+    ArrayWrapper<PriWrapper> pris = sw.GetPRIs();
     for (int i = 0; i < pris.Count(); ++i)
     {
         PriWrapper pri = pris.Get(i);
         if (!pri)
             continue;
 
-        std::string pname = pri.GetPlayerName().ToString();
-        PlayerStats ps = stats[pname];
-        // Utilise directement le temps total de jeu expose par ServerWrapper
-        float totalTime = sw.GetTotalGameTimePlayed();
-        float rTotal = ps.roleTime[0] + ps.roleTime[1] + ps.roleTime[2];
-        float ideal = rTotal / 3.f;
-        float diff = rTotal > 0.f ? (fabs(ps.roleTime[0] - ideal) + fabs(ps.roleTime[1] - ideal) + fabs(ps.roleTime[2] - ideal)) / rTotal : 0.f;
-        float defenseRatio = totalTime > 0.f ? ps.defenseTime / totalTime : 0.f;
-        float scoreRot = 100.f - diff * 40.f - ps.cuts * 5.f
-                         - ps.aggressiveTime * 10.f - ps.passiveTime * 10.f
-                         - ps.ballchaseTime * 15.f
-                         - ps.doubleCommits * 3.f
-                         - fabs(defenseRatio - 0.5f) * 30.f;
-        scoreRot = std::clamp(scoreRot, 0.f, 100.f);
-
-        float xgTotal = 0.f;
-        for (float v : ps.xgAttempts)
-            xgTotal += v;
-
-        json p = {
-            {"name", pname},
-            {"team", pri.GetTeamNum2()},
-            {"goals", ps.goals > 0 ? ps.goals : pri.GetMatchGoals()},
-            {"assists", ps.assists > 0 ? ps.assists : pri.GetMatchAssists()},
-            {"shots", ps.shotsOnTarget > 0 ? ps.shotsOnTarget : pri.GetMatchShots()},
-            {"saves", pri.GetMatchSaves()},
-            {"score", pri.GetMatchScore()},
-            {"boostPickups", ps.boostPickups},
-            {"wastedBoostPickups", ps.wastedBoosts},
-            {"boostFrequency", totalTime > 0 ? ps.boostPickups / totalTime : 0},
-            {"rotationQuality", scoreRot / 100.f},
-            {"role1Frequency", rTotal > 0.f ? ps.roleTime[0] / rTotal : 0.f},
-            {"role2Frequency", rTotal > 0.f ? ps.roleTime[1] / rTotal : 0.f},
-            {"role3Frequency", rTotal > 0.f ? ps.roleTime[2] / rTotal : 0.f},
-            {"cuts", ps.cuts},
-            {"clearances", ps.clearances},
-            {"defensiveChallenges", ps.challengesWon},
-            {"defensiveDemos", ps.defensiveDemos},
-            {"defenseTime", ps.defenseTime},
-            {"clutchSaves", ps.clutchSaves},
-            {"blocks", ps.blocks},
-            {"ballTouches", ps.ballTouches},
-            {"highPressings", ps.highPressings},
-            {"aerialTouches", ps.aerialTouches},
-            {"missedOpenGoals", ps.missedOpenGoals},
-            {"doubleCommits", ps.doubleCommits},
-            {"xg", xgTotal}
-        };
-        players.push_back(p);
-
-        if ((ps.goals > 0 ? ps.goals : pri.GetMatchGoals()) > 0)
-            scorers.push_back(pri.GetPlayerName().ToString());
+        ScoreboardLine line;
+        line.slot = registry.Find(pri.memory_address);
+        line.name = pri.GetPlayerName().ToString();
+        line.team = pri.GetTeamNum2();
+        line.goals = pri.GetMatchGoals();
+        line.assists = pri.GetMatchAssists();
+        line.shots = pri.GetMatchShots();
+        line.saves = pri.GetMatchSaves();
+        line.score = pri.GetMatchScore();
+        summary.players.push_back(line);
+    }
 
-        if (pri.GetMatchScore() > bestScore)
+    if (recorder.IsOpen())
+    {
+        TelemetryScore scoreLanes[MAX_SLOTS] = {};
+        int scoreLaneCount = 0;
+        for (const ScoreboardLine& line : summary.players)
         {
-            bestScore = pri.GetMatchScore();
-            mvp = pri.GetPlayerName().ToString();
+            if (line.slot < 0 || scoreLaneCount >= MAX_SLOTS)
+                continue;
+            TelemetryScore& sl = scoreLanes[scoreLaneCount++];
+            sl.slot = static_cast<uint8_t>(line.slot);
+            sl.team = static_cast<uint8_t>(line.team);
+            sl.goals = static_cast<int16_t>(line.goals);
+            sl.assists = static_cast<int16_t>(line.assists);
+            sl.shots = static_cast<int16_t>(line.shots);
+            sl.saves = static_cast<int16_t>(line.saves);
+            sl.score = line.score;
         }
+
+        TelemetryMatchEnd end{};
+        end.type = TELEMETRY_MATCH_END;
+        end.lanes = static_cast<uint8_t>(scoreLaneCount);
+        end.secondsElapsed = summary.secondsElapsed;
+        end.totalGameTime = summary.totalGameTime;
+        end.scoreBlue = scoreBlue;
+        end.scoreOrange = scoreOrange;
+        TelemetryCopyString(end.map, sizeof(end.map), mapName);
+        TelemetryCopyString(end.teamBlue, sizeof(end.teamBlue), blueName);
+        TelemetryCopyString(end.teamOrange, sizeof(end.teamOrange), orangeName);
+        recorder.WriteMatchEnd(end, scoreLanes);
+        StopRecording();
     }
 
-    float matchTime = sw.GetSecondsElapsed();
-    int overtime = std::max(0, static_cast<int>(std::round(matchTime - 300.f)));
-
-    json payload = {
-        {"scoreBlue", scoreBlue},
-        {"scoreOrange", scoreOrange},
-        {"teamBlue", blueName},
-        {"teamOrange", orangeName},
-        {"map", mapName},
-        {"scorers", scorers},
-        {"mvp", mvp},
-        {"players", players},
-        {"overtime", overtime}
-    };
+    // Le resultat se lit une fois toutes les commandes du match traitees
+    worker.Drain();
+    const MatchAnalytics& analytics = worker.Analytics();
+    session.AddMatch(analytics, summary);
+    PayloadExtras extras;
+    // Heure de fin : un resultat renvoye plus tard depuis le journal garde sa
+    // date ; l'identifiant permet au bot d'ignorer un renvoi
+    extras.playedAt = static_cast<int64_t>(std::time(nullptr));
+    extras.uploadId = uploadIds() | 1;
+    extras.session = &session;
+    // Latences depuis l'envoi precedent, sur option
+    PerfReport perfReport;
+    if (perfUpload)
+    {
+        perf.TakeReport(perfReport);
+        extras.perf = &perfReport;
+    }
+    payloadWriter.Reset(uploadFormat);
+    analytics.WritePayload(summary, extras, payloadWriter);
+    if (!payloadWriter.Valid())
+    {
+        Log("[Stats] Resultat mal forme, statistiques du match non envoyees");
+        return;
+    }
 
     if (debugEnabled)
-        Log("[DEBUG] Envoi des stats : " + std::to_string(players.size()) + " joueurs");
-
-    gameWrapper->SetTimeout([this, payload = std::move(payload)](GameWrapper* /*gw*/) mutable
+        Log("[DEBUG] Envoi des stats : " + std::to_string(summary.players.size()) + " joueurs, "
+            + std::to_string(payloadWriter.Data().size()) + " octets", LogLevel::Debug);
+
+    // Journalisation, signature et envoi se font sur le thread d'envoi
+    UploadWorker::Job job;
+    job.url = botEndpoint;
+    job.body = payloadWriter.Data();
+    job.durable = true;
+    if (!uploader.Enqueue(std::move(job)))
     {
-        std::thread([this, p = std::move(payload)]() mutable
-        {
-            try
-            {
-                std::string body = p.dump();
-                struct curl_slist* headers_list = nullptr;
-                headers_list = curl_slist_append(headers_list, "Content-Type: application/json");
-                if (!apiSecret.empty())
-                {
-                    std::string signature = hmac_sha256(apiSecret, body);
-                    std::string sig_header = "x-signature: " + signature;
-                    headers_list = curl_slist_append(headers_list, sig_header.c_str());
-                }
+        Log("[Stats] File d'envoi pleine ou arretee, statistiques du match perdues");
+    }
 
-                CURL* curl = curl_easy_init();
-                if (curl)
-                {
-                    curl_easy_setopt(curl, CURLOPT_URL, botEndpoint.c_str());
-                    if (botEndpoint.rfind("http://", 0) == 0) {
-                    curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_NONE);
-                    Log("Mode HTTP détecté : SSL/TLS désactivé pour cette requête");
-                    }
-
-                    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-                    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
-                    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-                    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
-                    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-                    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-
-                    std::string response;
-                    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
-                                     +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
-                                         auto* resp = static_cast<std::string*>(userdata);
-                                         resp->append(ptr, size * nmemb);
-                                         return size * nmemb;
-                                     });
-                    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-                    CURLcode res = curl_easy_perform(curl);
-                    if (res != CURLE_OK)
-                    {
-                        Log(std::string("[Stats] Erreur reseau : ") + curl_easy_strerror(res));
-                    }
-                    else
-                    {
-                        long status_code = 0;
-                        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
-                        if (status_code >= 200 && status_code < 300)
-                            Log("[Stats] Envoi reussi");
-                        else
-                            Log("[Stats] Erreur HTTP " + std::to_string(status_code) + ": " + response);
-                    }
-
-                    curl_easy_cleanup(curl);
-                }
-                curl_slist_free_all(headers_list);
-            }
-            catch (const std::exception& e)
-            {
-                Log(std::string("[Stats] Exception lors de l'envoi : ") + e.what());
-            }
-            catch (...)
-            {
-                Log("[Stats] Exception inconnue lors de l'envoi");
-            }
-        }).detach();
-    }, 1.5f);
         Log("[OnGameEnd] Traitement termine");
     }
     catch (const std::exception& e)
@@ -960,7 +1118,8 @@ void AuusaConnectPlugin::OnGameEnd()
 
 void AuusaConnectPlugin::OnHitBall(CarWrapper car, void* /*params*/, std::string /*eventName*/)
 {
-    if (!car)
+    PerfScope scope(&perf.Hook(PERF_HIT_BALL));
+    if (!car || phase != GamePhase::Live)
         return;
 
     PriWrapper pri = car.GetPRI();
@@ -975,205 +1134,18 @@ void AuusaConnectPlugin::OnHitBall(CarWrapper car, void* /*params*/, std::string
     if (!ball)
         return;
 
-    ArrayWrapper<PriWrapper> pris = sw.GetPRIs();
-    float now = sw.GetSecondsElapsed();
-
-    std::string name = pri.GetPlayerName().ToString();
-    PlayerStats &ps = stats[name];
-
-    Vector pos = car.GetLocation();
-    Vector ballPos = ball.GetLocation();
-    Vector ballVel = ball.GetVelocity();
-    BoostWrapper boostComp = car.GetBoostComponent();
-    float playerBoost = boostComp ? boostComp.GetCurrentBoostAmount() : 0.f;
-    bool isAerial = !car.AnyWheelTouchingGround();
-    int team = pri.GetTeamNum2();
-
-    bool wasDef = (team == 0) ? lastBallLocation.Y < -2000.f : lastBallLocation.Y > 2000.f;
-    bool nowOff = (team == 0) ? ballPos.Y > 0.f : ballPos.Y < 0.f;
-    if (wasDef && nowOff)
-    {
-        ps.clearances++;
-        if (debugEnabled)
-            Log("[DEBUG] Degagement par " + name);
-    }
-
-    bool oppNearby = false;
-    for (int i = 0; i < pris.Count(); ++i)
-    {
-        PriWrapper opp = pris.Get(i);
-        if (!opp || opp.GetTeamNum2() == team)
-            continue;
-        CarWrapper oc = opp.GetCar();
-        if (!oc)
-            continue;
-        if ((oc.GetLocation() - ballPos).magnitude() < 800.f)
-        {
-            oppNearby = true;
-            break;
-        }
-    }
-    float oppTouch = fabs(now - lastTeamTouchTime[team == 0 ? 1 : 0]);
-    if (oppNearby && oppTouch < 0.2f)
-    {
-        if (now - ps.lastDuelTime >= 1.0f)
-        {
-            ps.challengesWon++;
-            ps.lastDuelTime = now;
-            if (debugEnabled)
-            {
-                Log("[DEBUG] Duel gagne par " + name);
-                Log("[DEBUG] Duel compté");
-            }
-        }
-    }
-
-    // block si la balle allait vers le but et repart a l'oppose
-    if ((team == 0 && lastBallVel.Y < 0 && ballVel.Y >= 0 && pos.Y < 0) ||
-        (team == 1 && lastBallVel.Y > 0 && ballVel.Y <= 0 && pos.Y > 0))
-    {
-        ps.blocks++;
-        if (debugEnabled)
-            Log("[DEBUG] Block par " + name);
-    }
-
-    float gameTime = now;
-
-    // Passe utile
-    if (!lastTouchPlayer.empty() && lastTouchPlayer != name)
-    {
-        PriWrapper prevPri = GetPriByName(sw, lastTouchPlayer);
-        if (prevPri && prevPri.GetTeamNum2() == pri.GetTeamNum2() && gameTime - lastTouchTime < 2.f)
-            stats[lastTouchPlayer].usefulPasses++;
-    }
-
-    lastTouchPlayer = name;
-    lastTouchTime = gameTime;
-    lastTouchAerial = isAerial;
-    lastTeamTouchPlayer[team] = name;
-    lastTeamTouchTime[team] = gameTime;
-
-    ps.ballTouches++;
-    ps.inAttack = true;
-    ps.timeSinceAttack = 0.f;
-
-    if (WasLastShotOnGoal(ball))
-        ps.shotsOnTarget++;
-
-    Vector prevBall = lastBallLocation;
-    Vector newBall = ball.GetLocation();
-    if ((team == 0 && prevBall.X < 0 && newBall.X > 0) ||
-        (team == 1 && prevBall.X > 0 && newBall.X < 0))
-        ps.cleanClears++;
-
-    bool shot = WasLastShotOnGoal(ball);
-    if (!shot)
-    {
-        Vector goal = {0.f, team == 0 ? 5120.f : -5120.f, 0.f};
-        Vector toGoal = goal - ballPos;
-        toGoal.Z = 0.f;
-        Vector dir = ballVel;
-        dir.Z = 0.f;
-        if (((team == 0 && ballVel.Y > 0) || (team == 1 && ballVel.Y < 0)) && dir.magnitude() > 0.1f && toGoal.magnitude() > 0.1f)
-        {
-            dir.normalize();
-            toGoal.normalize();
-            float dotVal = Vector::dot(dir, toGoal);
-            float ang = acosf(std::clamp(dotVal, -1.f, 1.f));
-            if (ang < 0.35f && std::fabs(ballPos.X) < 900.f)
-                shot = true;
-        }
-    }
-
-    if (shot)
-    {
-        std::vector<DefenderInfo> defenders;
-        bool openNet = true;
-        for (int i = 0; i < pris.Count(); ++i)
-        {
-            PriWrapper opp = pris.Get(i);
-            if (!opp || opp.GetTeamNum2() == team)
-                continue;
-            CarWrapper oc = opp.GetCar();
-            if (!oc)
-                continue;
-            Vector opos = oc.GetLocation();
-            float distToShooter = (opos - pos).magnitude();
-            if (distToShooter < 2000.f)
-            {
-                BoostWrapper ob = oc.GetBoostComponent();
-                float oboost = ob ? ob.GetCurrentBoostAmount() : 0.f;
-                defenders.push_back({opos, oboost, false, distToShooter});
-            }
-            if (((team == 0 && opos.Y > ballPos.Y) || (team == 1 && opos.Y < ballPos.Y)) &&
-                std::fabs(opos.X - ballPos.X) < 800.f && (oc.GetBoostComponent() ? oc.GetBoostComponent().GetCurrentBoostAmount() : 0.f) > 5.f)
-            {
-                openNet = false;
-            }
-        }
-        if (openNet)
-        {
-            if (gameTime - ps.lastMissedOpenGoalTime >= 2.0f)
-            {
-                ps.missedOpenGoals++;
-                ps.lastMissedOpenGoalTime = gameTime;
-                if (debugEnabled)
-                    Log("[DEBUG] Open goal raté compté");
-            }
-        }
-
-        std::string context = DetectShotContext(car, ball, team, openNet, gameTime, isAerial);
-        bool quality = context.find("double_tap") != std::string::npos || context.find("perfect_center") != std::string::npos;
-        bool hardRebound = ballVel.magnitude() > 2000.f && std::fabs(ballVel.Z) > 500.f;
-        bool panicShot = playerBoost < 5.f && ballVel.magnitude() > 2500.f;
-        Vector goal = {0.f, team == 0 ? 5120.f : -5120.f, 0.f};
-        float distance = (pos - goal).magnitude();
-        Vector toGoal = goal - ballPos;
-        float angle = 0.f;
-        if (ballVel.magnitude() > 0.1f && toGoal.magnitude() > 0.1f) {
-            Vector velNorm = ballVel;
-            velNorm.normalize();
-            toGoal.normalize();
-            float dotVal = Vector::dot(velNorm, toGoal);
-            angle = acosf(std::clamp(dotVal, -1.f, 1.f));
-        }
-
-        float xg = ComputeXGAdvanced(distance, angle, ballVel.magnitude(), playerBoost, isAerial, defenders, hardRebound, panicShot, openNet, quality);
-        ps.xgAttempts.push_back(xg);
-        ps.xgContext.push_back(context);
-        if (WasLastShotOnGoal(ball))
-            ps.shotsOnTarget++;
-    }
-
-    Vector loc = car.GetLocation();
-    for (int i = 0; i < pris.Count(); ++i)
-    {
-        PriWrapper other = pris.Get(i);
-        if (!other || other.GetTeamNum2() != team || other.GetPlayerName().ToString() == name)
-            continue;
-        CarWrapper otherCar = other.GetCar();
-        if (!otherCar)
-            continue;
-        float dist = (otherCar.GetLocation() - loc).magnitude();
-        if (dist < 800.f && fabs(lastTeamTouchTime[team] - gameTime) < 0.5f)
-        {
-            stats[name].doubleCommits++;
-            stats[other.GetPlayerName().ToString()].doubleCommits++;
-            break;
-        }
-    }
-
-    Vector ballLoc = ball.GetLocation();
-    lastBallLocation = ballLoc;
-
-    if (!car.AnyWheelTouchingGround())
-        ps.aerialTouches++;
-
+    const FrameSnapshot& f = CaptureFrame(sw);
+    int self = f.Find(pri.memory_address);
+    if (self < 0 || !f.hasCar[self])
+        return;
+    RecordEvent(TELEMETRY_TOUCH, f.slot[self]);
+    worker.OnTouch(f, self);
 }
 
 void AuusaConnectPlugin::OnCarDemolish(CarWrapper car, void* /*params*/, std::string /*eventName*/)
 {
-    if (!car)
+    PerfScope scope(&perf.Hook(PERF_DEMOLISH));
+    if (!car || phase != GamePhase::Live)
         return;
 
     PriWrapper pri = car.GetPRI();
@@ -1181,39 +1153,26 @@ void AuusaConnectPlugin::OnCarDemolish(CarWrapper car, void* /*params*/, std::st
         return;
 
     PriWrapper attacker = car.GetAttackerPRI();
-    if (attacker)
-    {
-        CarWrapper ac = attacker.GetCar();
-        if (ac)
-        {
-            Vector aloc = ac.GetLocation();
-            int aTeam = attacker.GetTeamNum2();
+    if (!attacker)
+        return;
 
-            // Demo effectuee dans sa propre moitie -> demolition defensive
-            if ((aTeam == 0 && aloc.Y < 0) || (aTeam == 1 && aloc.Y > 0))
-            {
-                stats[attacker.GetPlayerName().ToString()].defensiveDemos++;
-                if (debugEnabled)
-                {
-                    float time = gameWrapper->GetCurrentGameState().GetSecondsElapsed();
-                    Log("[DEBUG] Demo defensive par " + attacker.GetPlayerName().ToString() + " t:" + std::to_string(time));
-                }
-            }
+    ServerWrapper sw = gameWrapper->GetCurrentGameState();
+    if (!sw)
+        return;
 
-            // Demo effectuee dans la moitie adverse -> demolition offensive
-            if ((aTeam == 0 && aloc.Y > 0) || (aTeam == 1 && aloc.Y < 0))
-            {
-                stats[attacker.GetPlayerName().ToString()].offensiveDemos++;
-                if (debugEnabled)
-                    Log("[DEBUG] Demo offensive par " + attacker.GetPlayerName().ToString());
-            }
-        }
-    }
+    const FrameSnapshot& f = CaptureFrame(sw);
+    int a = f.Find(attacker.memory_address);
+    if (a < 0 || !f.hasCar[a])
+        return;
+    int victim = registry.Find(pri.memory_address);
+    RecordEvent(TELEMETRY_DEMOLISH, f.slot[a], victim);
+    worker.OnDemolish(f, a, victim);
 }
 
 void AuusaConnectPlugin::OnBoostCollected(CarWrapper car, void* /*params*/, std::string)
 {
-    if (!car)
+    PerfScope scope(&perf.Hook(PERF_BOOST));
+    if (!car || phase != GamePhase::Live)
         return;
 
     BoostWrapper boost = car.GetBoostComponent();
@@ -1224,29 +1183,21 @@ void AuusaConnectPlugin::OnBoostCollected(CarWrapper car, void* /*params*/, std:
     if (!pri)
         return;
 
-    std::string name = pri.GetPlayerName().ToString();
-    PlayerStats &ps = stats[name];
+    int slot = registry.Find(pri.memory_address);
+    if (slot < 0)
+        slot = RegisterPlayer(pri);
+    if (slot < 0)
+        return;
 
     float current = boost.GetCurrentBoostAmount();
-    float gained = ps.lastBoost >= 0.f ? current - ps.lastBoost : 0.f;
-
-    ps.boostPickups++;
-    if (ps.lastBoost >= 0.f && gained > 0.f)
-    {
-        if (ps.lastBoost >= boost.GetMaxBoostAmount() * 0.8f)
-            ps.wastedBoosts++;
-        if (gained > 90.f)
-            ps.bigPads++;
-        else
-            ps.smallPads++;
-    }
-    ps.lastBoost = current;
+    RecordEvent(TELEMETRY_BOOST, slot, -1, current, boost.GetMaxBoostAmount());
+    worker.OnBoost(slot, current, boost.GetMaxBoostAmount());
 
     if (debugEnabled)
     {
         Vector loc = car.GetLocation();
         float time = gameWrapper->GetCurrentGameState().GetSecondsElapsed();
-        Log("[DEBUG] Boost pickup " + name + " pos:" + std::to_string(loc.X) + "," + std::to_string(loc.Y) + " t:" + std::to_string(time));
+        Log("[DEBUG] Boost pickup " + registry.entries[slot].name + " pos:" + std::to_string(loc.X) + "," + std::to_string(loc.Y) + " t:" + std::to_string(time), LogLevel::Debug);
     }
 }
 
@@ -1254,53 +1205,50 @@ BAKKESMOD_PLUGIN(AuusaConnectPlugin, "AuusaConnect", "0.1", 0)
 
 void AuusaConnectPlugin::OnGoalScored(std::string)
 {
+    PerfScope scope(&perf.Hook(PERF_GOAL));
+    // Comme les autres hooks : pas de but compte hors du jeu (ralenti,
+    // podium, entrainement ou partie libre sans match)
+    if (phase != GamePhase::Live)
+        return;
+
     ServerWrapper sw = gameWrapper->GetCurrentGameState();
     if (!sw)
         return;
 
     TeamWrapper blueTeam = sw.GetTeams().Get(0);
     TeamWrapper orangeTeam = sw.GetTeams().Get(1);
-    int totalScore = 0;
-    if (blueTeam)
-        totalScore += blueTeam.GetScore();
-    if (orangeTeam)
-        totalScore += orangeTeam.GetScore();
-    if (totalScore == lastTotalScore)
+    int scoreBlue = blueTeam ? blueTeam.GetScore() : 0;
+    int scoreOrange = orangeTeam ? orangeTeam.GetScore() : 0;
+    // Le hook peut etre recu plusieurs fois pour un meme but : le doublon
+    // n'est ni enregistre ni compte
+    if (scoreBlue + scoreOrange == lastGoalTotal)
         return;
-    lastTotalScore = totalScore;
+    lastGoalTotal = scoreBlue + scoreOrange;
 
-    // Certaines versions du SDK ne fournissent pas la méthode GetLastGoalScorer.
-    // On détermine donc le buteur à partir du dernier joueur ayant touché la balle.
-    if (lastTouchPlayer.empty())
-        return;
+    const FrameSnapshot& f = CaptureFrame(sw);
+    RecordEvent(TELEMETRY_GOAL, -1, -1, static_cast<float>(scoreBlue), static_cast<float>(scoreOrange));
+    worker.OnGoal(f, scoreBlue, scoreOrange);
+    SetPhase(GamePhase::GoalReplay);
+}
 
-    PriWrapper scorer = GetPriByName(sw, lastTouchPlayer);
-    if (!scorer)
+void AuusaConnectPlugin::Log(const std::string& msg, LogLevel level)
+{
+    if (!logger.Enabled(level))
         return;
-
-    std::string name = lastTouchPlayer;
-    stats[name].goals++;
-
-    if (debugEnabled)
-    {
-        float time = sw.GetSecondsElapsed();
-        Log("[DEBUG] But marque par " + name + " t:" + std::to_string(time));
-    }
-
-    int team = scorer.GetTeamNum2();
-    std::string assister = lastTeamTouchPlayer[team];
-    if (!assister.empty() && assister != name)
-        stats[assister].assists++;
+    if (std::this_thread::get_id() == gameThread)
+        cvarManager->log(msg);
+    else
+        RunOnGameThread([this, msg] { cvarManager->log(msg); });
+    logger.Write(level, msg);
 }
 
-void AuusaConnectPlugin::Log(const std::string& msg)
+void AuusaConnectPlugin::RunOnGameThread(std::function<void()> fn)
 {
-    cvarManager->log(msg);
-    if (logFile.is_open())
-    {
-        logFile << msg << std::endl;
-        logFile.flush();
-    }
+    std::weak_ptr<bool> token = alive;
+    gameWrapper->Execute([token, fn = std::move(fn)](GameWrapper*) {
+        if (!token.expired())
+            fn();
+    });
 }
 
 
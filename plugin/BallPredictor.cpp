@@ -0,0 +1,111 @@
+#include "BallPredictor.h"
+
+static constexpr float STEP = 1.f / 60.f;
+static constexpr float GRAVITY = -650.f;
+static constexpr float DRAG = 0.0305f; // par seconde
+static constexpr float MAX_SPEED = 6000.f;
+static constexpr float BALL_RADIUS = 92.75f;
+static constexpr float RESTITUTION = 0.6f;
+static constexpr float FRICTION = 0.35f;
+// Part maximale de la vitesse tangentielle perdue a un rebond ; le reste
+// devient de l'effet dans le jeu, non modelise ici
+static constexpr float MAX_TANGENT_LOSS = 0.4f;
+// En dessous, la balle roule ou repose sur la surface : pas de rebond
+static constexpr float ROLL_SPEED = 50.f;
+
+static constexpr float ARENA_HALF_WIDTH = 4096.f;
+static constexpr float ARENA_HALF_LENGTH = 5120.f;
+static constexpr float ARENA_HEIGHT = 2044.f;
+static constexpr float CORNER = 8064.f; // pans coupes : |X| + |Y| = CORNER
+static constexpr float GOAL_HALF_WIDTH = 893.f;
+static constexpr float GOAL_HEIGHT = 642.775f;
+
+static constexpr float INV_SQRT2 = 0.70710678f;
+
+// Rebond sur le plan n.p = d (balle du cote n.p >= d) s'il est penetre ;
+// renvoie true s'il y a eu rebond.
+static bool Collide(Vec3& p, Vec3& v, const Vec3& n, float d)
+{
+    float dist = Vec3::dot(n, p) - d;
+    if (dist >= BALL_RADIUS)
+        return false;
+    float push = BALL_RADIUS - dist;
+    p.X += n.X * push;
+    p.Y += n.Y * push;
+    p.Z += n.Z * push;
+
+    float vn = Vec3::dot(n, v);
+    if (vn >= 0.f)
+        return false;
+    Vec3 vt = {v.X - n.X * vn, v.Y - n.Y * vn, v.Z - n.Z * vn};
+    if (-vn < ROLL_SPEED)
+    {
+        v = vt;
+        return false;
+    }
+    float tangent = vt.magnitude();
+    float slip = tangent > 0.f ? std::min(1.f, FRICTION * (1.f + RESTITUTION) * -vn / tangent) : 0.f;
+    float keep = 1.f - MAX_TANGENT_LOSS * slip;
+    float bounce = -vn * RESTITUTION;
+    v = {vt.X * keep + n.X * bounce, vt.Y * keep + n.Y * bounce, vt.Z * keep + n.Z * bounce};
+    return true;
+}
+
+BallPrediction PredictBall(const Vec3& pos, const Vec3& vel, float horizon)
+{
+    BallPrediction out;
+    Vec3 p = pos;
+    Vec3 v = vel;
+    int steps = static_cast<int>(horizon / STEP);
+    for (int i = 1; i <= steps; ++i)
+    {
+        v.Z += GRAVITY * STEP;
+        float drag = 1.f - DRAG * STEP;
+        v = {v.X * drag, v.Y * drag, v.Z * drag};
+        float speed2 = Vec3::dot(v, v);
+        if (speed2 > MAX_SPEED * MAX_SPEED)
+        {
+            float scale = MAX_SPEED / std::sqrt(speed2);
+            v = {v.X * scale, v.Y * scale, v.Z * scale};
+        }
+        p = {p.X + v.X * STEP, p.Y + v.Y * STEP, p.Z + v.Z * STEP};
+
+        // Seuls les plans proches de la balle sont testes : en plein vol,
+        // un pas se limite a ces comparaisons
+        if (p.Z < BALL_RADIUS)
+            out.bounces += Collide(p, v, {0.f, 0.f, 1.f}, 0.f);
+        else if (p.Z > ARENA_HEIGHT - BALL_RADIUS)
+            out.bounces += Collide(p, v, {0.f, 0.f, -1.f}, -ARENA_HEIGHT);
+
+        if (std::fabs(p.X) > ARENA_HALF_WIDTH - BALL_RADIUS)
+            out.bounces += Collide(p, v, {p.X > 0.f ? -1.f : 1.f, 0.f, 0.f}, -ARENA_HALF_WIDTH);
+
+        if (std::fabs(p.X) + std::fabs(p.Y) > CORNER - BALL_RADIUS / INV_SQRT2)
+        {
+            Vec3 n = {p.X > 0.f ? -INV_SQRT2 : INV_SQRT2, p.Y > 0.f ? -INV_SQRT2 : INV_SQRT2, 0.f};
+            out.bounces += Collide(p, v, n, -CORNER * INV_SQRT2);
+        }
+
+        if (std::fabs(p.Y) > ARENA_HALF_LENGTH - BALL_RADIUS)
+        {
+            // Mur du fond, sauf dans l'ouverture du but
+            if (std::fabs(p.X) < GOAL_HALF_WIDTH && p.Z < GOAL_HEIGHT)
+            {
+                if (std::fabs(p.Y) >= ARENA_HALF_LENGTH)
+                {
+                    out.goalSide = p.Y > 0.f ? 1 : -1;
+                    out.time = i * STEP;
+                    out.entry = p;
+                    return out;
+                }
+            }
+            else
+                out.bounces += Collide(p, v, {0.f, p.Y > 0.f ? -1.f : 1.f, 0.f}, -ARENA_HALF_LENGTH);
+        }
+
+        // Balle immobile au sol : plus rien a predire
+        if (p.Z <= BALL_RADIUS + 1.f && Vec3::dot(v, v) < 1.f)
+            break;
+    }
+    return out;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "MatchAnalytics.h"
+
+// Prediction balistique de la balle sur le terrain de Soccar, pour savoir si
+// une touche envoie la balle dans un but.
+//
+// Pas fixes de 1/60 s : gravite constante, frottement de l'air, vitesse
+// bornee, rebonds sur le sol, le plafond, les murs lateraux et de fond et
+// les quatre pans coupes des coins. Un rebond renvoie la composante normale
+// avec un coefficient de restitution et freine la composante tangentielle
+// (frottement de Coulomb, borne) ; l'effet de la balle et les rampes
+// arrondies sont ignores. Aucune allocation : quelques microsecondes par prediction.
+struct BallPrediction
+{
+    int goalSide = 0;   // +1 : but en Y > 0 (attaque bleue), -1 : but en Y < 0, 0 : pas de but
+    float time = 0.f;   // delai avant que la balle franchisse la ligne (s), 0 sans but
+    Vec3 entry;         // position du centre de la balle sur la ligne
+    int bounces = 0;    // rebonds avant l'entree ou la fin de l'horizon
+};
+
+static constexpr float BALL_PREDICT_HORIZON = 4.f;
+
+BallPrediction PredictBall(const Vec3& pos, const Vec3& vel, float horizon = BALL_PREDICT_HORIZON);
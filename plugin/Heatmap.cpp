@@ -0,0 +1,35 @@
+#include "Heatmap.h"
+
+static uint8_t* PutVarint(uint8_t* out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+size_t Heatmap::Encode(uint8_t* out) const
+{
+    uint8_t* p = out;
+    int i = 0;
+    while (i < CELLS)
+    {
+        if (cells[i] != 0)
+        {
+            p = PutVarint(p, cells[i++]);
+            continue;
+        }
+        int run = 0;
+        while (i < CELLS && cells[i] == 0)
+        {
+            ++run;
+            ++i;
+        }
+        *p++ = 0;
+        p = PutVarint(p, static_cast<uint32_t>(run));
+    }
+    return static_cast<size_t>(p - out);
+}
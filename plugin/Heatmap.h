@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Carte de presence sur le terrain de Soccar, en temps passe par case.
+//
+// La grille couvre X de -4096 a 4096 (COLS colonnes) et Y de -5120 a 5120
+// (ROWS lignes, ligne 0 cote bleu), en cases de CELL_SIZE unites. Une
+// position hors grille (cage, mur) compte dans la case de bord la plus
+// proche. Chaque case cumule des centiemes de seconde et sature a 65535
+// (environ 11 minutes).
+//
+// Add() est en O(1), sans allocation : la grille est un tableau fixe.
+struct Heatmap
+{
+    static constexpr int COLS = 32;
+    static constexpr int ROWS = 40;
+    static constexpr int CELLS = COLS * ROWS;
+    static constexpr float CELL_SIZE = 256.f;
+    static constexpr float HALF_WIDTH = COLS * CELL_SIZE / 2.f;
+    static constexpr float HALF_LENGTH = ROWS * CELL_SIZE / 2.f;
+    // Taille maximale de Encode() : 3 octets par case au pire
+    static constexpr size_t MAX_ENCODED = CELLS * 3;
+
+    uint16_t cells[CELLS] = {};
+
+    void Clear() { std::fill(std::begin(cells), std::end(cells), uint16_t{0}); }
+
+    static int CellOf(float x, float y)
+    {
+        int col = std::clamp(static_cast<int>((x + HALF_WIDTH) * (1.f / CELL_SIZE)), 0, COLS - 1);
+        int row = std::clamp(static_cast<int>((y + HALF_LENGTH) * (1.f / CELL_SIZE)), 0, ROWS - 1);
+        return row * COLS + col;
+    }
+
+    // `weight` en centiemes de seconde.
+    void Add(float x, float y, uint32_t weight)
+    {
+        uint16_t& cell = cells[CellOf(x, y)];
+        cell = static_cast<uint16_t>(std::min<uint32_t>(cell + weight, 0xFFFF));
+    }
+
+    // Encodage compact, ligne par ligne : chaque case non nulle est un
+    // entier variable (LEB128) ; une suite de cases nulles s'ecrit 0 suivi
+    // de sa longueur (LEB128). `out` doit pouvoir recevoir MAX_ENCODED
+    // octets ; renvoie le nombre d'octets ecrits.
+    size_t Encode(uint8_t* out) const;
+};
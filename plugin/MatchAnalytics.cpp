@@ -0,0 +1,959 @@
+#include "MatchAnalytics.h"
+#include "BallPredictor.h"
+#include "PerfStats.h"
+#include "SessionStats.h"
+#include <charconv>
+#include <limits>
+#include <utility>
+
+const char* GamePhaseName(GamePhase phase)
+{
+    switch (phase)
+    {
+    case GamePhase::Idle: return "idle";
+    case GamePhase::Countdown: return "countdown";
+    case GamePhase::Live: return "live";
+    case GamePhase::GoalReplay: return "goal_replay";
+    case GamePhase::Paused: return "paused";
+    case GamePhase::Podium: return "podium";
+    }
+    return "?";
+}
+
+float MatchAnalytics::ComputeXGAdvanced(float distance, float angle, float ballSpeed, float playerBoost, bool isAerial, const std::vector<DefenderInfo>& defenders, bool hardRebound, bool panicShot, bool openNet, bool qualityAction)
+{
+    float xg = 0.05f;
+    xg += std::exp(-distance / 2500.f) * 0.25f;
+    xg += std::clamp(1.f - angle / 1.57f, 0.f, 1.f) * 0.2f;
+    xg += std::clamp(ballSpeed / 4000.f, 0.f, 1.f) * 0.05f;
+    if (playerBoost > 20.f)
+        xg += 0.02f;
+
+    float openBonus = 0.f;
+    if (openNet)
+    {
+        openBonus = 0.25f;
+        for (const auto& d : defenders)
+        {
+            if (d.distance < 1000.f)
+                openBonus -= 0.1f;
+            else if (d.distance < 1500.f)
+                openBonus -= 0.05f;
+        }
+        if (openBonus > 0.f)
+            xg += openBonus;
+    }
+
+    int defCount = 0;
+    for (const auto& d : defenders)
+    {
+        if (d.distance < 1500.f && d.boost > 30.f && defCount < 3)
+        {
+            xg -= 0.04f;
+            ++defCount;
+        }
+    }
+
+    if (hardRebound)
+        xg -= 0.05f;
+    if (panicShot)
+        xg -= 0.05f;
+    if (qualityAction)
+        xg += 0.05f;
+
+    return std::clamp(xg, 0.f, 0.95f);
+}
+
+const char* ShotContextName(int bit)
+{
+    static const char* const NAMES[SHOT_CONTEXT_COUNT] = {
+        "double_tap", "panic_shot", "backboard", "perfect_center", "open_net", "aerial"};
+    return bit >= 0 && bit < SHOT_CONTEXT_COUNT ? NAMES[bit] : "?";
+}
+
+uint8_t MatchAnalytics::DetectShotContext(const FrameSnapshot& f, int shooter, bool openNet, float gameTime, bool isAerial) const
+{
+    uint8_t ctx = 0;
+    float b = std::max(f.boost[shooter], 0.f);
+    const Vec3& vel = f.ballVel;
+    int team = f.team[shooter];
+    int slot = f.slot[shooter];
+
+    if (lastTouchSlot == slot && gameTime - lastTouchTime < 1.f && lastTouchAerial && isAerial)
+        ctx |= SHOT_DOUBLE_TAP;
+
+    if (b < 5.f && vel.magnitude() > 2500.f)
+        ctx |= SHOT_PANIC;
+
+    float targetY = team == 0 ? 5120.f : -5120.f;
+    if (std::fabs(lastBallLocation.Y - targetY) < 300.f && std::fabs(lastBallLocation.Z) > 800.f)
+        ctx |= SHOT_BACKBOARD;
+
+    if (lastTouchSlot >= 0 && lastTouchSlot != slot)
+    {
+        int prev = f.FindSlot(lastTouchSlot);
+        if (prev >= 0 && f.team[prev] == team && gameTime - lastTouchTime < 1.5f && std::fabs(f.ballPos.X) < 700.f)
+            ctx |= SHOT_PERFECT_CENTER;
+    }
+
+    if (openNet)
+        ctx |= SHOT_OPEN_NET;
+
+    if (isAerial)
+        ctx |= SHOT_AERIAL;
+
+    return ctx;
+}
+
+void MatchAnalytics::Reset()
+{
+    lastTotalScore = 0;
+    registry.Reset();
+    stats.clear();
+    stats.reserve(MAX_SLOTS);
+    lastUpdate = 0.f;
+    lastTouchSlot = -1;
+    lastTouchTime = 0.f;
+    lastTouchAerial = false;
+    lastTeamTouchTime[0] = lastTeamTouchTime[1] = 0.f;
+    touches.clear();
+    touches.reserve(MAX_TOUCHES);
+    droppedTouches = 0;
+    lastBallLocation = Vec3{};
+    lastBallVel = Vec3{};
+    ballHeatmap.Clear();
+}
+
+void MatchAnalytics::OnMatchStart(const FrameSnapshot& f)
+{
+    lastBallLocation = f.ballPos;
+    int perTeam[2] = {0, 0};
+    for (int i = 0; i < f.count; ++i)
+    {
+        if (f.hasCar[i] && f.boost[i] >= 0.f)
+            stats[f.slot[i]].lastBoost = f.boost[i];
+        if (f.team[i] == 0 || f.team[i] == 1)
+            perTeam[f.team[i]]++;
+    }
+    SetTeamSize(std::max(perTeam[0], perTeam[1]));
+}
+
+void MatchAnalytics::SetTeamSize(int size)
+{
+    teamSize = std::clamp(size, 1, MAX_TEAM_SIZE);
+    switch (teamSize)
+    {
+    case 1: updateRoles = &MatchAnalytics::UpdateRoles<1>; break;
+    case 2: updateRoles = &MatchAnalytics::UpdateRoles<2>; break;
+    case 3: updateRoles = &MatchAnalytics::UpdateRoles<3>; break;
+    default: updateRoles = &MatchAnalytics::UpdateRoles<4>; break;
+    }
+}
+
+void MatchAnalytics::AssignPlayer(int slot, const std::string& uid, const std::string& name, int team)
+{
+    // Adresse fictive mais unique : les PRI ne sont connues que du thread du jeu
+    registry.Assign(slot, static_cast<uintptr_t>(slot) + 1, uid, name, team);
+    if (slot >= static_cast<int>(stats.size()))
+        stats.resize(slot + 1);
+}
+
+void MatchAnalytics::SetPhase(GamePhase next)
+{
+    if (next == phase)
+        return;
+    // Le temps passe hors jeu ne doit pas etre integre au premier
+    // echantillon qui suit la reprise.
+    if (next == GamePhase::Live)
+        lastUpdate = 0.f;
+    phase = next;
+}
+
+void MatchAnalytics::Sample(const FrameSnapshot& f)
+{
+    float now = f.time;
+    float dt = lastUpdate > 0.f ? now - lastUpdate : 0.f;
+    lastUpdate = now;
+
+    // Cartes de presence ponderees par le temps ecoule (centiemes de seconde)
+    uint32_t weight = dt > 0.f ? static_cast<uint32_t>(dt * 100.f + 0.5f) : 0;
+
+    if (f.hasBall)
+    {
+        lastBallVel = f.ballVel;
+        ballHeatmap.Add(f.ballPos.X, f.ballPos.Y, weight);
+    }
+
+    const Vec3& ballLoc = f.ballPos;
+    int poss = f.FindSlot(lastTouchSlot);
+    TeamOrder teams[2];
+    for (int i = 0; i < f.count; ++i)
+    {
+        if (!f.hasCar[i])
+            continue;
+
+        int slot = f.slot[i];
+        PlayerStats &ps = stats[slot];
+        if (f.boost[i] >= 0.f)
+        {
+            // Mise a jour simple de la valeur actuelle pour permettre un suivi correct
+            // dans l'evenement OnBoostCollected sans compter deux fois les pickups.
+            ps.lastBoost = f.boost[i];
+        }
+
+        const Vec3& pos = f.pos[i];
+        ps.heatmap.Add(pos.X, pos.Y, weight);
+        int team = f.team[i];
+        bool playerInOppHalf = (team == 0 && pos.Y > 0) || (team == 1 && pos.Y < 0);
+        bool ballInOppHalf = (team == 0 && ballLoc.Y > 0) || (team == 1 && ballLoc.Y < 0);
+        bool recentlyTouched = (lastTouchSlot == slot && now - lastTouchTime < 0.5f);
+        bool cooldown = (now - ps.lastHighPressTime < 2.f);
+        bool oppClose = false;
+
+        if (playerInOppHalf && ballInOppHalf && !recentlyTouched && !cooldown)
+        {
+            if (poss >= 0 && f.team[poss] != team && f.hasCar[poss])
+            {
+                const Vec3& oppPos = f.pos[poss];
+                float oppDist = (oppPos - pos).magnitude();
+                bool between = (team == 0) ? (oppPos.Y < pos.Y) : (oppPos.Y > pos.Y);
+                if (oppDist < 2000.f && between)
+                    oppClose = true;
+            }
+        }
+
+        if (oppClose)
+        {
+            ps.highPressings++;
+            ps.lastHighPressTime = now;
+            if (debugEnabled) Log("[DEBUG] High pressing compté pour " + PlayerName(slot));
+        }
+        bool inDef = (team == 0) ? pos.Y < 0 : pos.Y > 0;
+        if (inDef)
+            ps.defenseTime += dt;
+
+        int saves = f.saves[i];
+        if (saves > ps.prevSaves)
+        {
+            ps.prevSaves = saves;
+            bool lastDef = true;
+            for (int j = 0; j < f.count; ++j)
+            {
+                if (j == i || f.team[j] != team || !f.hasCar[j])
+                    continue;
+                const Vec3& mpos = f.pos[j];
+                if ((team == 0 && mpos.Y < pos.Y) || (team == 1 && mpos.Y > pos.Y))
+                {
+                    lastDef = false;
+                    break;
+                }
+            }
+            if (lastDef)
+                ps.clutchSaves++;
+        }
+
+        TeamOrder& order = teams[team];
+        if (order.count < MAX_TEAM_SIZE)
+        {
+            order.slot[order.count] = slot;
+            order.dist[order.count] = (pos - ballLoc).magnitude();
+            order.count++;
+        }
+    }
+
+    // Un joueur arrive en cours de match peut agrandir les equipes
+    int largest = std::max(teams[0].count, teams[1].count);
+    if (largest > teamSize)
+    {
+        SetTeamSize(largest);
+        if (debugEnabled)
+            Log("[DEBUG] Equipes de " + std::to_string(teamSize) + " joueurs");
+    }
+    (this->*updateRoles)(teams[0], dt);
+    (this->*updateRoles)(teams[1], dt);
+}
+
+// Reseaux de tri par distance croissante, pour N <= MAX_TEAM_SIZE ; les
+// cases au-dela du nombre de joueurs valent +infini et restent a la fin.
+static inline void CompareSwap(float* dist, int* slot, int a, int b)
+{
+    bool swap = dist[b] < dist[a];
+    float da = swap ? dist[b] : dist[a];
+    float db = swap ? dist[a] : dist[b];
+    int sa = swap ? slot[b] : slot[a];
+    int sb = swap ? slot[a] : slot[b];
+    dist[a] = da;
+    dist[b] = db;
+    slot[a] = sa;
+    slot[b] = sb;
+}
+
+template <int N>
+static void SortByDistance(float* dist, int* slot)
+{
+    static_assert(N >= 1 && N <= MAX_TEAM_SIZE, "taille d'equipe non prise en charge");
+    if constexpr (N == 2)
+    {
+        CompareSwap(dist, slot, 0, 1);
+    }
+    else if constexpr (N == 3)
+    {
+        CompareSwap(dist, slot, 0, 2);
+        CompareSwap(dist, slot, 0, 1);
+        CompareSwap(dist, slot, 1, 2);
+    }
+    else if constexpr (N == 4)
+    {
+        CompareSwap(dist, slot, 0, 1);
+        CompareSwap(dist, slot, 2, 3);
+        CompareSwap(dist, slot, 0, 2);
+        CompareSwap(dist, slot, 1, 3);
+        CompareSwap(dist, slot, 1, 2);
+    }
+}
+
+template <int N>
+void MatchAnalytics::UpdateRoles(TeamOrder& order, float dt)
+{
+    for (int j = order.count; j < N; ++j)
+        order.dist[j] = std::numeric_limits<float>::infinity();
+    SortByDistance<N>(order.dist, order.slot);
+
+    // Le dernier homme est le dernier joueur present, meme si l'equipe est
+    // incomplete
+    int last = std::min(order.count, N);
+    for (int j = 0; j < last; ++j)
+    {
+        PlayerStats &ps = stats[order.slot[j]];
+
+        int role = j + 1;
+        bool lastMan = role == last;
+        ps.roleTime[j] += dt;
+
+        ps.timeSinceAttack += dt;
+
+        // En 1v1, le joueur est a la fois premier et dernier homme : ni
+        // coupe de rotation ni serie de premier ou dernier homme
+        if constexpr (N > 1)
+        {
+            if (ps.lastRole != -1 && role < ps.lastRole - 1)
+                ps.cuts++;
+
+            if (role == 1)
+                ps.firstStreak += dt;
+            else
+            {
+                if (ps.firstStreak > 5.f)
+                    ps.aggressiveTime += ps.firstStreak;
+                ps.firstStreak = 0.f;
+            }
+
+            if (lastMan)
+                ps.lastManStreak += dt;
+            else
+            {
+                if (ps.lastManStreak > 5.f)
+                    ps.passiveTime += ps.lastManStreak;
+                ps.lastManStreak = 0.f;
+            }
+        }
+
+        if (ps.inAttack)
+        {
+            if (ps.timeSinceAttack > 3.f && !lastMan)
+                ps.ballchaseTime += dt;
+            if (lastMan && ps.timeSinceAttack > 1.f)
+                ps.inAttack = false;
+        }
+
+        ps.lastRole = role;
+    }
+}
+
+void MatchAnalytics::OnTouch(const FrameSnapshot& f, int self)
+{
+    float now = f.time;
+
+    int slot = f.slot[self];
+    const std::string& name = PlayerName(slot);
+    PlayerStats &ps = stats[slot];
+
+    const Vec3& pos = f.pos[self];
+    const Vec3& ballPos = f.ballPos;
+    const Vec3& ballVel = f.ballVel;
+    float playerBoost = std::max(f.boost[self], 0.f);
+    bool isAerial = !f.onGround[self];
+    int team = f.team[self];
+
+    bool wasDef = (team == 0) ? lastBallLocation.Y < -2000.f : lastBallLocation.Y > 2000.f;
+    bool nowOff = (team == 0) ? ballPos.Y > 0.f : ballPos.Y < 0.f;
+    if (wasDef && nowOff)
+    {
+        ps.clearances++;
+        if (debugEnabled)
+            Log("[DEBUG] Degagement par " + name);
+    }
+
+    bool oppNearby = false;
+    for (int i = 0; i < f.count; ++i)
+    {
+        if (f.team[i] == team || !f.hasCar[i])
+            continue;
+        if ((f.pos[i] - ballPos).magnitude() < 800.f)
+        {
+            oppNearby = true;
+            break;
+        }
+    }
+    float oppTouch = std::fabs(now - lastTeamTouchTime[team == 0 ? 1 : 0]);
+    if (oppNearby && oppTouch < 0.2f)
+    {
+        if (now - ps.lastDuelTime >= 1.0f)
+        {
+            ps.challengesWon++;
+            ps.lastDuelTime = now;
+            if (debugEnabled)
+            {
+                Log("[DEBUG] Duel gagne par " + name);
+                Log("[DEBUG] Duel compté");
+            }
+        }
+    }
+
+    // block si la balle allait vers le but et repart a l'oppose
+    if ((team == 0 && lastBallVel.Y < 0 && ballVel.Y >= 0 && pos.Y < 0) ||
+        (team == 1 && lastBallVel.Y > 0 && ballVel.Y <= 0 && pos.Y > 0))
+    {
+        ps.blocks++;
+        if (debugEnabled)
+            Log("[DEBUG] Block par " + name);
+    }
+
+    float gameTime = now;
+
+    // Passe utile
+    if (lastTouchSlot >= 0 && lastTouchSlot != slot)
+    {
+        int prev = f.FindSlot(lastTouchSlot);
+        if (prev >= 0 && f.team[prev] == team && gameTime - lastTouchTime < 2.f)
+            stats[lastTouchSlot].usefulPasses++;
+    }
+
+    lastTouchSlot = slot;
+    lastTouchTime = gameTime;
+    lastTouchAerial = isAerial;
+    lastTeamTouchTime[team] = gameTime;
+    RecordTouch(f, slot, team, isAerial ? TOUCH_AERIAL : 0);
+
+    ps.ballTouches++;
+    ps.inAttack = true;
+    ps.timeSinceAttack = 0.f;
+
+    // Trajectoire de la balle apres la touche : cadree si elle entre dans le
+    // but adverse avant l'horizon de prediction
+    BallPrediction prediction = PredictBall(ballPos, ballVel);
+    bool onTarget = prediction.goalSide == (team == 0 ? 1 : -1);
+    if (onTarget)
+        ps.shotsOnTarget++;
+
+    const Vec3& prevBall = lastBallLocation;
+    if ((team == 0 && prevBall.X < 0 && ballPos.X > 0) ||
+        (team == 1 && prevBall.X > 0 && ballPos.X < 0))
+        ps.cleanClears++;
+
+    // Tir non cadre : balle envoyee vers le but, sans y entrer
+    bool shot = onTarget;
+    if (!shot)
+    {
+        Vec3 goal = {0.f, team == 0 ? 5120.f : -5120.f, 0.f};
+        Vec3 toGoal = goal - ballPos;
+        toGoal.Z = 0.f;
+        Vec3 dir = ballVel;
+        dir.Z = 0.f;
+        if (((team == 0 && ballVel.Y > 0) || (team == 1 && ballVel.Y < 0)) && dir.magnitude() > 0.1f && toGoal.magnitude() > 0.1f)
+        {
+            dir.normalize();
+            toGoal.normalize();
+            float dotVal = Vec3::dot(dir, toGoal);
+            float ang = std::acos(std::clamp(dotVal, -1.f, 1.f));
+            if (ang < 0.35f && std::fabs(ballPos.X) < 900.f)
+                shot = true;
+        }
+    }
+
+    if (shot)
+    {
+        std::vector<DefenderInfo> defenders;
+        bool openNet = true;
+        for (int i = 0; i < f.count; ++i)
+        {
+            if (f.team[i] == team || !f.hasCar[i])
+                continue;
+            const Vec3& opos = f.pos[i];
+            float oboost = std::max(f.boost[i], 0.f);
+            float distToShooter = (opos - pos).magnitude();
+            if (distToShooter < 2000.f)
+                defenders.push_back({opos, oboost, false, distToShooter});
+            if (((team == 0 && opos.Y > ballPos.Y) || (team == 1 && opos.Y < ballPos.Y)) &&
+                std::fabs(opos.X - ballPos.X) < 800.f && oboost > 5.f)
+            {
+                openNet = false;
+            }
+        }
+        if (openNet)
+        {
+            if (gameTime - ps.lastMissedOpenGoalTime >= 2.0f)
+            {
+                ps.missedOpenGoals++;
+                ps.lastMissedOpenGoalTime = gameTime;
+                if (debugEnabled)
+                    Log("[DEBUG] Open goal raté compté");
+            }
+        }
+
+        uint8_t context = DetectShotContext(f, self, openNet, gameTime, isAerial);
+        bool quality = (context & (SHOT_DOUBLE_TAP | SHOT_PERFECT_CENTER)) != 0;
+        bool hardRebound = ballVel.magnitude() > 2000.f && std::fabs(ballVel.Z) > 500.f;
+        bool panicShot = playerBoost < 5.f && ballVel.magnitude() > 2500.f;
+        Vec3 goal = {0.f, team == 0 ? 5120.f : -5120.f, 0.f};
+        float distance = (pos - goal).magnitude();
+        Vec3 toGoal = goal - ballPos;
+        // Un tir cadre (lob, rebond compris) vise le but : angle nul
+        float angle = 0.f;
+        if (!onTarget && ballVel.magnitude() > 0.1f && toGoal.magnitude() > 0.1f) {
+            Vec3 velNorm = ballVel;
+            velNorm.normalize();
+            toGoal.normalize();
+            float dotVal = Vec3::dot(velNorm, toGoal);
+            angle = std::acos(std::clamp(dotVal, -1.f, 1.f));
+        }
+
+        float xg = ComputeXGAdvanced(distance, angle, ballVel.magnitude(), playerBoost, isAerial, defenders, hardRebound, panicShot, openNet, quality);
+        ps.shots.push_back({gameTime, xg, context});
+        if (debugEnabled && onTarget)
+            Log("[DEBUG] Tir cadre par " + name + ", but dans " + std::to_string(prediction.time) + " s");
+    }
+
+    for (int i = 0; i < f.count; ++i)
+    {
+        if (i == self || f.team[i] != team || !f.hasCar[i])
+            continue;
+        float dist = (f.pos[i] - pos).magnitude();
+        if (dist < 800.f && std::fabs(lastTeamTouchTime[team] - gameTime) < 0.5f)
+        {
+            ps.doubleCommits++;
+            stats[f.slot[i]].doubleCommits++;
+            break;
+        }
+    }
+
+    lastBallLocation = ballPos;
+
+    if (isAerial)
+        ps.aerialTouches++;
+}
+
+void MatchAnalytics::OnDemolish(const FrameSnapshot& f, int attacker)
+{
+    const Vec3& aloc = f.pos[attacker];
+    int aTeam = f.team[attacker];
+    PlayerStats& as = stats[f.slot[attacker]];
+    const std::string& aname = PlayerName(f.slot[attacker]);
+
+    // Demo effectuee dans sa propre moitie -> demolition defensive
+    if ((aTeam == 0 && aloc.Y < 0) || (aTeam == 1 && aloc.Y > 0))
+    {
+        as.defensiveDemos++;
+        if (debugEnabled)
+            Log("[DEBUG] Demo defensive par " + aname + " t:" + std::to_string(f.time));
+    }
+
+    // Demo effectuee dans la moitie adverse -> demolition offensive
+    if ((aTeam == 0 && aloc.Y > 0) || (aTeam == 1 && aloc.Y < 0))
+    {
+        as.offensiveDemos++;
+        if (debugEnabled)
+            Log("[DEBUG] Demo offensive par " + aname);
+    }
+}
+
+void MatchAnalytics::OnBoost(int slot, float current, float maxBoost)
+{
+    PlayerStats &ps = stats[slot];
+    float gained = ps.lastBoost >= 0.f ? current - ps.lastBoost : 0.f;
+
+    ps.boostPickups++;
+    if (ps.lastBoost >= 0.f && gained > 0.f)
+    {
+        if (ps.lastBoost >= maxBoost * 0.8f)
+            ps.wastedBoosts++;
+        if (gained > 90.f)
+            ps.bigPads++;
+        else
+            ps.smallPads++;
+    }
+    ps.lastBoost = current;
+}
+
+bool MatchAnalytics::OnGoal(const FrameSnapshot& f, int scoreBlue, int scoreOrange)
+{
+    int totalScore = scoreBlue + scoreOrange;
+    if (totalScore == lastTotalScore)
+        return false;
+    lastTotalScore = totalScore;
+
+    // Certaines versions du SDK ne fournissent pas la méthode GetLastGoalScorer.
+    // On détermine donc le buteur à partir du dernier joueur ayant touché la balle.
+    int scorer = f.FindSlot(lastTouchSlot);
+    if (lastTouchSlot < 0 || scorer < 0)
+    {
+        RecordTouch(f, -1, -1, TOUCH_GOAL);
+        return true;
+    }
+
+    stats[lastTouchSlot].goals++;
+
+    if (debugEnabled)
+        Log("[DEBUG] But marque par " + PlayerName(lastTouchSlot) + " t:" + std::to_string(f.time));
+
+    // Passeur : dernier coequipier a avoir touche la balle dans la meme
+    // possession que le buteur.
+    int team = f.team[scorer];
+    for (auto it = touches.rbegin(); it != touches.rend(); ++it)
+    {
+        if ((it->flags & TOUCH_GOAL) || it->team != team)
+            break;
+        if (it->slot != lastTouchSlot)
+        {
+            stats[it->slot].assists++;
+            break;
+        }
+    }
+    RecordTouch(f, lastTouchSlot, team, TOUCH_GOAL);
+    return true;
+}
+
+void MatchAnalytics::RecordTouch(const FrameSnapshot& f, int slot, int team, uint8_t flags)
+{
+    if (touches.size() >= MAX_TOUCHES)
+    {
+        if (droppedTouches++ == 0)
+            Log("[Analytics] Journal des touches plein, les touches suivantes sont ignorees");
+        return;
+    }
+    touches.push_back({f.time, static_cast<int8_t>(slot), static_cast<int8_t>(team), flags, f.ballPos, f.ballVel});
+}
+
+void MatchAnalytics::AnalyzePossession(PossessionSummary& out) const
+{
+    out = PossessionSummary{};
+    int chainTeam = -1;
+    int chainTouches = 0;
+    float chainStart = 0.f;
+    int prevSlot = -1;
+    auto closeChain = [&](float end) {
+        if (chainTeam < 0)
+            return;
+        PossessionSummary::Team& t = out.teams[chainTeam];
+        t.chains++;
+        t.touches += chainTouches;
+        t.time += std::max(0.f, end - chainStart);
+        chainTeam = -1;
+    };
+
+    for (const TouchRecord& r : touches)
+    {
+        if (r.flags & TOUCH_GOAL)
+        {
+            closeChain(r.time);
+            continue;
+        }
+        if (r.team < 0 || r.team > 1 || r.slot < 0)
+            continue;
+        if (r.team != chainTeam)
+        {
+            closeChain(r.time);
+            chainTeam = r.team;
+            chainTouches = 0;
+            chainStart = r.time;
+            prevSlot = -1;
+        }
+        if (prevSlot >= 0 && prevSlot != r.slot && out.passes[prevSlot][r.slot] < UINT16_MAX)
+            out.passes[prevSlot][r.slot]++;
+        prevSlot = r.slot;
+        chainTouches++;
+    }
+    // Derniere possession : jusqu'au dernier echantillon du match
+    closeChain(std::max(lastUpdate, touches.empty() ? 0.f : touches.back().time));
+}
+
+float MatchAnalytics::RotationQuality(const PlayerStats& ps, float totalTime) const
+{
+    // Rotation ideale : autant de temps dans chacun des roles de l'equipe
+    float rTotal = 0.f;
+    for (int r = 0; r < teamSize; ++r)
+        rTotal += ps.roleTime[r];
+    float ideal = rTotal / teamSize;
+    float diff = 0.f;
+    for (int r = 0; r < teamSize && rTotal > 0.f; ++r)
+        diff += std::fabs(ps.roleTime[r] - ideal) / rTotal;
+    float defenseRatio = totalTime > 0.f ? ps.defenseTime / totalTime : 0.f;
+    float score = 100.f - diff * 40.f - ps.cuts * 5.f
+                  - ps.aggressiveTime * 10.f - ps.passiveTime * 10.f
+                  - ps.ballchaseTime * 15.f
+                  - ps.doubleCommits * 3.f
+                  - std::fabs(defenseRatio - 0.5f) * 30.f;
+    return std::clamp(score, 0.f, 100.f) / 100.f;
+}
+
+// Nombre de champs ecrits par joueur (longueur de l'objet en CBOR), sans le
+// resume de session facultatif
+static constexpr size_t PLAYER_FIELDS = 30;
+
+void MatchAnalytics::WritePayload(const MatchSummary& summary, const PayloadExtras& extras, PayloadWriter& out) const
+{
+    static const PlayerStats NO_STATS{};
+    auto statsOf = [this](const ScoreboardLine& line) -> const PlayerStats& {
+        return line.slot >= 0 && line.slot < static_cast<int>(stats.size()) ? stats[line.slot] : NO_STATS;
+    };
+    auto goalsOf = [&](const ScoreboardLine& line) {
+        const PlayerStats& ps = statsOf(line);
+        return ps.goals > 0 ? ps.goals : line.goals;
+    };
+
+    // Utilise directement le temps total de jeu expose par le serveur
+    float totalTime = summary.totalGameTime;
+
+    // Premier passage : buteurs et MVP, dont les tailles precedent les listes
+    size_t scorerCount = 0;
+    const std::string* mvp = nullptr;
+    int bestScore = -1;
+    for (const ScoreboardLine& line : summary.players)
+    {
+        if (goalsOf(line) > 0)
+            scorerCount++;
+        if (line.score > bestScore)
+        {
+            bestScore = line.score;
+            mvp = &line.name;
+        }
+    }
+
+    int overtime = std::max(0, static_cast<int>(std::round(summary.secondsElapsed - 300.f)));
+
+    // Tampon des cartes de presence encodees, avant base64
+    uint8_t heatmapBytes[Heatmap::MAX_ENCODED];
+
+    PossessionSummary possession;
+    AnalyzePossession(possession);
+    size_t passLinks = 0;
+    for (int from = 0; from < MAX_SLOTS; ++from)
+        for (int to = 0; to < MAX_SLOTS; ++to)
+            passLinks += possession.passes[from][to] > 0;
+
+    out.BeginObject(11 + (extras.playedAt != 0) + (extras.uploadId != 0) + (extras.perf != nullptr));
+    out.Key("scoreBlue");
+    out.Int(summary.scoreBlue);
+    out.Key("scoreOrange");
+    out.Int(summary.scoreOrange);
+    out.Key("teamBlue");
+    out.String(summary.teamBlue);
+    out.Key("teamOrange");
+    out.String(summary.teamOrange);
+    out.Key("map");
+    out.String(summary.map);
+    out.Key("overtime");
+    out.Int(overtime);
+    out.Key("mvp");
+    out.String(mvp ? std::string_view(*mvp) : std::string_view());
+    if (extras.playedAt != 0)
+    {
+        out.Key("playedAt");
+        out.Int(extras.playedAt);
+    }
+    if (extras.uploadId != 0)
+    {
+        // Chaine : un entier 64 bits ne tient pas dans un nombre JavaScript
+        char id[24];
+        auto res = std::to_chars(id, id + sizeof(id), extras.uploadId);
+        out.Key("uploadId");
+        out.String(std::string_view(id, res.ptr - id));
+    }
+    if (extras.perf)
+    {
+        out.Key("perf");
+        extras.perf->Write(out);
+    }
+
+    // Grille commune aux cartes de presence, et celle de la balle
+    out.Key("heatmap");
+    out.BeginObject(4);
+    out.Key("cols");
+    out.Int(Heatmap::COLS);
+    out.Key("rows");
+    out.Int(Heatmap::ROWS);
+    out.Key("cellSize");
+    out.Int(static_cast<int>(Heatmap::CELL_SIZE));
+    out.Key("ball");
+    out.Base64(heatmapBytes, ballHeatmap.Encode(heatmapBytes));
+    out.End();
+    // Possession par equipe et reseau de passes (passeur -> receveur)
+    out.Key("possession");
+    out.BeginObject(3);
+    for (int team = 0; team < 2; ++team)
+    {
+        out.Key(team == 0 ? "blue" : "orange");
+        out.BeginObject(3);
+        out.Key("time");
+        out.Float(possession.teams[team].time);
+        out.Key("chains");
+        out.Int(possession.teams[team].chains);
+        out.Key("averageChain");
+        out.Float(possession.AverageChain(team));
+        out.End();
+    }
+    out.Key("passes");
+    out.BeginArray(passLinks);
+    for (int from = 0; from < MAX_SLOTS; ++from)
+    {
+        for (int to = 0; to < MAX_SLOTS; ++to)
+        {
+            if (possession.passes[from][to] == 0)
+                continue;
+            out.BeginObject(3);
+            out.Key("from");
+            out.String(PlayerName(from));
+            out.Key("to");
+            out.String(PlayerName(to));
+            out.Key("count");
+            out.Int(possession.passes[from][to]);
+            out.End();
+        }
+    }
+    out.End();
+    out.End();
+    out.Key("scorers");
+    out.BeginArray(scorerCount);
+    for (const ScoreboardLine& line : summary.players)
+    {
+        if (goalsOf(line) > 0)
+            out.String(line.name);
+    }
+    out.End();
+
+    out.Key("players");
+    out.BeginArray(summary.players.size());
+    for (const ScoreboardLine& line : summary.players)
+    {
+        const PlayerStats& ps = statsOf(line);
+        float rTotal = 0.f;
+        for (int r = 0; r < teamSize; ++r)
+            rTotal += ps.roleTime[r];
+        const SessionPlayer* sessionPlayer = nullptr;
+        if (extras.session && line.slot >= 0)
+            sessionPlayer = extras.session->Find(registry.entries[line.slot].uid, line.name);
+
+        // Tirs et xG par contexte ; seuls les contextes rencontres sont ecrits
+        int contextShots[SHOT_CONTEXT_COUNT] = {};
+        float contextXg[SHOT_CONTEXT_COUNT] = {};
+        float xgTotal = 0.f;
+        for (const ShotRecord& shot : ps.shots)
+        {
+            xgTotal += shot.xg;
+            for (int bit = 0; bit < SHOT_CONTEXT_COUNT; ++bit)
+            {
+                if (shot.context & (1 << bit))
+                {
+                    contextShots[bit]++;
+                    contextXg[bit] += shot.xg;
+                }
+            }
+        }
+        size_t contextCount = 0;
+        for (int bit = 0; bit < SHOT_CONTEXT_COUNT; ++bit)
+            contextCount += contextShots[bit] > 0;
+
+        out.BeginObject(PLAYER_FIELDS + (sessionPlayer != nullptr));
+        out.Key("name");
+        out.String(line.name);
+        out.Key("team");
+        out.Int(line.team);
+        out.Key("goals");
+        out.Int(goalsOf(line));
+        out.Key("assists");
+        out.Int(ps.assists > 0 ? ps.assists : line.assists);
+        out.Key("shots");
+        out.Int(ps.shotsOnTarget > 0 ? ps.shotsOnTarget : line.shots);
+        out.Key("saves");
+        out.Int(line.saves);
+        out.Key("score");
+        out.Int(line.score);
+        out.Key("boostPickups");
+        out.Int(ps.boostPickups);
+        out.Key("wastedBoostPickups");
+        out.Int(ps.wastedBoosts);
+        out.Key("boostFrequency");
+        out.Float(totalTime > 0.f ? ps.boostPickups / totalTime : 0.f);
+        out.Key("rotationQuality");
+        out.Float(RotationQuality(ps, totalTime));
+        out.Key("role1Frequency");
+        out.Float(rTotal > 0.f ? ps.roleTime[0] / rTotal : 0.f);
+        out.Key("role2Frequency");
+        out.Float(rTotal > 0.f ? ps.roleTime[1] / rTotal : 0.f);
+        out.Key("role3Frequency");
+        out.Float(rTotal > 0.f ? ps.roleTime[2] / rTotal : 0.f);
+        out.Key("role4Frequency");
+        out.Float(rTotal > 0.f ? ps.roleTime[3] / rTotal : 0.f);
+        out.Key("cuts");
+        out.Int(ps.cuts);
+        out.Key("clearances");
+        out.Int(ps.clearances);
+        out.Key("defensiveChallenges");
+        out.Int(ps.challengesWon);
+        out.Key("defensiveDemos");
+        out.Int(ps.defensiveDemos);
+        out.Key("defenseTime");
+        out.Float(ps.defenseTime);
+        out.Key("clutchSaves");
+        out.Int(ps.clutchSaves);
+        out.Key("blocks");
+        out.Int(ps.blocks);
+        out.Key("ballTouches");
+        out.Int(ps.ballTouches);
+        out.Key("highPressings");
+        out.Int(ps.highPressings);
+        out.Key("aerialTouches");
+        out.Int(ps.aerialTouches);
+        out.Key("missedOpenGoals");
+        out.Int(ps.missedOpenGoals);
+        out.Key("doubleCommits");
+        out.Int(ps.doubleCommits);
+        out.Key("xg");
+        out.Float(xgTotal);
+        out.Key("shotContexts");
+        out.BeginObject(contextCount);
+        for (int bit = 0; bit < SHOT_CONTEXT_COUNT; ++bit)
+        {
+            if (contextShots[bit] == 0)
+                continue;
+            out.Key(ShotContextName(bit));
+            out.BeginObject(2);
+            out.Key("count");
+            out.Int(contextShots[bit]);
+            out.Key("xg");
+            out.Float(contextXg[bit]);
+            out.End();
+        }
+        out.End();
+        out.Key("heatmap");
+        out.Base64(heatmapBytes, ps.heatmap.Encode(heatmapBytes));
+        if (sessionPlayer)
+        {
+            out.Key("session");
+            SessionStats::WritePlayer(*sessionPlayer, out);
+        }
+        out.End();
+    }
+    out.End();
+    out.End();
+}
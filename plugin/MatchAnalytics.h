@@ -0,0 +1,448 @@
+#pragma once
+#include "Heatmap.h"
+#include "PayloadWriter.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Coeur des statistiques de match, independant du SDK BakkesMod.
+//
+// Le plugin traduit les hooks du jeu en appels a MatchAnalytics (frames
+// capturees, touches, demolitions, boosts, buts) ; l'outil auusa_replay fait
+// de meme a partir d'un enregistrement de telemetrie. Les deux produisent
+// le meme payload de fin de match aux arrondis de la telemetrie pres
+// (positions et vitesses a l'unite, boost au centieme) : auusa_check
+// verifie que l'ecart reste dans ses tolerances.
+
+static constexpr int MAX_PLAYERS = 8;
+static constexpr int MAX_SLOTS = 16;
+// 4v4 au plus : un role de rotation par joueur de l'equipe
+static constexpr int MAX_TEAM_SIZE = MAX_PLAYERS / 2;
+
+struct Vec3
+{
+    float X = 0.f;
+    float Y = 0.f;
+    float Z = 0.f;
+
+    Vec3 operator-(const Vec3& o) const { return {X - o.X, Y - o.Y, Z - o.Z}; }
+    float magnitude() const { return std::sqrt(X * X + Y * Y + Z * Z); }
+    void normalize()
+    {
+        float m = magnitude();
+        if (m > 0.f)
+        {
+            X /= m;
+            Y /= m;
+            Z /= m;
+        }
+    }
+    static float dot(const Vec3& a, const Vec3& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+};
+
+// Contexte d'un tir detecte, en bits (ShotRecord::context). Les noms ne
+// sont produits qu'a l'ecriture du payload (ShotContextName).
+enum ShotContextFlags : uint8_t
+{
+    SHOT_DOUBLE_TAP = 1 << 0,
+    SHOT_PANIC = 1 << 1,
+    SHOT_BACKBOARD = 1 << 2,
+    SHOT_PERFECT_CENTER = 1 << 3,
+    SHOT_OPEN_NET = 1 << 4,
+    SHOT_AERIAL = 1 << 5
+};
+
+static constexpr int SHOT_CONTEXT_COUNT = 6;
+
+// Nom du contexte de rang `bit` (0 a SHOT_CONTEXT_COUNT - 1).
+const char* ShotContextName(int bit);
+
+struct ShotRecord
+{
+    float time = 0.f;
+    float xg = 0.f;
+    uint8_t context = 0; // ShotContextFlags
+};
+
+// Entree du journal des touches : une touche de balle, ou un but (TOUCH_GOAL,
+// slot = buteur ou -1) qui clot la possession en cours.
+enum TouchFlags : uint8_t
+{
+    TOUCH_AERIAL = 1 << 0,
+    TOUCH_GOAL = 1 << 1
+};
+
+struct TouchRecord
+{
+    float time = 0.f; // secondes de jeu (FrameSnapshot::time)
+    int8_t slot = -1;
+    int8_t team = -1;
+    uint8_t flags = 0; // TouchFlags
+    Vec3 ballPos;
+    Vec3 ballVel;
+};
+
+// Possessions reconstruites a partir du journal des touches : une chaine est
+// une suite de touches d'une meme equipe, close par une touche adverse ou
+// un but. Une passe est une touche suivie, dans la meme chaine, par celle
+// d'un coequipier.
+struct PossessionSummary
+{
+    struct Team
+    {
+        int chains = 0;
+        int touches = 0;  // touches dans les chaines
+        float time = 0.f; // du debut de chaque chaine au debut de la suivante
+    };
+
+    Team teams[2];
+    uint16_t passes[MAX_SLOTS][MAX_SLOTS] = {}; // [passeur][receveur]
+
+    float AverageChain(int team) const
+    {
+        return teams[team].chains > 0 ? static_cast<float>(teams[team].touches) / teams[team].chains : 0.f;
+    }
+};
+
+struct PlayerStats
+{
+    int boostPickups = 0;
+    int wastedBoosts = 0;
+    int smallPads = 0;
+    int bigPads = 0;
+    float lastBoost = -1.f;
+
+    // Statistiques offensives
+    int goals = 0;
+    int assists = 0;
+    int shotsOnTarget = 0;
+    int offensiveDemos = 0;
+
+    // Statistiques defensives
+    int clearances = 0;
+    int challengesWon = 0;
+    int defensiveDemos = 0;
+    float defenseTime = 0.f;
+    int clutchSaves = 0;
+    int blocks = 0;
+
+    // Vision & soutien
+    int usefulPasses = 0;
+    int cleanClears = 0;
+    int missedOpenGoals = 0;
+    int doubleCommits = 0;
+    int aerialTouches = 0;
+    int highPressings = 0;
+    int ballTouches = 0;
+
+    // Suivi des roles de rotation (1er homme, 2e... dernier)
+    float roleTime[MAX_TEAM_SIZE] = {};
+    int cuts = 0;
+    float aggressiveTime = 0.f;
+    float passiveTime = 0.f;
+    float ballchaseTime = 0.f;
+    int lastRole = -1;
+    float firstStreak = 0.f;
+    float lastManStreak = 0.f;
+
+    // Etats internes
+    bool inAttack = false;
+    float timeSinceAttack = 0.f;
+    int prevSaves = 0;
+
+    // Garde-fous pour la comptabilisation des evenements
+    float lastDuelTime = -10.f;
+    float lastMissedOpenGoalTime = -10.f;
+    float lastHighPressTime = -10.f;
+
+    std::vector<ShotRecord> shots;
+    Heatmap heatmap;
+
+    float ExpectedGoals() const
+    {
+        float total = 0.f;
+        for (const ShotRecord& s : shots)
+            total += s.xg;
+        return total;
+    }
+};
+
+// Registre des joueurs du match. Chaque PRI recoit un emplacement stable,
+// qui sert d'indice dans le tableau de PlayerStats. Un PRI deja connu est
+// retrouve par son adresse ; un joueur qui se reconnecte recupere son
+// emplacement grace a son identifiant unique de plateforme.
+struct PlayerRegistry
+{
+    struct Entry
+    {
+        uintptr_t pri = 0; // 0 : le joueur a quitte la partie
+        std::string uid;
+        std::string name;
+        int team = -1;
+    };
+
+    Entry entries[MAX_SLOTS];
+    int count = 0;
+
+    void Reset()
+    {
+        for (int i = 0; i < count; ++i)
+            entries[i] = Entry{};
+        count = 0;
+    }
+
+    int Find(uintptr_t priAddr) const
+    {
+        for (int i = 0; i < count; ++i)
+            if (entries[i].pri == priAddr)
+                return i;
+        return -1;
+    }
+
+    // Renvoie l'emplacement attribue, ou -1 si le registre est plein.
+    int Register(uintptr_t priAddr, const std::string& uid, const std::string& name, int team)
+    {
+        int slot = -1;
+        if (!uid.empty())
+        {
+            for (int i = 0; i < count && slot < 0; ++i)
+                if (entries[i].pri == 0 && entries[i].uid == uid)
+                    slot = i;
+        }
+        if (slot < 0)
+        {
+            if (count >= MAX_SLOTS)
+                return -1;
+            slot = count++;
+        }
+        Assign(slot, priAddr, uid, name, team);
+        return slot;
+    }
+
+    // Place un joueur dans un emplacement impose (relecture d'un match).
+    void Assign(int slot, uintptr_t priAddr, const std::string& uid, const std::string& name, int team)
+    {
+        entries[slot].pri = priAddr;
+        entries[slot].uid = uid;
+        entries[slot].name = name;
+        entries[slot].team = team;
+        count = std::max(count, slot + 1);
+    }
+};
+
+// Etat du monde lu une seule fois par frame : balle puis, pour chaque PRI,
+// voiture, boost et equipe. Toutes les analyses lisent ces tableaux plutot
+// que de rappeler les wrappers du SDK.
+struct FrameSnapshot
+{
+    float time = -1.f;
+    bool hasBall = false;
+    Vec3 ballPos;
+    Vec3 ballVel;
+
+    int count = 0;
+    uintptr_t pri[MAX_PLAYERS] = {};
+    int slot[MAX_PLAYERS] = {};
+    int team[MAX_PLAYERS] = {};
+    bool hasCar[MAX_PLAYERS] = {};
+    Vec3 pos[MAX_PLAYERS];
+    Vec3 vel[MAX_PLAYERS];
+    float boost[MAX_PLAYERS] = {}; // -1 si la voiture n'a pas de composant boost
+    bool onGround[MAX_PLAYERS] = {};
+    int saves[MAX_PLAYERS] = {};
+
+    int Find(uintptr_t priAddr) const
+    {
+        for (int i = 0; i < count; ++i)
+            if (pri[i] == priAddr)
+                return i;
+        return -1;
+    }
+
+    // Indice dans la frame d'un emplacement du registre, -1 si absent.
+    int indexOfSlot[MAX_SLOTS];
+
+    FrameSnapshot() { std::fill(std::begin(indexOfSlot), std::end(indexOfSlot), -1); }
+
+    int FindSlot(int s) const { return s >= 0 ? indexOfSlot[s] : -1; }
+
+    // Vide la frame avant une nouvelle capture.
+    void Clear()
+    {
+        for (int i = 0; i < count; ++i)
+            indexOfSlot[slot[i]] = -1;
+        count = 0;
+    }
+};
+
+// Phase de jeu : les analyses ne tournent qu'en phase Live.
+enum class GamePhase
+{
+    Idle,       // hors match
+    Countdown,  // compte a rebours du coup d'envoi
+    Live,       // jeu en cours
+    GoalReplay, // celebration puis ralenti apres un but
+    Paused,
+    Podium      // fin de match
+};
+
+const char* GamePhaseName(GamePhase phase);
+
+struct DefenderInfo {
+    Vec3 pos;
+    float boost;
+    bool padNearby;
+    float distance;
+};
+
+// Tableau des scores lu en fin de match, une ligne par joueur.
+struct ScoreboardLine
+{
+    int slot = -1; // -1 : joueur inconnu du registre
+    std::string name;
+    int team = 0;
+    int goals = 0;
+    int assists = 0;
+    int shots = 0;
+    int saves = 0;
+    int score = 0;
+};
+
+struct MatchSummary
+{
+    int scoreBlue = 0;
+    int scoreOrange = 0;
+    std::string teamBlue;
+    std::string teamOrange;
+    std::string map;
+    float secondsElapsed = 0.f;
+    float totalGameTime = 0.f;
+    std::vector<ScoreboardLine> players;
+};
+
+class SessionStats;
+struct PerfReport;
+
+// Champs ajoutes par le plugin au resultat de fin de match
+struct PayloadExtras
+{
+    int64_t playedAt = 0;  // heure de fin (secondes Unix)
+    uint64_t uploadId = 0; // permet au bot d'ignorer un renvoi
+    // Agregats de session joints a chaque joueur connu, si non nul
+    const SessionStats* session = nullptr;
+    // Latences des hooks depuis l'envoi precedent (mm_perf_upload), si non nul
+    const PerfReport* perf = nullptr;
+};
+
+class MatchAnalytics
+{
+public:
+    using LogFn = std::function<void(const std::string&)>;
+
+    MatchAnalytics() { SetTeamSize(3); }
+
+    void SetLogger(LogFn fn) { log = std::move(fn); }
+    void SetDebug(bool enabled) { debugEnabled = enabled; }
+
+    // Debut de match : remise a zero du registre et des statistiques.
+    void Reset();
+    // Fixe aussi la taille des equipes d'apres les joueurs presents.
+    void OnMatchStart(const FrameSnapshot& f);
+
+    // Nombre de roles de rotation (1 a MAX_TEAM_SIZE) ; choisit la version
+    // des analyses d'equipe specialisee pour cette taille.
+    void SetTeamSize(int size);
+    int TeamSize() const { return teamSize; }
+
+    // Place un joueur dans l'emplacement attribue par le registre du thread
+    // du jeu (ou lu dans un enregistrement) ; le rappeler met son equipe a jour.
+    void AssignPlayer(int slot, const std::string& uid, const std::string& name, int team);
+    PlayerRegistry& Registry() { return registry; }
+    const PlayerRegistry& Registry() const { return registry; }
+    const std::string& PlayerName(int slot) const { return registry.entries[slot].name; }
+    // nullptr si l'emplacement n'a pas encore de statistiques.
+    const PlayerStats* Stats(int slot) const
+    {
+        return slot >= 0 && slot < static_cast<int>(stats.size()) ? &stats[slot] : nullptr;
+    }
+    int LastTouchSlot() const { return lastTouchSlot; }
+    const std::vector<TouchRecord>& Touches() const { return touches; }
+    const Heatmap& BallHeatmap() const { return ballHeatmap; }
+
+    GamePhase Phase() const { return phase; }
+    bool IsLive() const { return phase == GamePhase::Live; }
+    void SetPhase(GamePhase next);
+    float LastSampleTime() const { return lastUpdate; }
+
+    // Echantillon periodique des statistiques de rotation et de defense.
+    void Sample(const FrameSnapshot& f);
+    void OnTouch(const FrameSnapshot& f, int self);
+    void OnDemolish(const FrameSnapshot& f, int attacker);
+    void OnBoost(int slot, float current, float maxBoost);
+    // Renvoie false si le score n'a pas change (hook declenche plusieurs fois).
+    bool OnGoal(const FrameSnapshot& f, int scoreBlue, int scoreOrange);
+
+    // Chaines de possession et reseau de passes, calcules en fin de match a
+    // partir du journal des touches.
+    void AnalyzePossession(PossessionSummary& out) const;
+
+    // Qualite de rotation d'un joueur, entre 0 et 1.
+    float RotationQuality(const PlayerStats& ps, float totalTime) const;
+
+    // Resultat de fin de match ecrit directement dans `out` (remis a zero
+    // par l'appelant). playedAt, uploadId et perf ne sont ecrits que s'ils sont
+    // non nuls.
+    void WritePayload(const MatchSummary& summary, const PayloadExtras& extras, PayloadWriter& out) const;
+
+    static float ComputeXGAdvanced(float distance, float angle, float ballSpeed, float playerBoost, bool isAerial, const std::vector<DefenderInfo>& defenders, bool hardRebound, bool panicShot, bool openNet, bool qualityAction);
+
+private:
+    uint8_t DetectShotContext(const FrameSnapshot& f, int shooter, bool openNet, float gameTime, bool isAerial) const;
+    void RecordTouch(const FrameSnapshot& f, int slot, int team, uint8_t flags);
+
+    // Joueurs d'une equipe (emplacements) et leur distance a la balle
+    struct TeamOrder
+    {
+        int count = 0;
+        int slot[MAX_TEAM_SIZE];
+        float dist[MAX_TEAM_SIZE];
+    };
+    // Roles de rotation d'une equipe de N joueurs au plus
+    template <int N>
+    void UpdateRoles(TeamOrder& order, float dt);
+    using UpdateRolesFn = void (MatchAnalytics::*)(TeamOrder&, float);
+    void Log(const std::string& msg) const
+    {
+        if (log)
+            log(msg);
+    }
+
+    LogFn log;
+    bool debugEnabled = false;
+
+    PlayerRegistry registry;
+    std::vector<PlayerStats> stats; // indexe par emplacement du registre
+    int teamSize = 0;
+    UpdateRolesFn updateRoles = nullptr;
+    GamePhase phase = GamePhase::Idle;
+
+    int lastTouchSlot = -1;
+    float lastTouchTime = 0.f;
+    bool lastTouchAerial = false;
+    float lastTeamTouchTime[2] = {0.f, 0.f};
+    // Journal des touches et des buts, reserve au debut du match : au-dela
+    // de MAX_TOUCHES, les entrees sont ignorees.
+    static constexpr size_t MAX_TOUCHES = 8192;
+    std::vector<TouchRecord> touches;
+    int droppedTouches = 0;
+    Vec3 lastBallLocation;
+    Vec3 lastBallVel;
+    Heatmap ballHeatmap;
+    float lastUpdate = 0.f;
+    int lastTotalScore = 0;
+};
@@ -0,0 +1,246 @@
+#include "MatchStream.h"
+#include <algorithm>
+#include <utility>
+
+using json = nlohmann::json;
+
+bool StreamCounters::operator==(const StreamCounters& o) const
+{
+    return goals == o.goals && assists == o.assists && shotsOnTarget == o.shotsOnTarget && saves == o.saves
+        && ballTouches == o.ballTouches && clearances == o.clearances && demos == o.demos
+        && boostPickups == o.boostPickups && expectedGoals == o.expectedGoals;
+}
+
+static const char* EventName(StreamEventType type)
+{
+    switch (type)
+    {
+    case StreamEventType::Goal: return "goal";
+    case StreamEventType::Demo: return "demo";
+    default: return "touch";
+    }
+}
+
+json StreamBatch::ToJson() const
+{
+    auto nameOf = [this](int slot) -> std::string {
+        return slot >= 0 && slot < static_cast<int>(names.size()) ? names[slot] : std::string();
+    };
+
+    json list = json::array();
+    for (const StreamEvent& ev : events)
+    {
+        json e = {{"type", EventName(ev.type)}, {"time", ev.time}, {"player", nameOf(ev.slot)}};
+        if (ev.type == StreamEventType::Touch && ev.xg >= 0.f)
+            e["xg"] = ev.xg;
+        else if (ev.type == StreamEventType::Demo)
+            e["victim"] = nameOf(ev.other);
+        else if (ev.type == StreamEventType::Goal)
+        {
+            e["scoreBlue"] = ev.scoreBlue;
+            e["scoreOrange"] = ev.scoreOrange;
+        }
+        list.push_back(std::move(e));
+    }
+
+    // Seuls les compteurs modifies sont transmis
+    json deltas = json::array();
+    for (const Player& p : players)
+    {
+        json d = {{"name", p.name}, {"team", p.team}};
+        auto put = [&d](const char* key, int value) {
+            if (value != 0)
+                d[key] = value;
+        };
+        put("goals", p.delta.goals);
+        put("assists", p.delta.assists);
+        put("shots", p.delta.shotsOnTarget);
+        put("saves", p.delta.saves);
+        put("touches", p.delta.ballTouches);
+        put("clearances", p.delta.clearances);
+        put("demos", p.delta.demos);
+        put("boostPickups", p.delta.boostPickups);
+        if (p.delta.expectedGoals != 0.f)
+            d["expectedGoals"] = p.delta.expectedGoals;
+        deltas.push_back(std::move(d));
+    }
+
+    json payload = {
+        {"matchId", matchId},
+        {"seq", seq},
+        {"final", final},
+        {"time", time},
+        {"scoreBlue", scoreBlue},
+        {"scoreOrange", scoreOrange},
+        {"events", std::move(list)},
+        {"players", std::move(deltas)}};
+    if (!reporter.empty())
+        payload["reporter"] = reporter;
+    if (lostBatches > 0)
+        payload["lostBatches"] = lostBatches;
+    return payload;
+}
+
+void MatchStream::SetLimits(float interval, size_t events)
+{
+    flushInterval = interval > 0.f ? interval : DEFAULT_INTERVAL;
+    maxEvents = std::min(std::max<size_t>(events, 1), MAX_EVENTS);
+}
+
+void MatchStream::Begin(const std::string& id, const std::string& who, float now)
+{
+    matchId = id;
+    reporter = who;
+    seq = 0;
+    lastFlush = now;
+    scoreBlue = scoreOrange = 0;
+    events.clear();
+    events.reserve(maxEvents);
+    for (StreamCounters& c : baseline)
+        c = StreamCounters{};
+    sent = lost = lostSinceSent = 0;
+    active = true;
+}
+
+void MatchStream::End(float now)
+{
+    if (!active)
+        return;
+    Flush(now, true);
+    active = false;
+}
+
+void MatchStream::AddTouch(float time, int slot, float xg)
+{
+    StreamEvent ev;
+    ev.type = StreamEventType::Touch;
+    ev.slot = static_cast<int8_t>(slot);
+    ev.time = time;
+    ev.xg = xg;
+    Add(ev);
+}
+
+void MatchStream::AddDemo(float time, int attacker, int victim)
+{
+    StreamEvent ev;
+    ev.type = StreamEventType::Demo;
+    ev.slot = static_cast<int8_t>(attacker);
+    ev.other = static_cast<int8_t>(victim);
+    ev.time = time;
+    Add(ev);
+}
+
+void MatchStream::AddGoal(float time, int scorer, int blue, int orange)
+{
+    if (!active)
+        return;
+    scoreBlue = blue;
+    scoreOrange = orange;
+    StreamEvent ev;
+    ev.type = StreamEventType::Goal;
+    ev.slot = static_cast<int8_t>(scorer);
+    ev.time = time;
+    ev.scoreBlue = static_cast<int16_t>(blue);
+    ev.scoreOrange = static_cast<int16_t>(orange);
+    events.push_back(ev);
+    // Le score en direct n'attend pas la fin de l'intervalle
+    Flush(time, false);
+}
+
+void MatchStream::Tick(float now)
+{
+    if (!active || now - lastFlush < flushInterval)
+        return;
+    Flush(now, false);
+}
+
+void MatchStream::Add(const StreamEvent& ev)
+{
+    if (!active)
+        return;
+    events.push_back(ev);
+    if (events.size() >= maxEvents)
+        Flush(ev.time, false);
+}
+
+StreamCounters MatchStream::Read(int slot) const
+{
+    StreamCounters c;
+    const PlayerStats* ps = analytics.Stats(slot);
+    if (!ps)
+        return c;
+    c.goals = ps->goals;
+    c.assists = ps->assists;
+    c.shotsOnTarget = ps->shotsOnTarget;
+    c.saves = ps->prevSaves;
+    c.ballTouches = ps->ballTouches;
+    c.clearances = ps->clearances;
+    c.demos = ps->offensiveDemos + ps->defensiveDemos;
+    c.boostPickups = ps->boostPickups;
+    c.expectedGoals = ps->ExpectedGoals();
+    return c;
+}
+
+void MatchStream::Flush(float now, bool final)
+{
+    lastFlush = now;
+
+    auto batch = std::make_shared<StreamBatch>();
+    const PlayerRegistry& registry = analytics.Registry();
+    StreamCounters current[MAX_SLOTS];
+    for (int s = 0; s < registry.count; ++s)
+    {
+        current[s] = Read(s);
+        if (current[s] == baseline[s])
+            continue;
+        StreamBatch::Player p;
+        p.slot = s;
+        p.name = registry.entries[s].name;
+        p.team = registry.entries[s].team;
+        const StreamCounters& b = baseline[s];
+        StreamCounters& d = p.delta;
+        d.goals = current[s].goals - b.goals;
+        d.assists = current[s].assists - b.assists;
+        d.shotsOnTarget = current[s].shotsOnTarget - b.shotsOnTarget;
+        d.saves = current[s].saves - b.saves;
+        d.ballTouches = current[s].ballTouches - b.ballTouches;
+        d.clearances = current[s].clearances - b.clearances;
+        d.demos = current[s].demos - b.demos;
+        d.boostPickups = current[s].boostPickups - b.boostPickups;
+        d.expectedGoals = current[s].expectedGoals - b.expectedGoals;
+        batch->players.push_back(std::move(p));
+    }
+    // Rien a signaler : pas de lot vide, sauf le dernier qui clot le match
+    if (events.empty() && batch->players.empty() && !final)
+        return;
+
+    batch->matchId = matchId;
+    batch->reporter = reporter;
+    batch->seq = ++seq;
+    batch->final = final;
+    batch->time = now;
+    batch->scoreBlue = scoreBlue;
+    batch->scoreOrange = scoreOrange;
+    batch->lostBatches = lostSinceSent;
+    batch->names.reserve(registry.count);
+    for (int s = 0; s < registry.count; ++s)
+        batch->names.push_back(registry.entries[s].name);
+    batch->events = std::move(events);
+    events.clear();
+    events.reserve(maxEvents);
+
+    if (submit && submit(batch))
+    {
+        sent++;
+        lostSinceSent = 0;
+        for (int s = 0; s < registry.count; ++s)
+            baseline[s] = current[s];
+    }
+    else
+    {
+        // Les evenements du lot sont perdus ; les compteurs, eux, repartent
+        // avec le lot suivant puisque la reference n'a pas bouge.
+        lost++;
+        lostSinceSent++;
+    }
+}
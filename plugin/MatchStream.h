@@ -0,0 +1,140 @@
+#pragma once
+#include "MatchAnalytics.h"
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Envoi des evenements du match pendant la partie (mm_stream).
+//
+// Le thread d'analyse ajoute buts, demolitions et touches (avec le xG des tirs)
+// a un lot en memoire. Le lot part toutes les flushInterval secondes de jeu,
+// des qu'il atteint maxEvents evenements, ou tout de suite apres un but pour
+// que le score en direct suive. Chaque lot porte aussi, par joueur, la
+// variation des compteurs depuis le lot precedent, et un numero de sequence
+// croissant : le serveur ignore un lot deja recu et repere les lots perdus.
+//
+// Le lot est remis tel quel (evenements de taille fixe) a SubmitFn ; sa
+// conversion en JSON (ToJson) se fait sur le thread d'envoi. La memoire est
+// bornee : un lot ne depasse pas MAX_EVENTS evenements et le plugin limite
+// le nombre de lots en attente d'envoi. Un lot refuse est perdu et compte,
+// mais les variations de compteurs sont reportees sur le lot suivant.
+enum class StreamEventType : uint8_t
+{
+    Goal,
+    Demo,
+    Touch
+};
+
+struct StreamEvent
+{
+    StreamEventType type = StreamEventType::Touch;
+    int8_t slot = -1;  // auteur, -1 si inconnu
+    int8_t other = -1; // victime d'une demolition
+    float time = 0.f;  // temps de partie
+    float xg = -1.f;   // touche : xG du tir, -1 si la touche n'est pas un tir
+    int16_t scoreBlue = 0;
+    int16_t scoreOrange = 0;
+};
+
+// Compteurs cumules d'un joueur ; les lots en transportent la difference.
+struct StreamCounters
+{
+    int goals = 0;
+    int assists = 0;
+    int shotsOnTarget = 0;
+    int saves = 0;
+    int ballTouches = 0;
+    int clearances = 0;
+    int demos = 0;
+    int boostPickups = 0;
+    float expectedGoals = 0.f;
+
+    bool operator==(const StreamCounters& o) const;
+    bool operator!=(const StreamCounters& o) const { return !(*this == o); }
+};
+
+struct StreamBatch
+{
+    struct Player
+    {
+        int slot = -1;
+        std::string name;
+        int team = 0;
+        StreamCounters delta;
+    };
+
+    std::string matchId;
+    std::string reporter;
+    uint64_t seq = 0;
+    bool final = false;
+    float time = 0.f;
+    int scoreBlue = 0;
+    int scoreOrange = 0;
+    uint64_t lostBatches = 0; // refuses depuis le lot precedent
+    std::vector<StreamEvent> events;
+    std::vector<std::string> names; // indexe par emplacement
+    std::vector<Player> players;    // joueurs dont un compteur a change
+
+    nlohmann::json ToJson() const;
+};
+
+class MatchStream
+{
+public:
+    // Renvoie false si le lot n'a pas pu etre mis en file d'envoi.
+    using SubmitFn = std::function<bool(std::shared_ptr<const StreamBatch>)>;
+
+    static constexpr size_t MAX_EVENTS = 512;
+    static constexpr float DEFAULT_INTERVAL = 5.f;
+    static constexpr size_t DEFAULT_EVENTS = 64;
+
+    explicit MatchStream(const MatchAnalytics& analytics) : analytics(analytics) {}
+
+    void SetSubmit(SubmitFn fn) { submit = std::move(fn); }
+    // Pris en compte au prochain lot.
+    void SetLimits(float flushInterval, size_t maxEvents);
+
+    void Begin(const std::string& matchId, const std::string& reporter, float now);
+    // Envoie le dernier lot (final) et arrete l'enregistrement.
+    void End(float now);
+    bool Active() const { return active; }
+
+    void AddTouch(float time, int slot, float xg);
+    void AddDemo(float time, int attacker, int victim);
+    void AddGoal(float time, int scorer, int scoreBlue, int scoreOrange);
+    // A appeler regulierement (echantillonneur) : envoie le lot si son delai
+    // est ecoule.
+    void Tick(float now);
+
+    uint64_t Sent() const { return sent; }
+    uint64_t Lost() const { return lost; }
+
+private:
+    void Add(const StreamEvent& ev);
+    void Flush(float now, bool final);
+    StreamCounters Read(int slot) const;
+
+    const MatchAnalytics& analytics;
+    SubmitFn submit;
+    float flushInterval = DEFAULT_INTERVAL;
+    size_t maxEvents = DEFAULT_EVENTS;
+
+    bool active = false;
+    std::string matchId;
+    std::string reporter;
+    uint64_t seq = 0;
+    float lastFlush = 0.f;
+    int scoreBlue = 0;
+    int scoreOrange = 0;
+    std::vector<StreamEvent> events;
+    // Compteurs au dernier lot accepte, par emplacement
+    StreamCounters baseline[MAX_SLOTS];
+
+    uint64_t sent = 0;
+    uint64_t lost = 0;
+    uint64_t lostSinceSent = 0;
+};
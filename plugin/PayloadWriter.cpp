@@ -0,0 +1,312 @@
+#include "PayloadWriter.h"
+#include "Utf8.h"
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+const char* PayloadFormatName(PayloadFormat format)
+{
+    return format == PayloadFormat::Cbor ? "cbor" : "json";
+}
+
+const char* PayloadContentType(PayloadFormat format)
+{
+    return format == PayloadFormat::Cbor ? "application/cbor" : "application/json";
+}
+
+PayloadFormat PayloadFormatOf(std::string_view body)
+{
+    if (!body.empty() && (static_cast<uint8_t>(body[0]) >> 5) == 5)
+        return PayloadFormat::Cbor;
+    return PayloadFormat::Json;
+}
+
+bool CborToJson(std::string_view cbor, std::string& json)
+{
+    nlohmann::json doc = nlohmann::json::from_cbor(cbor.begin(), cbor.end(), true, false);
+    if (doc.is_discarded())
+        return false;
+    json = doc.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    return true;
+}
+
+PayloadWriter::PayloadWriter(size_t reserve)
+{
+    out.reserve(reserve);
+}
+
+void PayloadWriter::Reset(PayloadFormat f)
+{
+    out.clear();
+    format = f;
+    depth = 0;
+    valid = true;
+    keyPending = false;
+}
+
+void PayloadWriter::BeforeValue()
+{
+    if (depth == 0)
+        return;
+    Level& level = stack[depth - 1];
+    if (level.object)
+    {
+        // La cle vient d'etre ecrite ; elle porte le separateur
+        valid = valid && keyPending;
+        keyPending = false;
+        return;
+    }
+    if (format == PayloadFormat::Json && level.written > 0)
+        out.push_back(',');
+    level.written++;
+}
+
+void PayloadWriter::Begin(size_t count, bool object)
+{
+    BeforeValue();
+    if (depth == MAX_DEPTH)
+    {
+        valid = false;
+        return;
+    }
+    stack[depth++] = {static_cast<uint32_t>(count), 0, object};
+    if (format == PayloadFormat::Json)
+        out.push_back(object ? '{' : '[');
+    else
+        CborHead(object ? 5 : 4, count);
+}
+
+void PayloadWriter::BeginObject(size_t fields)
+{
+    Begin(fields, true);
+}
+
+void PayloadWriter::BeginArray(size_t items)
+{
+    Begin(items, false);
+}
+
+void PayloadWriter::End()
+{
+    if (depth == 0 || keyPending)
+    {
+        valid = false;
+        return;
+    }
+    const Level& level = stack[--depth];
+    valid = valid && level.written == level.declared;
+    if (format == PayloadFormat::Json)
+        out.push_back(level.object ? '}' : ']');
+}
+
+void PayloadWriter::Key(std::string_view key)
+{
+    if (depth == 0 || !stack[depth - 1].object || keyPending)
+    {
+        valid = false;
+        return;
+    }
+    Level& level = stack[depth - 1];
+    if (format == PayloadFormat::Json)
+    {
+        if (level.written > 0)
+            out.push_back(',');
+        JsonString(key);
+        out.push_back(':');
+    }
+    else
+        CborText(key);
+    level.written++;
+    keyPending = true;
+}
+
+void PayloadWriter::Int(int64_t value)
+{
+    BeforeValue();
+    if (format == PayloadFormat::Json)
+    {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, res.ptr);
+    }
+    else if (value >= 0)
+        CborHead(0, static_cast<uint64_t>(value));
+    else
+        CborHead(1, static_cast<uint64_t>(-(value + 1)));
+}
+
+void PayloadWriter::Float(float value)
+{
+    if (!std::isfinite(value))
+    {
+        Null();
+        return;
+    }
+    BeforeValue();
+    if (format == PayloadFormat::Json)
+    {
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, res.ptr);
+        return;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    out.push_back(static_cast<char>(0xfa));
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>(bits >> shift));
+}
+
+void PayloadWriter::Bool(bool value)
+{
+    BeforeValue();
+    if (format == PayloadFormat::Json)
+        out.append(value ? "true" : "false");
+    else
+        out.push_back(static_cast<char>(value ? 0xf5 : 0xf4));
+}
+
+void PayloadWriter::Null()
+{
+    BeforeValue();
+    if (format == PayloadFormat::Json)
+        out.append("null");
+    else
+        out.push_back(static_cast<char>(0xf6));
+}
+
+void PayloadWriter::String(std::string_view value)
+{
+    BeforeValue();
+    if (format == PayloadFormat::Json)
+    {
+        JsonString(value);
+        return;
+    }
+    CborText(value);
+}
+
+void PayloadWriter::Base64(const uint8_t* data, size_t size)
+{
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    BeforeValue();
+    size_t length = (size + 2) / 3 * 4;
+    if (format == PayloadFormat::Json)
+        out.push_back('"');
+    else
+        CborHead(3, length);
+    size_t start = out.size();
+    out.resize(start + length);
+    char* p = &out[start];
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3)
+    {
+        uint32_t v = (uint32_t{data[i]} << 16) | (uint32_t{data[i + 1]} << 8) | data[i + 2];
+        *p++ = ALPHABET[v >> 18];
+        *p++ = ALPHABET[(v >> 12) & 0x3f];
+        *p++ = ALPHABET[(v >> 6) & 0x3f];
+        *p++ = ALPHABET[v & 0x3f];
+    }
+    if (i < size)
+    {
+        uint32_t v = uint32_t{data[i]} << 16;
+        if (i + 1 < size)
+            v |= uint32_t{data[i + 1]} << 8;
+        *p++ = ALPHABET[v >> 18];
+        *p++ = ALPHABET[(v >> 12) & 0x3f];
+        *p++ = i + 1 < size ? ALPHABET[(v >> 6) & 0x3f] : '=';
+        *p++ = '=';
+    }
+    if (format == PayloadFormat::Json)
+        out.push_back('"');
+}
+
+void PayloadWriter::Raw(std::string_view encoded)
+{
+    BeforeValue();
+    out.append(encoded.data(), encoded.size());
+}
+
+// Tete CBOR : type majeur sur 3 bits, valeur sur 5 bits ou dans 1 a 8
+// octets suivants (gros-boutiste).
+void PayloadWriter::CborHead(uint8_t major, uint64_t value)
+{
+    uint8_t type = static_cast<uint8_t>(major << 5);
+    if (value < 24)
+    {
+        out.push_back(static_cast<char>(type | value));
+        return;
+    }
+    int bytes = value <= 0xff ? 1 : value <= 0xffff ? 2 : value <= 0xffffffffull ? 4 : 8;
+    out.push_back(static_cast<char>(type | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27)));
+    for (int i = bytes - 1; i >= 0; --i)
+        out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void PayloadWriter::JsonString(std::string_view value)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(value.data());
+    out.push_back('"');
+    for (size_t i = 0; i < value.size();)
+    {
+        unsigned char u = p[i];
+        if (u == '"' || u == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(static_cast<char>(u));
+            i++;
+        }
+        else if (u < 0x20)
+        {
+            out.append("\\u00");
+            out.push_back(DIGITS[u >> 4]);
+            out.push_back(DIGITS[u & 0x0f]);
+            i++;
+        }
+        else if (u < 0x80)
+            out.push_back(value[i++]);
+        else if (size_t n = Utf8SequenceLength(p + i, value.size() - i))
+        {
+            out.append(value.data() + i, n);
+            i += n;
+        }
+        else
+        {
+            out.append(UTF8_REPLACEMENT.data(), UTF8_REPLACEMENT.size());
+            i++;
+        }
+    }
+    out.push_back('"');
+}
+
+// Chaine CBOR (type majeur 3), qui doit etre de l'UTF-8 valide : recopiee
+// telle quelle dans le cas courant, sinon reconstruite avec U+FFFD.
+void PayloadWriter::CborText(std::string_view value)
+{
+    if (Utf8Valid(value))
+    {
+        CborHead(3, value.size());
+        out.append(value.data(), value.size());
+        return;
+    }
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(value.data());
+    std::string text;
+    text.reserve(value.size() + 8);
+    for (size_t i = 0; i < value.size();)
+    {
+        if (size_t n = Utf8SequenceLength(p + i, value.size() - i))
+        {
+            text.append(value.data() + i, n);
+            i += n;
+        }
+        else
+        {
+            text.append(UTF8_REPLACEMENT.data(), UTF8_REPLACEMENT.size());
+            i++;
+        }
+    }
+    CborHead(3, text.size());
+    out.append(text);
+}
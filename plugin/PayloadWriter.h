@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Ecriture en flux des corps envoyes au bot, en JSON ou en CBOR (RFC 8949),
+// dans un tampon reserve une fois et reutilise d'un corps a l'autre : pas de
+// DOM intermediaire, pas de seconde copie du texte.
+//
+// Le nombre d'elements d'un objet ou d'un tableau est donne a l'ouverture
+// (CBOR a longueur definie) ; un compte faux, une cle hors objet ou un
+// depassement de profondeur rendent l'ecriture invalide (Valid()).
+//
+// Les flottants sont ecrits sur leur plus courte forme decimale exacte
+// (std::to_chars) en JSON et en float32 en CBOR ; NaN et l'infini valent null.
+// Dans les chaines, chaque octet qui n'appartient pas a un caractere UTF-8
+// valide est remplace par U+FFFD.
+enum class PayloadFormat : uint8_t
+{
+    Json,
+    Cbor
+};
+
+const char* PayloadFormatName(PayloadFormat format);
+const char* PayloadContentType(PayloadFormat format);
+// Reconnait un corps deja ecrit : un objet JSON commence par '{', une table
+// CBOR par un octet de type majeur 5.
+PayloadFormat PayloadFormatOf(std::string_view body);
+// Relit un corps CBOR et le reecrit en JSON (repli pour un bot sans CBOR).
+bool CborToJson(std::string_view cbor, std::string& json);
+
+class PayloadWriter
+{
+public:
+    static constexpr size_t DEFAULT_RESERVE = 32 * 1024;
+    static constexpr int MAX_DEPTH = 8;
+
+    explicit PayloadWriter(size_t reserve = DEFAULT_RESERVE);
+
+    // Vide le tampon sans rendre sa memoire.
+    void Reset(PayloadFormat format);
+    PayloadFormat Format() const { return format; }
+
+    void BeginObject(size_t fields);
+    void BeginArray(size_t items);
+    void End();
+    void Key(std::string_view key);
+
+    void Int(int64_t value);
+    void Float(float value);
+    void Bool(bool value);
+    void String(std::string_view value);
+    void Null();
+    // Octets ecrits en chaine base64 (RFC 4648), en JSON comme en CBOR.
+    void Base64(const uint8_t* data, size_t size);
+    // Valeur deja encodee dans le meme format (resultat journalise).
+    void Raw(std::string_view encoded);
+
+    bool Valid() const { return valid && depth == 0; }
+    const std::string& Data() const { return out; }
+
+private:
+    struct Level
+    {
+        uint32_t declared;
+        uint32_t written;
+        bool object;
+    };
+
+    void BeforeValue();
+    void Begin(size_t count, bool object);
+    void CborHead(uint8_t major, uint64_t value);
+    void JsonString(std::string_view value);
+    void CborText(std::string_view value);
+
+    std::string out;
+    PayloadFormat format = PayloadFormat::Json;
+    Level stack[MAX_DEPTH];
+    int depth = 0;
+    bool keyPending = false; // cle ecrite, valeur attendue
+    bool valid = true;
+};
@@ -0,0 +1,167 @@
+#include "PerfStats.h"
+#include <algorithm>
+#include <cstdio>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Rang du bit de poids fort (ns > 0)
+static int HighBit(uint64_t ns)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, ns);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(ns);
+#endif
+}
+
+const char* PerfHookName(int hook)
+{
+    static const char* const NAMES[PERF_HOOK_COUNT] = {
+        "tickStats", "hitBall", "boostCollected", "carDemolish",
+        "goalScored", "gameEnd", "upload", "poll"};
+    return hook >= 0 && hook < PERF_HOOK_COUNT ? NAMES[hook] : "?";
+}
+
+int LatencyCounts::Bucket(uint64_t ns)
+{
+    // Les SUB_BUCKETS premieres cases sont exactes, puis SUB_BUCKETS cases
+    // par puissance de deux
+    if (ns < SUB_BUCKETS)
+        return static_cast<int>(ns);
+    int exponent = HighBit(ns);
+    if (exponent > MAX_EXPONENT)
+        return BUCKETS - 1;
+    int sub = static_cast<int>(ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyCounts::BucketUpper(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return static_cast<uint64_t>(bucket);
+    int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    uint64_t width = uint64_t(1) << (exponent - SUB_BITS);
+    return ((SUB_BUCKETS + sub) << (exponent - SUB_BITS)) + width - 1;
+}
+
+uint64_t LatencyCounts::Percentile(double q) const
+{
+    if (count == 0)
+        return 0;
+    // Rang de la mesure cherchee, compte a partir de 1
+    uint64_t rank = static_cast<uint64_t>(q * count + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, count);
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b)
+    {
+        seen += buckets[b];
+        if (seen >= rank)
+            return std::min(BucketUpper(b), maxNs);
+    }
+    return maxNs;
+}
+
+void LatencyCounts::Subtract(const LatencyCounts& base)
+{
+    int last = -1;
+    for (int b = 0; b < BUCKETS; ++b)
+    {
+        // Un histogramme remis a zero entre-temps repart de rien
+        buckets[b] = buckets[b] >= base.buckets[b] ? buckets[b] - base.buckets[b] : buckets[b];
+        if (buckets[b] > 0)
+            last = b;
+    }
+    count = count >= base.count ? count - base.count : count;
+    if (last < 0)
+        maxNs = 0;
+    else if (last == Bucket(maxNs))
+        maxNs = std::min(maxNs, BucketUpper(last));
+    else
+        maxNs = BucketUpper(last);
+}
+
+void LatencyHistogram::Snapshot(LatencyCounts& out) const
+{
+    for (int b = 0; b < LatencyCounts::BUCKETS; ++b)
+        out.buckets[b] = buckets[b].load(std::memory_order_relaxed);
+    out.count = count.load(std::memory_order_relaxed);
+    out.maxNs = maxNs.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset()
+{
+    for (std::atomic<uint32_t>& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+void PerfStats::Reset()
+{
+    for (int hook = 0; hook < PERF_HOOK_COUNT; ++hook)
+    {
+        hooks[hook].Reset();
+        reported[hook] = LatencyCounts{};
+    }
+}
+
+std::string PerfStats::Describe(PerfHook hook) const
+{
+    LatencyCounts counts;
+    hooks[hook].Snapshot(counts);
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%-15s %8llu appels, p50 %9.1f us, p99 %9.1f us, max %9.1f us",
+                  PerfHookName(hook), static_cast<unsigned long long>(counts.count),
+                  counts.Percentile(0.5) / 1000.0, counts.Percentile(0.99) / 1000.0, counts.maxNs / 1000.0);
+    return buf;
+}
+
+void PerfStats::TakeReport(PerfReport& out)
+{
+    LatencyCounts counts;
+    for (int hook = 0; hook < PERF_HOOK_COUNT; ++hook)
+    {
+        hooks[hook].Snapshot(counts);
+        LatencyCounts interval = counts;
+        interval.Subtract(reported[hook]);
+        reported[hook] = counts;
+
+        PerfReport::Entry& entry = out.hooks[hook];
+        entry.count = interval.count;
+        entry.p50 = static_cast<float>(interval.Percentile(0.5) / 1000.0);
+        entry.p99 = static_cast<float>(interval.Percentile(0.99) / 1000.0);
+        entry.max = static_cast<float>(interval.maxNs / 1000.0);
+    }
+}
+
+void PerfReport::Write(PayloadWriter& out) const
+{
+    size_t used = 0;
+    for (const Entry& entry : hooks)
+        used += entry.count > 0;
+
+    out.BeginObject(used);
+    for (int hook = 0; hook < PERF_HOOK_COUNT; ++hook)
+    {
+        const Entry& entry = hooks[hook];
+        if (entry.count == 0)
+            continue;
+        out.Key(PerfHookName(hook));
+        out.BeginObject(4);
+        out.Key("count");
+        out.Int(static_cast<int64_t>(entry.count));
+        out.Key("p50");
+        out.Float(entry.p50);
+        out.Key("p99");
+        out.Float(entry.p99);
+        out.Key("max");
+        out.Float(entry.max);
+        out.End();
+    }
+    out.End();
+}
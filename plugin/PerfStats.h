@@ -0,0 +1,142 @@
+#pragma once
+#include "PayloadWriter.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Mesure du cout des hooks du jeu et des requetes reseau sur la machine du
+// joueur (mm_perf).
+//
+// Chaque chemin mesure a son histogramme de latence log-lineaire a cases
+// fixes : 8 cases par puissance de deux de nanosecondes, soit une erreur
+// relative d'au plus 12,5 %, de 1 ns a 34 s. Un enregistrement ne fait
+// qu'incrementer une case, sans allocation ni verrou ; chaque histogramme
+// n'a qu'un thread ecrivain et peut etre lu depuis un autre.
+
+enum PerfHook
+{
+    PERF_TICK_STATS,
+    PERF_HIT_BALL,
+    PERF_BOOST,
+    PERF_DEMOLISH,
+    PERF_GOAL,
+    PERF_GAME_END,
+    PERF_UPLOAD, // requete d'envoi (thread d'envoi)
+    PERF_POLL,   // requete /player (thread d'interrogation)
+    PERF_HOOK_COUNT
+};
+
+// Nom du chemin mesure, cle du payload et de mm_perf.
+const char* PerfHookName(int hook);
+
+// Copie non atomique d'un histogramme, pour les calculs.
+struct LatencyCounts
+{
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_EXPONENT = 35; // 2^35 ns = 34 s
+    static constexpr int BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+
+    uint32_t buckets[BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t maxNs = 0;
+
+    static int Bucket(uint64_t ns);
+    // Plus grande duree rangee dans la case
+    static uint64_t BucketUpper(int bucket);
+
+    // Duree sous laquelle tombe la part q des mesures (borne haute de la
+    // case, limitee au maximum), 0 sans mesure.
+    uint64_t Percentile(double q) const;
+    // Mesures faites depuis `base`, copie anterieure du meme histogramme ;
+    // le maximum devient la borne haute de la derniere case occupee.
+    void Subtract(const LatencyCounts& base);
+};
+
+class LatencyHistogram
+{
+public:
+    void Record(uint64_t ns)
+    {
+        Increment(buckets[LatencyCounts::Bucket(ns)]);
+        Increment(count);
+        if (ns > maxNs.load(std::memory_order_relaxed))
+            maxNs.store(ns, std::memory_order_relaxed);
+    }
+    void Snapshot(LatencyCounts& out) const;
+    // Depuis le thread ecrivain, ou quand il ne mesure pas.
+    void Reset();
+
+private:
+    // Un seul ecrivain : lecture puis ecriture, sans instruction verrouillee
+    template <typename T>
+    static void Increment(std::atomic<T>& value)
+    {
+        value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> buckets[LatencyCounts::BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+// Mesure la duree de la portee ; sans histogramme, ne fait rien.
+class PerfScope
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit PerfScope(LatencyHistogram* histogram)
+        : histogram(histogram), start(histogram ? Clock::now() : Clock::time_point{})
+    {
+    }
+    ~PerfScope()
+    {
+        if (histogram)
+            histogram->Record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    LatencyHistogram* histogram;
+    Clock::time_point start;
+};
+
+// Resume de chaque chemin sur un intervalle, en microsecondes.
+struct PerfReport
+{
+    struct Entry
+    {
+        uint64_t count = 0;
+        float p50 = 0.f;
+        float p99 = 0.f;
+        float max = 0.f;
+    };
+    Entry hooks[PERF_HOOK_COUNT];
+
+    // {"<chemin>": {"count", "p50", "p99", "max"}} pour les chemins appeles
+    void Write(PayloadWriter& out) const;
+};
+
+class PerfStats
+{
+public:
+    LatencyHistogram& Hook(PerfHook hook) { return hooks[hook]; }
+
+    // Remet tout a zero ; les threads reseau doivent etre au repos pour que
+    // leurs histogrammes le soient exactement.
+    void Reset();
+    // Une ligne lisible : appels, p50, p99 et maximum (mm_perf).
+    std::string Describe(PerfHook hook) const;
+
+    // Mesures faites depuis le rapport precedent : chacune n'est envoyee
+    // qu'une fois.
+    void TakeReport(PerfReport& out);
+
+private:
+    LatencyHistogram hooks[PERF_HOOK_COUNT];
+    LatencyCounts reported[PERF_HOOK_COUNT];
+};
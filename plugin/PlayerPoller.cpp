@@ -0,0 +1,264 @@
+#include "PlayerPoller.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <utility>
+
+PlayerPoller::~PlayerPoller()
+{
+    Stop();
+}
+
+void PlayerPoller::Start(const std::string& url, LogFn logFn, ResultFn resultFn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+    baseUrl = url;
+    log = std::move(logFn);
+    onResult = std::move(resultFn);
+    stopping = false;
+    running = true;
+    lastActivity = Clock::now();
+    thread = std::thread(&PlayerPoller::Run, this);
+}
+
+void PlayerPoller::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    running = false;
+}
+
+void PlayerPoller::SetPlayerId(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id == playerId)
+        return;
+    playerId = id;
+    forcePoll = true;
+    wake.notify_all();
+}
+
+void PlayerPoller::SetMode(Mode next)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (next == mode)
+        return;
+    mode = next;
+    wake.notify_all();
+}
+
+void PlayerPoller::NoteActivity()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    lastActivity = Clock::now();
+    wake.notify_all();
+}
+
+void PlayerPoller::PollNow()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    forcePoll = true;
+    lastActivity = Clock::now();
+    wake.notify_all();
+}
+
+std::string PlayerPoller::Summary()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::to_string(requests) + " requetes, " + std::to_string(notModified) + " sans changement (304), "
+        + std::to_string(errors) + " erreurs, " + std::to_string(bytesIn / 1024) + " Ko recus";
+}
+
+// Appele sous mutex
+PlayerPoller::Clock::duration PlayerPoller::NextDelay()
+{
+    Clock::duration interval = SLOW_INTERVAL;
+    if (mode == Mode::Normal && (serverQueued || Clock::now() - lastActivity < ACTIVITY_WINDOW))
+        interval = FAST_INTERVAL;
+    if (errorStreak == 0)
+        return interval;
+
+    // Backoff exponentiel, tire entre la moitie et la totalite du palier pour
+    // ne pas synchroniser les clients apres une panne du serveur.
+    auto step = std::min<Clock::duration>(FAST_INTERVAL * (1 << std::min(errorStreak, 6)), MAX_BACKOFF);
+    std::uniform_real_distribution<double> jitter(0.5, 1.0);
+    auto backoff = std::chrono::duration_cast<Clock::duration>(step * jitter(rng));
+    return std::max(interval, backoff);
+}
+
+void PlayerPoller::Run()
+{
+    CURL* curl = curl_easy_init();
+    if (!curl)
+        Log("[API] Initialisation de curl impossible, interrogation desactivee");
+
+    Clock::time_point next = Clock::now();
+    for (;;)
+    {
+        bool force = false;
+        std::string id;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && !forcePoll)
+            {
+                if (mode == Mode::Paused)
+                {
+                    wake.wait(lock);
+                    continue;
+                }
+                if (Clock::now() >= next)
+                    break;
+                wake.wait_until(lock, next);
+            }
+            if (stopping)
+                break;
+            force = forcePoll;
+            forcePoll = false;
+            id = playerId;
+        }
+
+        if (curl && !id.empty())
+        {
+            try
+            {
+                Poll(curl, id, force);
+            }
+            catch (const std::exception& e)
+            {
+                Log(std::string("[API] Exception: ") + e.what());
+            }
+            catch (...)
+            {
+                Log("[API] Exception inconnue lors de la requete");
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        next = Clock::now() + NextDelay();
+    }
+
+    if (curl)
+        curl_easy_cleanup(curl);
+}
+
+void PlayerPoller::Poll(CURL* curl, const std::string& id, bool force)
+{
+    char* escaped = curl_easy_escape(curl, id.c_str(), static_cast<int>(id.size()));
+    std::string url = baseUrl + "/player?player_id=" + (escaped ? escaped : "");
+    curl_free(escaped);
+
+    struct curl_slist* headers_list = nullptr;
+    if (!force && !etag.empty())
+    {
+        std::string header = "If-None-Match: " + etag;
+        headers_list = curl_slist_append(headers_list, header.c_str());
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
+
+    std::string response;
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                     +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+                         static_cast<std::string*>(userdata)->append(ptr, size * nmemb);
+                         return size * nmemb;
+                     });
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+
+    std::string newEtag;
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION,
+                     +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+                         size_t len = size * nmemb;
+                         std::string line(ptr, len);
+                         if (line.size() > 5 && std::equal(line.begin(), line.begin() + 5, "etag:",
+                                                           [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; }))
+                         {
+                             size_t start = line.find_first_not_of(" \t", 5);
+                             size_t end = line.find_last_not_of(" \t\r\n");
+                             if (start != std::string::npos && end >= start)
+                                 *static_cast<std::string*>(userdata) = line.substr(start, end - start + 1);
+                         }
+                         return len;
+                     });
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &newEtag);
+
+    CURLcode res;
+    {
+        PerfScope scope(latency);
+        res = curl_easy_perform(curl);
+    }
+    long status_code = 0;
+    curl_off_t downloaded = 0;
+    long headerBytes = 0;
+    if (res == CURLE_OK)
+    {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+        curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &headerBytes);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, nullptr);
+    curl_slist_free_all(headers_list);
+
+    bool failed = res != CURLE_OK || (status_code != 200 && status_code != 304);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests++;
+        bytesIn += static_cast<uint64_t>(downloaded) + static_cast<uint64_t>(headerBytes);
+        if (status_code == 304)
+            notModified++;
+        if (failed)
+            errors++;
+        errorStreak = failed ? errorStreak + 1 : 0;
+    }
+
+    if (res != CURLE_OK)
+    {
+        Log(std::string("[API] Erreur reseau : ") + curl_easy_strerror(res));
+        return;
+    }
+    if (status_code == 304)
+    {
+        if (debugEnabled)
+            Log("[API] Aucun changement (304)");
+        return;
+    }
+    if (status_code != 200)
+    {
+        Log("[API] Erreur HTTP " + std::to_string(status_code) + ": " + response);
+        return;
+    }
+
+    etag = newEtag;
+    auto instr = nlohmann::json::parse(response, nullptr, false);
+    if (!instr.is_object())
+    {
+        Log("[API] Réponse JSON vide ou invalide: " + response);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        serverQueued = instr.value("queued", false);
+        lastActivity = Clock::now();
+    }
+    if (onResult)
+        onResult(instr);
+}
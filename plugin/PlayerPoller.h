@@ -0,0 +1,106 @@
+#pragma once
+#include "PerfStats.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+typedef void CURL;
+
+// Interrogation periodique de l'endpoint /player sur un thread dedie.
+//
+// Une seule poignee curl est gardee ouverte (keep-alive). Chaque requete
+// renvoie l'ETag recu dans If-None-Match : tant que les identifiants de
+// partie n'ont pas change, le serveur repond 304 sans corps et rien n'est
+// transmis au plugin. L'intervalle suit l'etat fixe par le plugin :
+//  - Paused : aucune requete (partie en ligne, match en cours de creation) ;
+//  - Slow   : toutes les SLOW_INTERVAL (freeplay, entrainement) ;
+//  - Normal : toutes les FAST_INTERVAL si le serveur signale le joueur en
+//             file ("queued": true) ou peu apres une activite (chargement,
+//             fin de match, nouvelle reponse), SLOW_INTERVAL sinon.
+// Les erreurs repoussent la requete suivante (backoff exponentiel aleatoire).
+class PlayerPoller
+{
+public:
+    enum class Mode
+    {
+        Paused,
+        Slow,
+        Normal
+    };
+
+    using LogFn = std::function<void(const std::string&)>;
+    // Appele sur le thread d'interrogation a chaque nouvelle reponse (200).
+    using ResultFn = std::function<void(const nlohmann::json&)>;
+
+    static constexpr std::chrono::seconds FAST_INTERVAL{3};
+    static constexpr std::chrono::seconds SLOW_INTERVAL{15};
+    static constexpr std::chrono::seconds ACTIVITY_WINDOW{300};
+    static constexpr std::chrono::seconds MAX_BACKOFF{120};
+
+    ~PlayerPoller();
+
+    void Start(const std::string& baseUrl, LogFn logFn, ResultFn resultFn);
+    void Stop();
+
+    void SetPlayerId(const std::string& id);
+    void SetMode(Mode mode);
+    // Repasse en interrogation rapide pour ACTIVITY_WINDOW.
+    void NoteActivity();
+    // Requete immediate sans If-None-Match.
+    void PollNow();
+
+    void SetDebug(bool enabled) { debugEnabled = enabled; }
+    // A appeler avant Start. Duree de chaque requete, mesuree sur le thread
+    // d'interrogation.
+    void SetLatency(LatencyHistogram* histogram) { latency = histogram; }
+    // Bilan des requetes depuis le demarrage, pour le journal
+    std::string Summary();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Run();
+    Clock::duration NextDelay();
+    void Poll(CURL* curl, const std::string& id, bool force);
+    void Log(const std::string& msg) const
+    {
+        if (log)
+            log(msg);
+    }
+
+    std::string baseUrl;
+    LogFn log;
+    ResultFn onResult;
+    // Ecrit par la commande mm_debug, lu par le thread reseau
+    std::atomic<bool> debugEnabled{false};
+    LatencyHistogram* latency = nullptr;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;
+    bool stopping = false;
+    bool forcePoll = false;
+    Mode mode = Mode::Paused;
+    std::string playerId;
+    Clock::time_point lastActivity;
+
+    // Etat propre au thread d'interrogation
+    std::string etag;
+    bool serverQueued = false;
+    int errorStreak = 0;
+    std::mt19937 rng{std::random_device{}()};
+
+    // Compteurs (thread d'interrogation, lus sous mutex)
+    uint64_t requests = 0;
+    uint64_t notModified = 0;
+    uint64_t errors = 0;
+    uint64_t bytesIn = 0;
+};
@@ -0,0 +1,303 @@
+#include "PushClient.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+struct PushStreamContext
+{
+    PushClient* self;
+    CURL* curl;
+};
+
+PushClient::~PushClient()
+{
+    Stop();
+}
+
+void PushClient::Start(const std::string& url, LogFn logFn, ResultFn resultFn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+    baseUrl = url;
+    log = std::move(logFn);
+    onResult = std::move(resultFn);
+    stopping = false;
+    running = true;
+    thread = std::thread(&PushClient::Run, this);
+}
+
+void PushClient::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    running = false;
+    connected = false;
+}
+
+void PushClient::SetPlayerId(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id == playerId)
+        return;
+    playerId = id;
+    reconnect = true;
+    wake.notify_all();
+}
+
+std::string PushClient::Summary()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::to_string(connects) + " connexions, " + std::to_string(events) + " attributions recues, "
+        + std::to_string(drops) + " coupures";
+}
+
+void PushClient::Run()
+{
+    CURL* curl = curl_easy_init();
+    if (!curl)
+        Log("[Push] Initialisation de curl impossible, flux desactive");
+
+    int failures = 0;
+    for (;;)
+    {
+        std::string id;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, curl] { return stopping || (curl && !playerId.empty()); });
+            if (stopping)
+                break;
+            id = playerId;
+            reconnect = false;
+        }
+
+        Clock::time_point opened = Clock::now();
+        long status = 0;
+        try
+        {
+            status = Stream(curl, id);
+        }
+        catch (const std::exception& e)
+        {
+            Log(std::string("[Push] Exception: ") + e.what());
+        }
+        bool wasConnected = connected.exchange(false);
+
+        Clock::duration delay;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping)
+                break;
+            if (reconnect)
+            {
+                failures = 0;
+                continue;
+            }
+            if (wasConnected)
+                drops++;
+        }
+
+        if (status >= 400 && status < 500)
+        {
+            delay = REJECTED_BACKOFF;
+            if (failures++ == 0)
+                Log("[Push] Flux refuse par le serveur (HTTP " + std::to_string(status) + "), interrogation seule");
+        }
+        else
+        {
+            // Une connexion qui a tenu remet le backoff a zero
+            if (gotData && Clock::now() - opened > std::chrono::seconds(30))
+                failures = 0;
+            auto step = std::min<Clock::duration>(MIN_BACKOFF * (1 << std::min(failures, 6)), MAX_BACKOFF);
+            std::uniform_real_distribution<double> jitter(0.5, 1.0);
+            delay = std::chrono::duration_cast<Clock::duration>(step * jitter(rng));
+            if (failures++ == 0 || debugEnabled)
+                Log("[Push] Flux ferme, reconnexion dans "
+                    + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(delay).count()) + " ms");
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, delay, [this] { return stopping || reconnect; });
+        if (stopping)
+            break;
+        if (reconnect)
+            failures = 0;
+    }
+
+    if (curl)
+        curl_easy_cleanup(curl);
+}
+
+long PushClient::Stream(CURL* curl, const std::string& id)
+{
+    lineBuffer.clear();
+    eventName.clear();
+    eventData.clear();
+    eventId.clear();
+    gotData = false;
+
+    char* escaped = curl_easy_escape(curl, id.c_str(), static_cast<int>(id.size()));
+    std::string url = baseUrl + "/player/stream?player_id=" + (escaped ? escaped : "");
+    curl_free(escaped);
+
+    struct curl_slist* headers_list = nullptr;
+    headers_list = curl_slist_append(headers_list, "Accept: text/event-stream");
+    headers_list = curl_slist_append(headers_list, "Cache-Control: no-cache");
+    if (!lastEventId.empty())
+    {
+        std::string header = "Last-Event-ID: " + lastEventId;
+        headers_list = curl_slist_append(headers_list, header.c_str());
+    }
+
+    PushStreamContext ctx{this, curl};
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    // Pas de duree maximale : le flux reste ouvert, seul le silence le coupe
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, IDLE_TIMEOUT);
+
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ctx);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                     +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+                         auto* c = static_cast<PushStreamContext*>(userdata);
+                         long code = 0;
+                         curl_easy_getinfo(c->curl, CURLINFO_RESPONSE_CODE, &code);
+                         if (code != 200)
+                             return size * nmemb;
+                         if (!c->self->connected.exchange(true))
+                         {
+                             {
+                                 std::lock_guard<std::mutex> lock(c->self->mutex);
+                                 c->self->connects++;
+                             }
+                             c->self->Log("[Push] Flux ouvert");
+                         }
+                         c->self->gotData = true;
+                         c->self->Feed(ptr, size * nmemb);
+                         return size * nmemb;
+                     });
+
+    // Interrompt le flux a l'arret du plugin ou au changement de joueur
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION,
+                     +[](void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) -> int {
+                         auto* self = static_cast<PushClient*>(userdata);
+                         std::lock_guard<std::mutex> lock(self->mutex);
+                         return self->stopping || self->reconnect ? 1 : 0;
+                     });
+
+    CURLcode res = curl_easy_perform(curl);
+    long status_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    curl_slist_free_all(headers_list);
+
+    bool aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = stopping || reconnect;
+    }
+    if (aborted)
+        return status_code;
+    if (connected.load())
+        Log(std::string("[Push] Flux interrompu : ") + (res == CURLE_OK ? "fermeture par le serveur" : curl_easy_strerror(res)));
+    else if (debugEnabled && res != CURLE_OK)
+        Log(std::string("[Push] Connexion impossible : ") + curl_easy_strerror(res));
+    return status_code;
+}
+
+// Decoupe le flux en lignes ; une ligne vide termine l'evenement.
+void PushClient::Feed(const char* data, size_t size)
+{
+    lineBuffer.append(data, size);
+    size_t start = 0;
+    for (;;)
+    {
+        size_t end = lineBuffer.find('\n', start);
+        if (end == std::string::npos)
+            break;
+        std::string line = lineBuffer.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty())
+        {
+            Dispatch();
+            continue;
+        }
+        if (line[0] == ':') // commentaire (battement de coeur)
+            continue;
+        size_t colon = line.find(':');
+        std::string field = line.substr(0, colon);
+        std::string value;
+        if (colon != std::string::npos)
+        {
+            value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ')
+                value.erase(0, 1);
+        }
+        if (field == "event")
+            eventName = value;
+        else if (field == "data")
+        {
+            if (!eventData.empty())
+                eventData += '\n';
+            eventData += value;
+        }
+        else if (field == "id")
+            eventId = value;
+    }
+    lineBuffer.erase(0, start);
+}
+
+void PushClient::Dispatch()
+{
+    std::string name = std::move(eventName);
+    std::string payload = std::move(eventData);
+    eventName.clear();
+    eventData.clear();
+    if (!eventId.empty())
+        lastEventId = eventId;
+    eventId.clear();
+
+    if (name != "assignment" || payload.empty())
+        return;
+    auto instr = nlohmann::json::parse(payload, nullptr, false);
+    if (!instr.is_object())
+    {
+        Log("[Push] Attribution invalide: " + payload);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events++;
+    }
+    if (debugEnabled)
+        Log("[Push] Attribution recue (id " + lastEventId + ")");
+    try
+    {
+        if (onResult)
+            onResult(instr);
+    }
+    catch (const std::exception& e)
+    {
+        Log(std::string("[Push] Exception: ") + e.what());
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+typedef void CURL;
+
+// Connexion permanente au flux GET /player/stream du bot (Server-Sent Events).
+//
+// Le bot pousse chaque nouvelle attribution (evenement "assignment", meme
+// JSON que /player) des sa creation : plus besoin d'attendre la requete
+// suivante du PlayerPoller. Tant que le flux est ouvert, le plugin suspend
+// l'interrogation ; si la connexion tombe, il la rouvre avec un backoff
+// exponentiel aleatoire et l'interrogation reprend en attendant.
+// L'identifiant du dernier evenement recu est renvoye a la reconnexion
+// (Last-Event-ID) pour ne pas rejouer une attribution deja traitee.
+class PushClient
+{
+public:
+    using LogFn = std::function<void(const std::string&)>;
+    // Appele sur le thread du flux pour chaque attribution recue.
+    using ResultFn = std::function<void(const nlohmann::json&)>;
+
+    static constexpr std::chrono::seconds MIN_BACKOFF{1};
+    static constexpr std::chrono::seconds MAX_BACKOFF{60};
+    // Un flux refuse par le serveur (404 : bot sans /player/stream, 4xx)
+    // n'est retente qu'a ce rythme.
+    static constexpr std::chrono::seconds REJECTED_BACKOFF{300};
+    // Sans octet recu pendant ce delai (le bot envoie un commentaire toutes
+    // les 25 s), la connexion est consideree comme morte.
+    static constexpr long IDLE_TIMEOUT = 60;
+
+    ~PushClient();
+
+    void Start(const std::string& baseUrl, LogFn logFn, ResultFn resultFn);
+    void Stop();
+
+    // Un changement d'identifiant rouvre le flux.
+    void SetPlayerId(const std::string& id);
+    // Identifiant de la derniere attribution traitee par le plugin, envoye a
+    // la premiere connexion. A appeler avant Start.
+    void SetLastEventId(const std::string& id) { lastEventId = id; }
+    bool Connected() const { return connected.load(); }
+
+    void SetDebug(bool enabled) { debugEnabled = enabled; }
+    std::string Summary();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Run();
+    // Renvoie le code HTTP (0 si la connexion a echoue).
+    long Stream(CURL* curl, const std::string& id);
+    void Feed(const char* data, size_t size);
+    void Dispatch();
+    void Log(const std::string& msg) const
+    {
+        if (log)
+            log(msg);
+    }
+
+    std::string baseUrl;
+    LogFn log;
+    ResultFn onResult;
+    // Ecrit par la commande mm_debug, lu par le thread reseau
+    std::atomic<bool> debugEnabled{false};
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;
+    bool stopping = false;
+    bool reconnect = false;
+    std::string playerId;
+    std::atomic<bool> connected{false};
+
+    // Etat propre au thread du flux
+    std::string lineBuffer;
+    std::string eventName;
+    std::string eventData;
+    std::string eventId;
+    std::string lastEventId;
+    bool gotData = false;
+    std::mt19937 rng{std::random_device{}()};
+
+    // Compteurs (thread du flux, lus sous mutex)
+    uint64_t connects = 0;
+    uint64_t events = 0;
+    uint64_t drops = 0;
+};
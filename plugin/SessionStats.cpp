@@ -0,0 +1,134 @@
+#include "SessionStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void RunningStat::Add(float value, float alpha)
+{
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+    if (count == 1)
+    {
+        ewma = min = max = value;
+        return;
+    }
+    ewma += alpha * (value - ewma);
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+float RunningStat::StdDev() const
+{
+    return count > 1 ? static_cast<float>(std::sqrt(m2 / (count - 1))) : 0.f;
+}
+
+const char* SessionMetricName(int metric)
+{
+    static const char* const NAMES[SESSION_METRIC_COUNT] = {
+        "xg", "rotationQuality", "boostEfficiency", "saves",
+        "clearances", "defensiveChallenges", "blocks", "clutchSaves"};
+    return metric >= 0 && metric < SESSION_METRIC_COUNT ? NAMES[metric] : "?";
+}
+
+void SessionStats::Reset()
+{
+    players.clear();
+    matches = 0;
+}
+
+const SessionPlayer* SessionStats::Find(const std::string& uid, const std::string& name) const
+{
+    for (const SessionPlayer& p : players)
+    {
+        if (uid.empty() ? p.uid.empty() && p.name == name : p.uid == uid)
+            return &p;
+    }
+    return nullptr;
+}
+
+SessionPlayer* SessionStats::FindOrAdd(const std::string& uid, const std::string& name)
+{
+    if (const SessionPlayer* found = Find(uid, name))
+        return const_cast<SessionPlayer*>(found);
+    if (players.size() >= MAX_PLAYERS)
+        return nullptr;
+    if (players.capacity() == 0)
+        players.reserve(MAX_PLAYERS);
+    players.push_back(SessionPlayer{});
+    players.back().uid = uid;
+    players.back().name = name;
+    return &players.back();
+}
+
+void SessionStats::AddMatch(const MatchAnalytics& analytics, const MatchSummary& summary)
+{
+    matches++;
+    const PlayerRegistry& registry = analytics.Registry();
+    for (const ScoreboardLine& line : summary.players)
+    {
+        const PlayerStats* ps = analytics.Stats(line.slot);
+        if (!ps)
+            continue;
+        SessionPlayer* player = FindOrAdd(registry.entries[line.slot].uid, line.name);
+        if (!player)
+            continue;
+        // Le pseudo peut changer d'un match a l'autre
+        player->name = line.name;
+        player->matches++;
+
+        RunningStat* m = player->metrics;
+        m[SESSION_XG].Add(ps->ExpectedGoals(), EWMA_ALPHA);
+        m[SESSION_ROTATION].Add(analytics.RotationQuality(*ps, summary.totalGameTime), EWMA_ALPHA);
+        if (ps->boostPickups > 0)
+            m[SESSION_BOOST_EFFICIENCY].Add(1.f - static_cast<float>(ps->wastedBoosts) / ps->boostPickups, EWMA_ALPHA);
+        m[SESSION_SAVES].Add(static_cast<float>(line.saves), EWMA_ALPHA);
+        m[SESSION_CLEARANCES].Add(static_cast<float>(ps->clearances), EWMA_ALPHA);
+        m[SESSION_CHALLENGES].Add(static_cast<float>(ps->challengesWon), EWMA_ALPHA);
+        m[SESSION_BLOCKS].Add(static_cast<float>(ps->blocks), EWMA_ALPHA);
+        m[SESSION_CLUTCH_SAVES].Add(static_cast<float>(ps->clutchSaves), EWMA_ALPHA);
+    }
+}
+
+void SessionStats::WritePlayer(const SessionPlayer& player, PayloadWriter& out)
+{
+    size_t fields = 1;
+    for (const RunningStat& s : player.metrics)
+        fields += s.count > 0;
+
+    out.BeginObject(fields);
+    out.Key("matches");
+    out.Int(player.matches);
+    for (int metric = 0; metric < SESSION_METRIC_COUNT; ++metric)
+    {
+        const RunningStat& s = player.metrics[metric];
+        if (s.count == 0)
+            continue;
+        out.Key(SessionMetricName(metric));
+        out.BeginArray(5);
+        out.Float(static_cast<float>(s.mean));
+        out.Float(s.StdDev());
+        out.Float(s.ewma);
+        out.Float(s.min);
+        out.Float(s.max);
+        out.End();
+    }
+    out.End();
+}
+
+std::string SessionStats::Describe(const SessionPlayer& player)
+{
+    const RunningStat& xg = player.metrics[SESSION_XG];
+    const RunningStat& rot = player.metrics[SESSION_ROTATION];
+    const RunningStat& boost = player.metrics[SESSION_BOOST_EFFICIENCY];
+    const RunningStat& saves = player.metrics[SESSION_SAVES];
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "%s : %d match(s), xG %.2f +/- %.2f (forme %.2f, %.2f a %.2f), rotation %.0f%% (forme %.0f%%), "
+                  "boost utile %.0f%%, arrets %.1f, degagements %.1f",
+                  player.name.c_str(), player.matches, xg.mean, xg.StdDev(), xg.ewma, xg.min, xg.max,
+                  rot.mean * 100.0, rot.ewma * 100.f, boost.mean * 100.0, saves.mean,
+                  player.metrics[SESSION_CLEARANCES].mean);
+    return buf;
+}
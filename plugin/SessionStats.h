@@ -0,0 +1,78 @@
+#pragma once
+#include "MatchAnalytics.h"
+#include "PayloadWriter.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Statistiques de session : chaque match termine est replie dans des
+// agregats glissants par joueur, tenus en memoire tant que le plugin est
+// charge. Chaque indicateur garde sa moyenne et sa variance (Welford), une
+// moyenne exponentielle (forme recente) et ses bornes ; un match coute O(1)
+// par indicateur.
+
+// Moyenne et variance de Welford, moyenne exponentielle et bornes.
+struct RunningStat
+{
+    uint32_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    float ewma = 0.f;
+    float min = 0.f;
+    float max = 0.f;
+
+    void Add(float value, float alpha);
+    float StdDev() const;
+};
+
+enum SessionMetric
+{
+    SESSION_XG,
+    SESSION_ROTATION,
+    SESSION_BOOST_EFFICIENCY, // part des ramassages de boost non gaspilles
+    SESSION_SAVES,
+    SESSION_CLEARANCES,
+    SESSION_CHALLENGES,
+    SESSION_BLOCKS,
+    SESSION_CLUTCH_SAVES,
+    SESSION_METRIC_COUNT
+};
+
+// Nom de l'indicateur, identique a la cle du payload de fin de match.
+const char* SessionMetricName(int metric);
+
+struct SessionPlayer
+{
+    std::string uid; // vide : joueur reconnu a son nom
+    std::string name;
+    int matches = 0;
+    RunningStat metrics[SESSION_METRIC_COUNT];
+};
+
+class SessionStats
+{
+public:
+    static constexpr size_t MAX_PLAYERS = 64;
+    // Poids du dernier match dans la moyenne exponentielle
+    static constexpr float EWMA_ALPHA = 0.3f;
+
+    void Reset();
+    // Ajoute le match termine ; les joueurs absents du registre sont ignores.
+    void AddMatch(const MatchAnalytics& analytics, const MatchSummary& summary);
+
+    int Matches() const { return matches; }
+    const std::vector<SessionPlayer>& Players() const { return players; }
+    const SessionPlayer* Find(const std::string& uid, const std::string& name) const;
+
+    // Resume compact d'un joueur : {"matches": n, "<indicateur>":
+    // [moyenne, ecart-type, forme, min, max], ...}
+    static void WritePlayer(const SessionPlayer& player, PayloadWriter& out);
+    // Une ligne lisible par joueur (mm_session_stats).
+    static std::string Describe(const SessionPlayer& player);
+
+private:
+    SessionPlayer* FindOrAdd(const std::string& uid, const std::string& name);
+
+    std::vector<SessionPlayer> players;
+    int matches = 0;
+};
@@ -0,0 +1,276 @@
+#include "Sha256.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SHA_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static const uint32_t SHA256_INIT[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+static const uint8_t IPAD = 0x36;
+static const uint8_t OPAD = 0x5c;
+
+#ifdef SHA_X86
+
+// SHA (leaf 7, EBX bit 29) ainsi que SSSE3 et SSE4.1 utilises par le noyau
+static bool CpuHasShaNi()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool sse = (info[2] & (1 << 9)) != 0 && (info[2] & (1 << 19)) != 0;
+    __cpuidex(info, 7, 0);
+    return sse && (info[1] & (1 << 29)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    bool sse = (ecx & (1u << 9)) != 0 && (ecx & (1u << 19)) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return sse && (ebx & (1u << 29)) != 0;
+#endif
+}
+
+#endif // SHA_X86
+
+Sha256Kernel Sha256BestKernel()
+{
+#ifdef SHA_X86
+    static const Sha256Kernel best = CpuHasShaNi() ? Sha256Kernel::ShaNi : Sha256Kernel::Scalar;
+    return best;
+#else
+    return Sha256Kernel::Scalar;
+#endif
+}
+
+const char* Sha256KernelName(Sha256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Sha256Kernel::Scalar: return "scalaire";
+    case Sha256Kernel::ShaNi: return "sha-ni";
+    }
+    return "?";
+}
+
+std::string ToHex(const uint8_t* data, size_t size)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string out(size * 2, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[2 * i] = DIGITS[data[i] >> 4];
+        out[2 * i + 1] = DIGITS[data[i] & 0x0f];
+    }
+    return out;
+}
+
+static inline uint32_t Rotr(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t LoadBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+        | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+static inline void StoreBE32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+static void CompressScalar(uint32_t state[8], const uint8_t* blocks, size_t count)
+{
+    uint32_t w[64];
+    for (; count > 0; --count, blocks += Sha256::BLOCK_SIZE)
+    {
+        for (int i = 0; i < 16; ++i)
+            w[i] = LoadBE32(blocks + 4 * i);
+        for (int i = 16; i < 64; ++i)
+        {
+            uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i)
+        {
+            uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+            uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+Sha256::Sha256(Sha256Kernel k) : kernel(k)
+{
+#ifdef SHA_X86
+    if (kernel == Sha256Kernel::ShaNi && Sha256BestKernel() != Sha256Kernel::ShaNi)
+        kernel = Sha256Kernel::Scalar;
+#else
+    kernel = Sha256Kernel::Scalar;
+#endif
+    Reset();
+}
+
+void Sha256::Reset()
+{
+    std::memcpy(state, SHA256_INIT, sizeof(state));
+    length = 0;
+    buffered = 0;
+}
+
+void Sha256::Compress(const uint8_t* blocks, size_t count)
+{
+#ifdef SHA_X86
+    if (kernel == Sha256Kernel::ShaNi)
+    {
+        Sha256CompressShaNi(state, blocks, count);
+        return;
+    }
+#endif
+    CompressScalar(state, blocks, count);
+}
+
+void Sha256::Update(const void* data, size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    length += size;
+    if (buffered > 0)
+    {
+        size_t take = std::min(BLOCK_SIZE - buffered, size);
+        std::memcpy(buffer + buffered, p, take);
+        buffered += take;
+        p += take;
+        size -= take;
+        if (buffered < BLOCK_SIZE)
+            return;
+        Compress(buffer, 1);
+        buffered = 0;
+    }
+    // Blocs complets directement depuis la source, sans copie
+    size_t blocks = size / BLOCK_SIZE;
+    if (blocks > 0)
+    {
+        Compress(p, blocks);
+        p += blocks * BLOCK_SIZE;
+        size -= blocks * BLOCK_SIZE;
+    }
+    if (size > 0)
+    {
+        std::memcpy(buffer, p, size);
+        buffered = size;
+    }
+}
+
+void Sha256::Final(uint8_t out[DIGEST_SIZE])
+{
+    uint64_t bits = length * 8;
+    uint8_t pad[BLOCK_SIZE * 2] = {0x80};
+    // 0x80, des zeros, puis la longueur en bits sur 8 octets (gros-boutiste)
+    size_t padSize = (buffered < BLOCK_SIZE - 8 ? BLOCK_SIZE : 2 * BLOCK_SIZE) - buffered;
+    for (int i = 0; i < 8; ++i)
+        pad[padSize - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+    Update(pad, padSize);
+    for (int i = 0; i < 8; ++i)
+        StoreBE32(out + 4 * i, state[i]);
+}
+
+HmacSha256::HmacSha256(const std::string& key, Sha256Kernel k)
+    : kernel(k), inner(k), outer(k), current(k), keyed(!key.empty())
+{
+    kernel = inner.Kernel();
+
+    // Cle plus longue qu'un bloc : remplacee par son empreinte (RFC 2104)
+    uint8_t block[Sha256::BLOCK_SIZE] = {};
+    if (key.size() > Sha256::BLOCK_SIZE)
+    {
+        Sha256 hash(kernel);
+        hash.Update(key);
+        hash.Final(block);
+    }
+    else
+    {
+        std::memcpy(block, key.data(), key.size());
+    }
+
+    uint8_t pad[Sha256::BLOCK_SIZE];
+    for (size_t i = 0; i < Sha256::BLOCK_SIZE; ++i)
+        pad[i] = block[i] ^ IPAD;
+    inner.Update(pad, sizeof(pad));
+    for (size_t i = 0; i < Sha256::BLOCK_SIZE; ++i)
+        pad[i] = block[i] ^ OPAD;
+    outer.Update(pad, sizeof(pad));
+    current = inner;
+}
+
+std::string HmacSha256::Finish(Sha256& hash) const
+{
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    hash.Final(digest);
+    Sha256 out = outer;
+    out.Update(digest, sizeof(digest));
+    out.Final(digest);
+    return ToHex(digest, sizeof(digest));
+}
+
+std::string HmacSha256::HexDigest()
+{
+    std::string hex = Finish(current);
+    current = inner;
+    return hex;
+}
+
+std::string HmacSha256::Sign(const void* data, size_t size) const
+{
+    Sha256 hash = inner;
+    hash.Update(data, size);
+    return Finish(hash);
+}
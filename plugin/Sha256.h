@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// SHA-256 (FIPS 180-4) et HMAC-SHA256 (RFC 2104) portables, sans API
+// systeme : la signature des envois (en-tete x-signature) se calcule et se
+// teste aussi hors Windows.
+//
+// La fonction de compression existe en deux versions : scalaire, et SHA-NI
+// (instructions SHA des processeurs x86) choisie a l'execution si le
+// processeur les possede. Les deux donnent le meme resultat, bit a bit.
+
+enum class Sha256Kernel
+{
+    Scalar,
+    ShaNi
+};
+
+// Meilleure version disponible sur le processeur courant.
+Sha256Kernel Sha256BestKernel();
+const char* Sha256KernelName(Sha256Kernel kernel);
+
+// Hexadecimal minuscule, par table.
+std::string ToHex(const uint8_t* data, size_t size);
+
+class Sha256
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    explicit Sha256(Sha256Kernel kernel = Sha256BestKernel());
+
+    Sha256Kernel Kernel() const { return kernel; }
+    void Reset();
+    void Update(const void* data, size_t size);
+    void Update(const std::string& data) { Update(data.data(), data.size()); }
+    // Termine le calcul ; l'objet doit etre remis a zero avant de resservir.
+    void Final(uint8_t out[DIGEST_SIZE]);
+
+private:
+    void Compress(const uint8_t* blocks, size_t count);
+
+    uint32_t state[8];
+    uint64_t length = 0; // octets recus
+    uint8_t buffer[BLOCK_SIZE];
+    size_t buffered = 0;
+    Sha256Kernel kernel;
+};
+
+// Signataire HMAC-SHA256 cree une fois par cle : les etats internes apres
+// les blocs cle ^ ipad et cle ^ opad sont precalcules, chaque signature
+// repart d'une copie et ne hache donc que le message.
+class HmacSha256
+{
+public:
+    HmacSha256() = default; // sans cle : HasKey() est faux
+    explicit HmacSha256(const std::string& key, Sha256Kernel kernel = Sha256BestKernel());
+
+    bool HasKey() const { return keyed; }
+    Sha256Kernel Kernel() const { return kernel; }
+
+    // Signature incrementale : Update autant de fois que necessaire puis
+    // HexDigest, qui remet le signataire pret pour le message suivant.
+    void Update(const void* data, size_t size) { current.Update(data, size); }
+    void Update(const std::string& data) { current.Update(data); }
+    std::string HexDigest();
+
+    // Signature d'un message complet, sans toucher a l'etat incremental.
+    std::string Sign(const void* data, size_t size) const;
+    std::string Sign(const std::string& data) const { return Sign(data.data(), data.size()); }
+
+private:
+    std::string Finish(Sha256& hash) const;
+
+    Sha256Kernel kernel = Sha256Kernel::Scalar;
+    Sha256 inner{Sha256Kernel::Scalar};
+    Sha256 outer{Sha256Kernel::Scalar};
+    Sha256 current{Sha256Kernel::Scalar};
+    bool keyed = false;
+};
+
+// Constantes de tour, partagees avec Sha256Ni.cpp.
+extern const uint32_t SHA256_K[64];
+
+// Compression SHA-NI de `count` blocs (Sha256Ni.cpp, compile a part avec
+// -msha sous GCC / Clang). Uniquement si Sha256BestKernel() vaut ShaNi.
+void Sha256CompressShaNi(uint32_t state[8], const uint8_t* blocks, size_t count);
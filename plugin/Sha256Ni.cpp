@@ -0,0 +1,69 @@
+// Compression SHA-256 par les instructions SHA (SHA-NI) : seul fichier a
+// compiler avec -msha -msse4.1 (GCC / Clang). Il n'est appele qu'apres
+// verification du processeur (Sha256BestKernel).
+//
+// Les registres portent l'etat sous la forme ABEF / CDGH attendue par
+// sha256rnds2 ; chaque groupe de quatre tours prepare au passage les mots
+// du message de groupes suivants (sha256msg1 / sha256msg2).
+#include "Sha256.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+void Sha256CompressShaNi(uint32_t state[8], const uint8_t* blocks, size_t count)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);          // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+    for (; count > 0; --count, blocks += Sha256::BLOCK_SIZE)
+    {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i)
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * i)), byteSwap);
+
+        // Groupe g : tours 4g a 4g+3, mots W[4g..4g+3] dans msg[g % 4].
+        // Deroulee, la boucle garde msg[] dans les registres.
+#if defined(__GNUC__)
+#pragma GCC unroll 16
+#endif
+        for (int g = 0; g < 16; ++g)
+        {
+            __m128i& cur = msg[g & 3];
+            __m128i m = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&SHA256_K[4 * g])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, m);
+            if (g >= 3 && g < 15)
+            {
+                __m128i& next = msg[(g + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(cur, msg[(g + 3) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, cur);
+            }
+            m = _mm_shuffle_epi32(m, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, m);
+            if (g >= 1 && g < 13)
+            {
+                __m128i& prev = msg[(g + 3) & 3];
+                prev = _mm_sha256msg1_epu32(prev, cur);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);             // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);          // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);       // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);          // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+#endif
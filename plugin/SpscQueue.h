@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// File a producteur et consommateur uniques, de capacite fixe (puissance de
+// 2), allouee une fois a la construction.
+//
+// Le producteur reserve la case suivante (Claim), la remplit en place puis
+// la publie (Publish) ; le consommateur lit la case la plus ancienne (Front)
+// puis la libere (Pop). Seuls deux compteurs atomiques sont partages, chacun
+// sur sa ligne de cache : ni verrou, ni copie intermediaire.
+//
+// Publish signale le passage de vide a non vide pour que le consommateur
+// puisse dormir sans delai : apres son dernier Pop, il doit appeler
+// Settle() avant de relire Empty() puis s'endormir.
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacite en puissance de 2");
+
+public:
+    SpscQueue() : slots(new T[CAPACITY]) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producteur. nullptr si la file est pleine.
+    T* Claim()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail >= CAPACITY)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail >= CAPACITY)
+                return nullptr;
+        }
+        return &slots[h & (CAPACITY - 1)];
+    }
+    // Producteur. Rend visible la case obtenue par Claim ; vrai si la file
+    // etait vide juste avant (le consommateur dort peut-etre).
+    bool Publish()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        head.store(h + 1, std::memory_order_release);
+        // Associee a celle de Settle : si la lecture ci-dessous manque le
+        // dernier Pop, le consommateur voit forcement cette publication.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cachedTail = tail.load(std::memory_order_acquire);
+        return cachedTail == h;
+    }
+
+    // Consommateur. nullptr si la file est vide.
+    T* Front()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return nullptr;
+        }
+        return &slots[t & (CAPACITY - 1)];
+    }
+    // Consommateur. Libere la case lue par Front.
+    void Pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consommateur. A appeler entre le dernier Pop et la relecture de Empty()
+    // qui decide de s'endormir.
+    void Settle() const { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+    // Approximatif depuis un autre thread que le consommateur.
+    bool Empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+    std::unique_ptr<T[]> slots;
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0; // propre au producteur
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0; // propre au consommateur
+};
@@ -0,0 +1,271 @@
+#include "Telemetry.h"
+#include "MatchAnalytics.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+static constexpr size_t TELEMETRY_BUFFER_SIZE = 64 * 1024;
+
+int16_t TelemetryQuantize(float v)
+{
+    float r = std::round(v);
+    return static_cast<int16_t>(std::clamp(r, -32768.f, 32767.f));
+}
+
+uint16_t TelemetryQuantizeBoost(float boost)
+{
+    if (boost < 0.f)
+        return TELEMETRY_NO_BOOST;
+    float r = std::round(boost * 100.f);
+    return static_cast<uint16_t>(std::min(r, static_cast<float>(TELEMETRY_NO_BOOST - 1)));
+}
+
+void TelemetryCopyString(char* dst, size_t size, const std::string& src)
+{
+    std::memset(dst, 0, size);
+    std::memcpy(dst, src.data(), Utf8Prefix(src, size - 1));
+}
+
+static Vec3 Dequantize(const int16_t v[3])
+{
+    return {static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2])};
+}
+
+static void Quantize(const Vec3& v, int16_t out[3])
+{
+    out[0] = TelemetryQuantize(v.X);
+    out[1] = TelemetryQuantize(v.Y);
+    out[2] = TelemetryQuantize(v.Z);
+}
+
+void TelemetryEncodeFrame(const FrameSnapshot& f, TelemetryFrame& rec, TelemetryLane* lanes)
+{
+    rec = TelemetryFrame{};
+    rec.type = TELEMETRY_FRAME;
+    rec.lanes = static_cast<uint8_t>(f.count);
+    rec.hasBall = f.hasBall ? 1 : 0;
+    rec.time = f.time;
+    Quantize(f.ballPos, rec.ballPos);
+    Quantize(f.ballVel, rec.ballVel);
+    for (int i = 0; i < f.count; ++i)
+    {
+        TelemetryLane& l = lanes[i];
+        l = TelemetryLane{};
+        l.slot = static_cast<uint8_t>(f.slot[i]);
+        l.flags = (f.team[i] == 1 ? TELEMETRY_LANE_ORANGE : 0)
+                | (f.hasCar[i] ? TELEMETRY_LANE_HAS_CAR : 0)
+                | (f.onGround[i] ? TELEMETRY_LANE_ON_GROUND : 0);
+        l.boost = TelemetryQuantizeBoost(f.boost[i]);
+        Quantize(f.pos[i], l.pos);
+        Quantize(f.vel[i], l.vel);
+    }
+}
+
+void TelemetryDecodeFrame(const TelemetryRecord& rec, const int* savesBySlot, FrameSnapshot& f)
+{
+    TelemetryFrame header;
+    std::memcpy(&header, rec.data, sizeof(header));
+    f.Clear();
+    f.time = header.time;
+    f.hasBall = header.hasBall != 0;
+    f.ballPos = Dequantize(header.ballPos);
+    f.ballVel = Dequantize(header.ballVel);
+
+    const uint8_t* p = rec.data + sizeof(TelemetryFrame);
+    for (int i = 0; i < header.lanes && f.count < MAX_PLAYERS; ++i, p += sizeof(TelemetryLane))
+    {
+        TelemetryLane lane;
+        std::memcpy(&lane, p, sizeof(lane));
+        if (lane.slot >= MAX_SLOTS)
+            continue;
+        int k = f.count++;
+        f.slot[k] = lane.slot;
+        f.pri[k] = static_cast<uintptr_t>(lane.slot) + 1; // voir MatchAnalytics::AssignPlayer
+        f.indexOfSlot[lane.slot] = k;
+        f.team[k] = (lane.flags & TELEMETRY_LANE_ORANGE) ? 1 : 0;
+        f.hasCar[k] = (lane.flags & TELEMETRY_LANE_HAS_CAR) != 0;
+        f.onGround[k] = (lane.flags & TELEMETRY_LANE_ON_GROUND) != 0;
+        f.boost[k] = lane.boost == TELEMETRY_NO_BOOST ? -1.f : lane.boost / 100.f;
+        f.pos[k] = Dequantize(lane.pos);
+        f.vel[k] = Dequantize(lane.vel);
+        f.saves[k] = savesBySlot[lane.slot];
+    }
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+    Close();
+}
+
+bool TelemetryWriter::Open(const std::string& path, float sampleHz, int64_t startUnix)
+{
+    Close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    buffer.clear();
+    buffer.reserve(TELEMETRY_BUFFER_SIZE);
+    eventOffsets.clear();
+    eventOffsets.reserve(4096);
+    offset = 0;
+
+    TelemetryFileHeader header{};
+    header.magic = TELEMETRY_MAGIC;
+    header.version = TELEMETRY_VERSION;
+    header.headerSize = sizeof(TelemetryFileHeader);
+    header.sampleHz = sampleHz;
+    header.startUnix = startUnix;
+    Append(&header, sizeof(header));
+    return true;
+}
+
+void TelemetryWriter::Close()
+{
+    if (!file)
+        return;
+
+    uint64_t indexOffset = offset;
+    uint32_t indexHeader[2] = {TELEMETRY_INDEX_MAGIC, static_cast<uint32_t>(eventOffsets.size())};
+    Append(indexHeader, sizeof(indexHeader));
+    Append(eventOffsets.data(), eventOffsets.size() * sizeof(uint64_t));
+    Flush();
+
+    std::fseek(file, offsetof(TelemetryFileHeader, indexOffset), SEEK_SET);
+    std::fwrite(&indexOffset, sizeof(indexOffset), 1, file);
+    std::fclose(file);
+    file = nullptr;
+}
+
+void TelemetryWriter::WriteFrame(const TelemetryFrame& frame, const TelemetryLane* lanes)
+{
+    if (!file)
+        return;
+    Append(&frame, sizeof(frame));
+    Append(lanes, frame.lanes * sizeof(TelemetryLane));
+}
+
+void TelemetryWriter::WriteEvent(const TelemetryEvent& ev)
+{
+    if (!file)
+        return;
+    eventOffsets.push_back(offset);
+    Append(&ev, sizeof(ev));
+}
+
+void TelemetryWriter::WritePlayer(const TelemetryPlayer& player)
+{
+    if (!file)
+        return;
+    eventOffsets.push_back(offset);
+    Append(&player, sizeof(player));
+}
+
+void TelemetryWriter::WriteMatchEnd(const TelemetryMatchEnd& end, const TelemetryScore* scores)
+{
+    if (!file)
+        return;
+    eventOffsets.push_back(offset);
+    Append(&end, sizeof(end));
+    Append(scores, end.lanes * sizeof(TelemetryScore));
+}
+
+void TelemetryWriter::Append(const void* data, size_t size)
+{
+    if (buffer.size() + size > TELEMETRY_BUFFER_SIZE)
+        Flush();
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+    offset += size;
+}
+
+void TelemetryWriter::Flush()
+{
+    if (file && !buffer.empty())
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+}
+
+bool TelemetryReader::Open(const std::string& path)
+{
+    bytes.clear();
+    pos = end = 0;
+    error.clear();
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return Fail("impossible d'ouvrir " + path);
+    uint8_t chunk[TELEMETRY_BUFFER_SIZE];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    std::fclose(file);
+
+    if (bytes.size() < sizeof(TelemetryFileHeader))
+        return Fail("fichier tronque");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != TELEMETRY_MAGIC)
+        return Fail("ce n'est pas un fichier de telemetrie");
+    if (header.version < TELEMETRY_MIN_VERSION || header.version > TELEMETRY_VERSION)
+        return Fail("version " + std::to_string(header.version) + " non supportee");
+
+    pos = header.headerSize;
+    // Un fichier interrompu n'a pas d'index : on lit jusqu'a la fin.
+    end = header.indexOffset != 0 && header.indexOffset <= bytes.size()
+        ? static_cast<size_t>(header.indexOffset) : bytes.size();
+    return true;
+}
+
+bool TelemetryReader::Next(TelemetryRecord& rec)
+{
+    if (pos >= end)
+        return false;
+
+    const uint8_t* p = bytes.data() + pos;
+    size_t size = 0;
+    switch (p[0])
+    {
+    case TELEMETRY_FRAME:
+        size = sizeof(TelemetryFrame);
+        if (pos + size <= end)
+            size += p[offsetof(TelemetryFrame, lanes)] * sizeof(TelemetryLane);
+        break;
+    case TELEMETRY_PLAYER:
+        size = sizeof(TelemetryPlayer);
+        break;
+    case TELEMETRY_MATCH_END:
+        size = sizeof(TelemetryMatchEnd);
+        if (pos + size <= end)
+            size += p[offsetof(TelemetryMatchEnd, lanes)] * sizeof(TelemetryScore);
+        break;
+    case TELEMETRY_PHASE:
+    case TELEMETRY_SAMPLE:
+    case TELEMETRY_TOUCH:
+    case TELEMETRY_DEMOLISH:
+    case TELEMETRY_BOOST:
+    case TELEMETRY_GOAL:
+    case TELEMETRY_SAVES:
+        size = sizeof(TelemetryEvent);
+        break;
+    default:
+        return Fail("type d'enregistrement inconnu " + std::to_string(p[0]) + " a l'offset " + std::to_string(pos));
+    }
+    // Un match interrompu peut laisser un dernier enregistrement incomplet.
+    if (pos + size > end)
+        return Fail("enregistrement tronque a l'offset " + std::to_string(pos));
+
+    rec.type = p[0];
+    rec.data = p;
+    rec.size = size;
+    pos += size;
+    return true;
+}
+
+bool TelemetryReader::Fail(const std::string& msg)
+{
+    error = msg;
+    pos = end;
+    return false;
+}
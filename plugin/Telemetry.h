@@ -0,0 +1,228 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Format binaire d'enregistrement d'un match (.amt).
+//
+// Le fichier commence par un TelemetryFileHeader puis une suite
+// d'enregistrements de taille fixe, chacun debutant par son type sur un
+// octet. Une frame est suivie de `lanes` TelemetryLane ; celle sur laquelle
+// les statistiques ont ete echantillonnees porte TELEMETRY_FRAME_SAMPLE (sans
+// enregistrement supplementaire). A la fermeture, un
+// index des offsets de tous les evenements (hors frames) est ajoute en fin de
+// fichier et son offset est reporte dans l'en-tete ; un fichier interrompu
+// (indexOffset == 0) reste lisible sequentiellement.
+//
+// Les structures sont ecrites telles quelles : toutes les plateformes ciblees
+// (Windows x64 pour le plugin, Linux x86-64 pour les outils) sont
+// little-endian. Positions et vitesses sont arrondies a l'unite (uu, uu/s) et
+// le boost au centieme : une frame relue n'est egale a la frame capturee
+// qu'a ces arrondis pres.
+
+static constexpr uint32_t TELEMETRY_MAGIC = 0x544D5541;       // "AUMT"
+static constexpr uint32_t TELEMETRY_INDEX_MAGIC = 0x58495541; // "AUIX"
+// Version 2 : echantillon marque sur la frame. Les fichiers en version 1
+// (un evenement SAMPLE par echantillon) restent lisibles.
+static constexpr uint16_t TELEMETRY_VERSION = 2;
+static constexpr uint16_t TELEMETRY_MIN_VERSION = 1;
+
+enum TelemetryRecordType : uint8_t
+{
+    TELEMETRY_FRAME = 1,
+    TELEMETRY_PLAYER = 2,
+    TELEMETRY_PHASE = 3,
+    TELEMETRY_SAMPLE = 4,
+    TELEMETRY_TOUCH = 5,
+    TELEMETRY_DEMOLISH = 6,
+    TELEMETRY_BOOST = 7,
+    TELEMETRY_GOAL = 8,
+    TELEMETRY_SAVES = 9,
+    TELEMETRY_MATCH_END = 10
+};
+
+enum TelemetryFrameFlags : uint8_t
+{
+    // Statistiques echantillonnees sur cette frame, apres les evenements
+    // SAVES qui la suivent
+    TELEMETRY_FRAME_SAMPLE = 1 << 0
+};
+
+enum TelemetryLaneFlags : uint8_t
+{
+    TELEMETRY_LANE_ORANGE = 1 << 0,
+    TELEMETRY_LANE_HAS_CAR = 1 << 1,
+    TELEMETRY_LANE_ON_GROUND = 1 << 2
+};
+
+static constexpr uint16_t TELEMETRY_NO_BOOST = 0xFFFF;
+
+struct TelemetryFileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    float sampleHz;
+    uint32_t reserved;
+    int64_t startUnix;
+    uint64_t indexOffset; // 0 tant que le fichier n'est pas ferme
+};
+
+struct TelemetryFrame
+{
+    uint8_t type; // TELEMETRY_FRAME
+    uint8_t lanes;
+    uint8_t hasBall;
+    uint8_t flags; // TelemetryFrameFlags
+    float time;
+    int16_t ballPos[3];
+    int16_t ballVel[3];
+};
+
+struct TelemetryLane
+{
+    uint8_t slot;
+    uint8_t flags;  // TelemetryLaneFlags
+    uint16_t boost; // centiemes, TELEMETRY_NO_BOOST sans composant boost
+    int16_t pos[3];
+    int16_t vel[3];
+};
+
+// Evenement generique. Champs selon le type :
+//  PHASE    : slot = GamePhase
+//  SAMPLE   : echantillon de statistiques sur la derniere frame, quand
+//             elle a deja ete enregistree sans TELEMETRY_FRAME_SAMPLE (un
+//             evenement l'a lue plus tot dans la meme frame du jeu)
+//  TOUCH    : slot = joueur
+//  DEMOLISH : slot = attaquant, other = victime (0xFF si inconnue)
+//  BOOST    : slot = joueur, a = boost apres ramassage, b = boost max
+//  GOAL     : a = score bleu, b = score orange
+//  SAVES    : slot = joueur, a = nombre d'arrets du PRI
+struct TelemetryEvent
+{
+    uint8_t type;
+    uint8_t slot;
+    uint8_t other;
+    uint8_t reserved;
+    float time;
+    float a;
+    float b;
+};
+
+struct TelemetryPlayer
+{
+    uint8_t type; // TELEMETRY_PLAYER
+    uint8_t slot;
+    uint8_t team;
+    uint8_t reserved;
+    char name[44];
+    char uid[48];
+};
+
+struct TelemetryMatchEnd
+{
+    uint8_t type; // TELEMETRY_MATCH_END, suivi de `lanes` TelemetryScore
+    uint8_t lanes;
+    uint16_t reserved;
+    float secondsElapsed;
+    float totalGameTime;
+    int32_t scoreBlue;
+    int32_t scoreOrange;
+    char map[32];
+    char teamBlue[32];
+    char teamOrange[32];
+};
+
+struct TelemetryScore
+{
+    uint8_t slot;
+    uint8_t team;
+    uint16_t reserved;
+    int16_t goals;
+    int16_t assists;
+    int16_t shots;
+    int16_t saves;
+    int32_t score;
+};
+
+static_assert(sizeof(TelemetryFileHeader) == 32, "format telemetrie");
+static_assert(sizeof(TelemetryFrame) == 20, "format telemetrie");
+static_assert(sizeof(TelemetryLane) == 16, "format telemetrie");
+static_assert(sizeof(TelemetryEvent) == 16, "format telemetrie");
+static_assert(sizeof(TelemetryPlayer) == 96, "format telemetrie");
+static_assert(sizeof(TelemetryMatchEnd) == 116, "format telemetrie");
+static_assert(sizeof(TelemetryScore) == 16, "format telemetrie");
+
+int16_t TelemetryQuantize(float v);
+uint16_t TelemetryQuantizeBoost(float boost);
+void TelemetryCopyString(char* dst, size_t size, const std::string& src);
+
+// Ecriture bufferisee : chaque enregistrement n'est qu'une copie dans un
+// tampon memoire, vide sur disque par blocs de 64 Ko.
+class TelemetryWriter
+{
+public:
+    ~TelemetryWriter();
+
+    bool Open(const std::string& path, float sampleHz, int64_t startUnix);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+    uint64_t Size() const { return offset; }
+
+    void WriteFrame(const TelemetryFrame& frame, const TelemetryLane* lanes);
+    void WriteEvent(const TelemetryEvent& ev);
+    void WritePlayer(const TelemetryPlayer& player);
+    void WriteMatchEnd(const TelemetryMatchEnd& end, const TelemetryScore* scores);
+
+private:
+    void Append(const void* data, size_t size);
+    void Flush();
+
+    FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    uint64_t offset = 0;
+    std::vector<uint64_t> eventOffsets;
+};
+
+// Enregistrement lu par TelemetryReader : `data` pointe sur le debut de
+// l'enregistrement (octet de type compris) et `size` couvre aussi les
+// TelemetryLane / TelemetryScore qui le suivent.
+struct TelemetryRecord
+{
+    uint8_t type = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct FrameSnapshot;
+
+// Frame capturee -> enregistrement TELEMETRY_FRAME (`lanes` : MAX_PLAYERS
+// cases). Les arrets ne sont pas dans les lanes : le plugin les enregistre
+// en evenements TELEMETRY_SAVES.
+void TelemetryEncodeFrame(const FrameSnapshot& f, TelemetryFrame& rec, TelemetryLane* lanes);
+// Enregistrement TELEMETRY_FRAME -> frame, arrets repris de `savesBySlot`
+// (MAX_SLOTS cases, tenu a jour par les evenements TELEMETRY_SAVES).
+void TelemetryDecodeFrame(const TelemetryRecord& rec, const int* savesBySlot, FrameSnapshot& f);
+
+// Lecture sequentielle d'un fichier .amt charge entierement en memoire.
+class TelemetryReader
+{
+public:
+    bool Open(const std::string& path);
+    const TelemetryFileHeader& Header() const { return header; }
+    const std::string& Error() const { return error; }
+
+    // Renvoie false en fin de fichier (ou d'enregistrements avant l'index)
+    // ou sur un enregistrement invalide ; Error() est alors renseigne.
+    bool Next(TelemetryRecord& rec);
+
+private:
+    bool Fail(const std::string& msg);
+
+    std::vector<uint8_t> bytes;
+    TelemetryFileHeader header{};
+    size_t pos = 0;
+    size_t end = 0;
+    std::string error;
+};
@@ -0,0 +1,250 @@
+#include "UploadJournal.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Taille maximale d'une trame relue : au-dela, l'en-tete est considere
+// comme corrompu plutot que d'allouer a l'aveugle.
+static constexpr uint32_t MAX_FRAME_DATA = 16 * 1024 * 1024;
+
+static uint32_t FrameCrc(UploadJournalFrame header, const char* data, size_t size)
+{
+    header.crc = 0;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(&header), sizeof(header));
+    if (size > 0)
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+    return static_cast<uint32_t>(crc);
+}
+
+// Vide les tampons de la libc puis ceux du systeme vers le disque.
+static bool SyncFile(FILE* f)
+{
+    if (std::fflush(f) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+static bool PutFrame(FILE* f, uint8_t type, uint64_t id, const std::string& data)
+{
+    UploadJournalFrame header{};
+    header.magic = UPLOAD_JOURNAL_MAGIC;
+    header.type = type;
+    header.id = id;
+    header.size = static_cast<uint32_t>(data.size());
+    header.crc = FrameCrc(header, data.data(), data.size());
+    if (std::fwrite(&header, sizeof(header), 1, f) != 1)
+        return false;
+    return data.empty() || std::fwrite(data.data(), 1, data.size(), f) == data.size();
+}
+
+UploadJournal::~UploadJournal()
+{
+    Close();
+}
+
+bool UploadJournal::Open(const std::string& filePath, std::vector<Entry>& pending)
+{
+    Close();
+    path = filePath;
+    pending.clear();
+    pendingIds.clear();
+    error.clear();
+
+    std::map<uint64_t, Entry> entries; // ordre d'identifiant = ordre d'ajout
+    uint64_t maxId = 0;
+    long frames = 0;
+    validSize = 0;
+    bool damaged = false;
+    if (FILE* in = std::fopen(path.c_str(), "rb"))
+    {
+        std::string data;
+        UploadJournalFrame header;
+        for (;;)
+        {
+            size_t got = std::fread(&header, 1, sizeof(header), in);
+            if (got != sizeof(header))
+            {
+                // En-tete coupe : ecriture interrompue
+                damaged = got > 0;
+                break;
+            }
+            if (header.magic != UPLOAD_JOURNAL_MAGIC || header.size > MAX_FRAME_DATA)
+            {
+                damaged = true;
+                break;
+            }
+            data.resize(header.size);
+            if (header.size > 0 && std::fread(&data[0], 1, header.size, in) != header.size)
+            {
+                damaged = true;
+                break;
+            }
+            if (FrameCrc(header, data.data(), data.size()) != header.crc)
+            {
+                damaged = true;
+                break;
+            }
+            frames++;
+            validSize += sizeof(header) + header.size;
+            maxId = std::max(maxId, header.id);
+            if (header.type == UPLOAD_JOURNAL_ENTRY)
+            {
+                size_t newline = data.find('\n');
+                if (newline == std::string::npos)
+                    continue;
+                Entry& e = entries[header.id];
+                e.id = header.id;
+                e.url = data.substr(0, newline);
+                e.body = data.substr(newline + 1);
+            }
+            else if (header.type == UPLOAD_JOURNAL_DONE)
+            {
+                entries.erase(header.id);
+            }
+        }
+        std::fclose(in);
+    }
+    if (damaged)
+        error = "fin de journal illisible apres " + std::to_string(frames) + " trame(s), ignoree";
+
+    nextId = maxId + 1;
+    pending.reserve(entries.size());
+    for (auto& [id, e] : entries)
+    {
+        pendingIds.insert(id);
+        pending.push_back(std::move(e));
+    }
+    return Rewrite(pending);
+}
+
+void UploadJournal::Close()
+{
+    if (!file)
+        return;
+    std::fclose(file);
+    file = nullptr;
+}
+
+// Remplace le fichier par les seules entrees en attente (fichier temporaire
+// synchronise puis renomme), puis le rouvre en ajout.
+bool UploadJournal::Rewrite(const std::vector<Entry>& pending)
+{
+    Close();
+    if (pending.empty())
+    {
+        file = std::fopen(path.c_str(), "wb");
+        validSize = 0;
+        if (!file)
+        {
+            error = "ouverture de " + path + " impossible";
+            return false;
+        }
+        return true;
+    }
+
+    std::error_code ec;
+    std::string tmp = path + ".tmp";
+    uint64_t size = 0;
+    bool ok = false;
+    if (FILE* out = std::fopen(tmp.c_str(), "wb"))
+    {
+        ok = true;
+        for (const Entry& e : pending)
+        {
+            ok = ok && PutFrame(out, UPLOAD_JOURNAL_ENTRY, e.id, e.url + '\n' + e.body);
+            size += sizeof(UploadJournalFrame) + e.url.size() + 1 + e.body.size();
+        }
+        ok = SyncFile(out) && ok;
+        std::fclose(out);
+        if (ok)
+            std::filesystem::rename(tmp, path, ec);
+        ok = ok && !ec;
+    }
+    if (ok)
+    {
+        validSize = size;
+        file = std::fopen(path.c_str(), "ab");
+        if (!file)
+        {
+            error = "ouverture de " + path + " impossible";
+            return false;
+        }
+        return true;
+    }
+    // L'ancien fichier reste en place avec les entrees ; sa fin illisible
+    // est retiree pour que les trames suivantes restent lisibles.
+    std::filesystem::remove(tmp, ec);
+    error = "reecriture du journal impossible";
+    return Truncate();
+}
+
+bool UploadJournal::Truncate()
+{
+    Close();
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec))
+        std::filesystem::resize_file(path, validSize, ec);
+    if (!ec)
+        file = std::fopen(path.c_str(), "ab");
+    if (!file)
+    {
+        error = "remise en etat de " + path + " impossible, journal desactive";
+        return false;
+    }
+    return true;
+}
+
+bool UploadJournal::WriteFrame(uint8_t type, uint64_t id, const std::string& data, bool sync)
+{
+    if (!file)
+        return false;
+    bool ok = PutFrame(file, type, id, data);
+    ok = (sync ? SyncFile(file) : std::fflush(file) == 0) && ok;
+    if (!ok)
+    {
+        // Trame peut-etre ecrite en partie : elle masquerait les suivantes
+        Truncate();
+        return false;
+    }
+    validSize += sizeof(UploadJournalFrame) + data.size();
+    return true;
+}
+
+uint64_t UploadJournal::Append(const std::string& url, const std::string& body)
+{
+    uint64_t id = nextId++;
+    if (!WriteFrame(UPLOAD_JOURNAL_ENTRY, id, url + '\n' + body, true))
+    {
+        error = "ecriture dans le journal impossible";
+        return 0;
+    }
+    pendingIds.insert(id);
+    return id;
+}
+
+void UploadJournal::MarkDone(uint64_t id)
+{
+    if (pendingIds.erase(id) == 0)
+        return;
+    if (pendingIds.empty())
+    {
+        // Plus rien en attente : le journal repart vide
+        Close();
+        file = std::fopen(path.c_str(), "wb");
+        validSize = 0;
+        return;
+    }
+    WriteFrame(UPLOAD_JOURNAL_DONE, id, std::string(), false);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Journal des resultats de match a envoyer (uploads.journal).
+//
+// Fichier en ajout seul : une suite de trames, chacune un en-tete
+// UploadJournalFrame suivi de `size` octets. Une trame ENTRY contient l'URL
+// puis, apres un '\n', le corps JSON tel qu'il sera envoye ; elle est ecrite
+// et synchronisee sur disque (fsync) avant le premier envoi. Une trame DONE
+// (sans donnees) marque l'entree comme traitee ; elle n'est pas synchronisee :
+// la perdre dans un plantage ne provoque qu'un renvoi, que le bot ignore
+// grace a l'uploadId du corps.
+//
+// A l'ouverture, le fichier est relu trame par trame ; la lecture s'arrete a
+// la premiere trame tronquee ou dont le CRC32 ne correspond pas (ecriture
+// interrompue) et le fichier est tronque a cet endroit. Le fichier est
+// reecrit sans les entrees traitees a l'ouverture, et vide des que plus
+// aucune entree n'est en attente. Si cette reecriture echoue, ou si une
+// trame n'est ecrite qu'en partie, le fichier est ramene a la fin de la
+// derniere trame valide avant tout nouvel ajout : une trame ecrite derriere
+// une fin illisible serait perdue a la relecture.
+static constexpr uint32_t UPLOAD_JOURNAL_MAGIC = 0x4A554141; // "AAUJ"
+
+enum UploadJournalType : uint8_t
+{
+    UPLOAD_JOURNAL_ENTRY = 1,
+    UPLOAD_JOURNAL_DONE = 2
+};
+
+struct UploadJournalFrame
+{
+    uint32_t magic;
+    uint8_t type;
+    uint8_t reserved[3];
+    uint64_t id;
+    uint32_t size;
+    uint32_t crc; // CRC32 de l'en-tete (crc a 0) puis des donnees
+};
+
+class UploadJournal
+{
+public:
+    struct Entry
+    {
+        uint64_t id = 0;
+        std::string url;
+        std::string body;
+    };
+
+    ~UploadJournal();
+
+    // Relit le fichier et renvoie dans `pending` les entrees non traitees,
+    // de la plus ancienne a la plus recente.
+    bool Open(const std::string& path, std::vector<Entry>& pending);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+
+    // Ecrit et synchronise une entree ; renvoie son identifiant (0 en cas
+    // d'echec, l'envoi se fait alors sans filet).
+    uint64_t Append(const std::string& url, const std::string& body);
+    void MarkDone(uint64_t id);
+
+    size_t Pending() const { return pendingIds.size(); }
+    const std::string& Error() const { return error; }
+
+private:
+    bool WriteFrame(uint8_t type, uint64_t id, const std::string& data, bool sync);
+    bool Rewrite(const std::vector<Entry>& pending);
+    // Ramene le fichier a validSize octets et le rouvre en ajout.
+    bool Truncate();
+
+    std::string path;
+    FILE* file = nullptr;
+    uint64_t validSize = 0; // fin de la derniere trame valide
+    uint64_t nextId = 1;
+    std::unordered_set<uint64_t> pendingIds;
+    std::string error;
+};
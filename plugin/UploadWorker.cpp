@@ -0,0 +1,521 @@
+#include "UploadWorker.h"
+#include <curl/curl.h>
+#include <zlib.h>
+#ifdef AUUSA_WITH_ZSTD
+#include <zstd.h>
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <utility>
+
+static bool Retryable(long status)
+{
+    // 401 : secret mal configure, corrige au prochain chargement
+    return status == 0 || status == 401 || status == 408 || status == 429 || status >= 500;
+}
+
+// Corps d'un envoi construit sur le thread d'envoi. L'identifiant permet au
+// bot d'ignorer un resultat renvoye deux fois ; un texte UTF-8 invalide est
+// remplace par U+FFFD au lieu de faire echouer l'envoi.
+static std::string BuildBody(const UploadWorker::Job& job, std::mt19937_64& rng)
+{
+    nlohmann::json payload = job.build();
+    if (job.durable)
+        payload["uploadId"] = std::to_string(rng());
+    return payload.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+UploadWorker::~UploadWorker()
+{
+    Stop();
+}
+
+void UploadWorker::Start(LogFn logFn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+    log = std::move(logFn);
+    stopping = false;
+    running = true;
+    thread = std::thread(&UploadWorker::Run, this);
+}
+
+void UploadWorker::Stop()
+{
+    std::deque<Job> left;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        stopping = true;
+        left.swap(pending);
+    }
+    wake.notify_all();
+    thread.join();
+    running = false;
+
+    // Les resultats pas encore partis sont gardes pour le prochain chargement
+    size_t dropped = 0;
+    size_t kept = 0;
+    for (Job& job : left)
+    {
+        if (!job.durable || !journal.IsOpen())
+        {
+            dropped++;
+            continue;
+        }
+        if (job.body.empty() && job.build)
+            job.body = BuildBody(job, rng);
+        if (journal.Append(job.url, job.body) != 0)
+            kept++;
+        else
+            dropped++;
+    }
+    if (dropped > 0)
+        Log("[Stats] " + std::to_string(dropped) + " envoi(s) abandonne(s) a l'arret");
+    if (kept > 0)
+        Log("[Stats] " + std::to_string(kept) + " resultat(s) garde(s) dans le journal pour le prochain chargement");
+}
+
+bool UploadWorker::Enqueue(Job job, size_t maxPending)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || stopping)
+            return false;
+        if (pending.size() >= std::min(maxPending, MAX_PENDING))
+            return false;
+        pending.push_back(std::move(job));
+    }
+    wake.notify_one();
+    return true;
+}
+
+void UploadWorker::SetCompression(UploadCompression mode, size_t minBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    compression = mode;
+    minCompress = minBytes;
+}
+
+const char* UploadWorker::CompressionName(UploadCompression mode)
+{
+    switch (mode)
+    {
+    case UploadCompression::Gzip: return "gzip";
+    case UploadCompression::Zstd: return "zstd";
+    default: return "identity";
+    }
+}
+
+void UploadWorker::SetSigner(HmacSha256 hmac)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    signer = std::move(hmac);
+}
+
+void UploadWorker::SetJournal(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    journalPath = path;
+}
+
+void UploadWorker::OpenJournal()
+{
+    if (journalPath.empty())
+        return;
+    std::vector<UploadJournal::Entry> entries;
+    bool ok = journal.Open(journalPath, entries);
+    if (!journal.Error().empty())
+        Log("[Stats] Journal : " + journal.Error());
+    if (!ok)
+        return;
+    retries.clear();
+    for (UploadJournal::Entry& e : entries)
+    {
+        Retry r;
+        r.journalId = e.id;
+        r.url = std::move(e.url);
+        r.body = std::move(e.body);
+        r.due = Clock::now();
+        retries.push_back(std::move(r));
+    }
+    if (!retries.empty())
+        Log("[Stats] " + std::to_string(retries.size()) + " resultat(s) en attente dans le journal, renvoi en arriere-plan");
+}
+
+bool UploadWorker::Available(UploadCompression mode)
+{
+#ifndef AUUSA_WITH_ZSTD
+    if (mode == UploadCompression::Zstd)
+        return false;
+#endif
+    return true;
+}
+
+bool UploadWorker::Compress(UploadCompression mode, const std::string& in, std::string& out)
+{
+    if (mode == UploadCompression::Gzip)
+    {
+        // windowBits 15 + 16 : en-tete et somme de controle gzip
+        z_stream zs{};
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+        out.resize(deflateBound(&zs, static_cast<uLong>(in.size())));
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        zs.avail_out = static_cast<uInt>(out.size());
+        int rc = deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return rc == Z_STREAM_END;
+    }
+#ifdef AUUSA_WITH_ZSTD
+    if (mode == UploadCompression::Zstd)
+    {
+        out.resize(ZSTD_compressBound(in.size()));
+        size_t size = ZSTD_compress(&out[0], out.size(), in.data(), in.size(), 3);
+        if (ZSTD_isError(size))
+            return false;
+        out.resize(size);
+        return true;
+    }
+#endif
+    return false;
+}
+
+void UploadWorker::Run()
+{
+    // Une seule poignee pour toute la duree de vie du plugin : curl garde
+    // la connexion ouverte et reprend la session TLS aux envois suivants.
+    CURL* curl = curl_easy_init();
+    if (!curl)
+        Log("[Stats] Initialisation de curl impossible, envois desactives");
+    OpenJournal();
+
+    for (;;)
+    {
+        Job job;
+        bool haveJob = false;
+        {
+            // Seul ce thread touche a retries : l'echeance se lit sans verrou
+            Clock::time_point due = Clock::time_point::max();
+            for (const Retry& r : retries)
+                due = std::min(due, r.due);
+            if (!curl)
+                due = Clock::time_point::max();
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_until(lock, due, [this] { return stopping || !pending.empty(); });
+            if (stopping)
+                break;
+            if (!pending.empty())
+            {
+                job = std::move(pending.front());
+                pending.pop_front();
+                haveJob = true;
+            }
+        }
+        if (!curl)
+            continue;
+
+        try
+        {
+            if (haveJob)
+                Process(curl, job);
+            else
+                Drain(curl);
+        }
+        catch (const std::exception& e)
+        {
+            Log(std::string("[Stats] Exception lors de l'envoi : ") + e.what());
+        }
+        catch (...)
+        {
+            Log("[Stats] Exception inconnue lors de l'envoi");
+        }
+    }
+
+    if (curl)
+        curl_easy_cleanup(curl);
+}
+
+void UploadWorker::Process(CURL* curl, Job& job)
+{
+    std::string body = std::move(job.body);
+    if (body.empty() && job.build)
+    {
+        body = BuildBody(job, rng);
+        job.build = nullptr;
+    }
+
+    // Une seule ecriture sequentielle, synchronisee, avant le premier envoi
+    uint64_t journalId = 0;
+    if (job.durable && journal.IsOpen())
+    {
+        journalId = journal.Append(job.url, body);
+        if (journalId == 0)
+            Log("[Stats] Journal : " + journal.Error() + ", envoi sans nouvel essai possible");
+    }
+
+    long status = Deliver(curl, job.url, body, job.quiet, nullptr);
+    if (journalId == 0)
+        return;
+    Retry r;
+    r.journalId = journalId;
+    r.url = job.url;
+    r.body = std::move(body);
+    Settle(std::move(r), status);
+}
+
+// Renvoie les resultats journalises arrives a echeance : plusieurs par
+// requete sur <url>/batch, sinon le plus ancien seul.
+void UploadWorker::Drain(CURL* curl)
+{
+    Clock::time_point now = Clock::now();
+    std::vector<Retry> due;
+    size_t bytes = 0;
+    for (auto it = retries.begin(); it != retries.end() && due.size() < DRAIN_BATCH;)
+    {
+        // Un lot ne melange ni les URL ni les formats (JSON, CBOR)
+        bool sameBatch = due.empty()
+            || (it->url == due.front().url && PayloadFormatOf(it->body) == PayloadFormatOf(due.front().body));
+        if (it->due > now || !sameBatch || (!due.empty() && bytes + it->body.size() > DRAIN_BATCH_BYTES))
+        {
+            ++it;
+            continue;
+        }
+        bytes += it->body.size();
+        due.push_back(std::move(*it));
+        it = retries.erase(it);
+        if (!batchSupported)
+            break;
+    }
+    if (due.empty())
+        return;
+
+    if (due.size() == 1)
+    {
+        long status = Deliver(curl, due.front().url, due.front().body, false, nullptr);
+        Settle(std::move(due.front()), status);
+        return;
+    }
+
+    // Les corps journalises sont recopies tels quels dans { "matches": [...] }
+    PayloadWriter batch(bytes + 32);
+    batch.Reset(PayloadFormatOf(due.front().body));
+    batch.BeginObject(1);
+    batch.Key("matches");
+    batch.BeginArray(due.size());
+    for (const Retry& r : due)
+        batch.Raw(r.body);
+    batch.End();
+    batch.End();
+
+    std::string response;
+    long status = Deliver(curl, due.front().url + "/batch", batch.Data(), true, &response);
+    if (status == 404 || status == 405)
+    {
+        // Bot sans envoi groupe : les memes resultats repartent un par un
+        Log("[Stats] Envoi groupe non pris en charge par le serveur, renvoi un par un");
+        batchSupported = false;
+        for (Retry& r : due)
+            retries.push_front(std::move(r));
+        return;
+    }
+
+    nlohmann::json results;
+    if (status >= 200 && status < 300)
+    {
+        auto parsed = nlohmann::json::parse(response, nullptr, false);
+        if (parsed.is_object() && parsed.contains("results") && parsed["results"].is_array()
+            && parsed["results"].size() == due.size())
+            results = parsed["results"];
+    }
+    size_t sent = 0;
+    for (size_t i = 0; i < due.size(); ++i)
+    {
+        // Reponse sans detail par resultat : tout est retente
+        long code = results.is_array() && results[i].is_number_integer() ? results[i].get<long>()
+                  : (status >= 200 && status < 300 ? 0 : status);
+        if (code >= 200 && code < 300)
+            sent++;
+        Settle(std::move(due[i]), code);
+    }
+    Log("[Stats] Journal : " + std::to_string(sent) + "/" + std::to_string(due.size())
+        + " resultat(s) en attente envoye(s), " + std::to_string(retries.size()) + " restant(s)");
+}
+
+void UploadWorker::Settle(Retry retry, long status)
+{
+    if (status >= 200 && status < 300)
+    {
+        journal.MarkDone(retry.journalId);
+        return;
+    }
+    if (!Retryable(status))
+    {
+        Log("[Stats] Resultat refuse par le serveur (HTTP " + std::to_string(status) + "), retire du journal");
+        journal.MarkDone(retry.journalId);
+        return;
+    }
+
+    retry.attempts++;
+    auto step = std::min<Clock::duration>(RETRY_MIN * (1LL << std::min(retry.attempts - 1, 8)), RETRY_MAX);
+    std::uniform_real_distribution<double> jitter(0.75, 1.0);
+    auto delay = std::chrono::duration_cast<Clock::duration>(step * jitter(rng));
+    retry.due = Clock::now() + delay;
+    bool quiet;
+    {
+        // Envoi interrompu par l'arret : l'entree reste simplement au journal
+        std::lock_guard<std::mutex> lock(mutex);
+        quiet = stopping;
+    }
+    if (!quiet)
+        Log("[Stats] Resultat garde dans le journal, nouvel essai dans "
+        + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(delay).count()) + " s ("
+        + std::to_string(retries.size() + 1) + " en attente)");
+    retries.push_back(std::move(retry));
+}
+
+long UploadWorker::Deliver(CURL* curl, const std::string& url, const std::string& body, bool quiet,
+                           std::string* response)
+{
+    // Un resultat journalise en CBOR part en JSON si le bot l'a refuse
+    std::string converted;
+    const std::string* content = &body;
+    if (cborRefused && PayloadFormatOf(body) == PayloadFormat::Cbor && CborToJson(body, converted))
+        content = &converted;
+
+    // Reglage fige au premier envoi ; seul ce thread le modifie ensuite
+    UploadCompression mode;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        mode = compression;
+    }
+    long status = Send(curl, url, *content, quiet, mode, response);
+    // 415 sur un corps CBOR : le format est mis en cause avant la compression
+    if (status == 415 && content == &body && PayloadFormatOf(body) == PayloadFormat::Cbor && CborToJson(body, converted))
+    {
+        Log("[Stats] CBOR refuse par le serveur, nouvel envoi en JSON");
+        cborRefused = true;
+        content = &converted;
+        status = Send(curl, url, *content, quiet, mode, response);
+    }
+    if (status == 415 && mode != UploadCompression::None)
+    {
+        Log("[Stats] Compression refusee par le serveur, nouvel envoi sans compression");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            compression = UploadCompression::None;
+        }
+        status = Send(curl, url, *content, quiet, UploadCompression::None, response);
+    }
+    return status;
+}
+
+long UploadWorker::Send(CURL* curl, const std::string& url, const std::string& content, bool quiet,
+                        UploadCompression mode, std::string* out)
+{
+    size_t rawSize = content.size();
+    size_t minBytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        minBytes = minCompress;
+    }
+    // La signature porte sur le corps tel qu'il part, compresse ou non
+    std::string compressedBody;
+    bool compressed = mode != UploadCompression::None && rawSize >= minBytes && Compress(mode, content, compressedBody);
+    const std::string& body = compressed ? compressedBody : content;
+
+    struct curl_slist* headers_list = nullptr;
+    headers_list = curl_slist_append(headers_list,
+        (std::string("Content-Type: ") + PayloadContentType(PayloadFormatOf(content))).c_str());
+    if (compressed)
+        headers_list = curl_slist_append(headers_list, (std::string("Content-Encoding: ") + CompressionName(mode)).c_str());
+    // Etats de cle precalcules : seul le corps est hache
+    if (signer.HasKey())
+    {
+        std::string sig_header = "x-signature: " + signer.Sign(body);
+        headers_list = curl_slist_append(headers_list, sig_header.c_str());
+    }
+
+    // Les options d'un envoi precedent restent actives sur la poignee :
+    // chaque envoi les redefinit toutes.
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (url.rfind("http://", 0) == 0)
+    {
+        curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_NONE);
+        if (!quiet)
+            Log("Mode HTTP détecté : SSL/TLS désactivé pour cette requête");
+    }
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+    // Interrompt l'envoi en cours quand le plugin est decharge
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION,
+                     +[](void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) -> int {
+                         auto* self = static_cast<UploadWorker*>(userdata);
+                         std::lock_guard<std::mutex> lock(self->mutex);
+                         return self->stopping ? 1 : 0;
+                     });
+
+    std::string response;
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                     +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+                         auto* resp = static_cast<std::string*>(userdata);
+                         resp->append(ptr, size * nmemb);
+                         return size * nmemb;
+                     });
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+
+    CURLcode res;
+    {
+        PerfScope scope(latency);
+        res = curl_easy_perform(curl);
+    }
+    long status_code = 0;
+    if (res != CURLE_OK)
+    {
+        Log(std::string("[Stats] Erreur reseau : ") + curl_easy_strerror(res));
+    }
+    else
+    {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+        long connects = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        std::string details;
+        if (compressed)
+            details += " (" + std::to_string(rawSize) + " -> " + std::to_string(body.size()) + " octets " + CompressionName(mode) + ")";
+        if (connects == 0)
+            details += " (connexion reutilisee)";
+        if (status_code >= 200 && status_code < 300)
+        {
+            if (!quiet)
+                Log("[Stats] Envoi reussi" + details);
+        }
+        else if (status_code != 415 || !compressed)
+            Log("[Stats] Erreur HTTP " + std::to_string(status_code) + ": " + response);
+    }
+
+    // La poignee garde des pointeurs vers ces donnees locales
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, nullptr);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    curl_slist_free_all(headers_list);
+    if (out)
+        *out = std::move(response);
+    return status_code;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "PayloadWriter.h"
+#include "PerfStats.h"
+#include "Sha256.h"
+#include "UploadJournal.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+typedef void CURL;
+
+// Thread d'envoi unique, possede par le plugin.
+//
+// Les payloads de fin de match sont deposes dans une file bornee ; le thread
+// les serialise, les signe puis les envoie avec une poignee curl reutilisee
+// d'un envoi a l'autre : la connexion (keep-alive) et la session TLS sont
+// conservees, seul le premier envoi paie la poignee de main complete.
+//
+// Au-dela d'une taille minimale, le corps est compresse (gzip, ou zstd si le
+// plugin est compile avec AUUSA_WITH_ZSTD) et envoye avec Content-Encoding.
+// La signature (HMAC-SHA256, SetSigner) porte sur les octets effectivement
+// envoyes. Un serveur qui repond 415 recoit les envois suivants sans
+// compression, puis en JSON si le corps etait en CBOR.
+//
+// Avec un journal (SetJournal), les resultats de fin de match (durable)
+// y sont ecrits avant le premier envoi et n'en sortent qu'apres une reponse
+// 2xx ou un refus definitif (4xx autre que 401, 408, 429). Un echec reseau
+// ou serveur est retente avec un delai doublant de RETRY_MIN a RETRY_MAX.
+// Les entrees laissees par une session precedente sont renvoyees des le
+// demarrage, par lots de DRAIN_BATCH via POST <url>/batch quand le bot le
+// permet, une par une sinon.
+enum class UploadCompression
+{
+    None,
+    Gzip,
+    Zstd
+};
+
+class UploadWorker
+{
+public:
+    using LogFn = std::function<void(const std::string&)>;
+
+    struct Job
+    {
+        std::string url;
+        // Corps deja ecrit (PayloadWriter, JSON ou CBOR) ; un envoi durable
+        // porte alors deja son uploadId.
+        std::string body;
+        // Sinon, construit le payload sur le thread d'envoi (lots du flux de
+        // match).
+        std::function<nlohmann::json()> build;
+        bool quiet = false;   // succes non journalise (envois frequents)
+        bool durable = false; // ecrit dans le journal et retente jusqu'au succes
+    };
+
+    static constexpr size_t MAX_PENDING = 8;
+    static constexpr size_t DEFAULT_MIN_COMPRESS = 1024;
+    static constexpr std::chrono::seconds RETRY_MIN{5};
+    static constexpr std::chrono::seconds RETRY_MAX{600};
+    static constexpr size_t DRAIN_BATCH = 20;               // resultats par requete
+    static constexpr size_t DRAIN_BATCH_BYTES = 512 * 1024; // avant compression
+
+    ~UploadWorker();
+
+    void Start(LogFn logFn);
+    // Abandonne les envois en attente et interrompt l'envoi en cours.
+    void Stop();
+    // Renvoie false si la file compte deja maxPending envois ou si le thread
+    // est arrete. Une limite plus basse garde de la place pour les autres.
+    bool Enqueue(Job job, size_t maxPending = MAX_PENDING);
+    // A appeler avant Start. Les corps plus petits que minBytes partent tels quels.
+    void SetCompression(UploadCompression mode, size_t minBytes);
+    // A appeler avant Start. Chaque envoi porte l'en-tete x-signature ;
+    // un signataire sans cle envoie sans signature.
+    void SetSigner(HmacSha256 hmac);
+    // A appeler avant Start. Le journal est ouvert par le thread d'envoi.
+    void SetJournal(const std::string& path);
+    // A appeler avant Start. Duree de chaque requete, mesuree sur le thread
+    // d'envoi.
+    void SetLatency(LatencyHistogram* histogram) { latency = histogram; }
+    // Resultats encore dans le journal ; a lire apres Stop.
+    size_t Backlog() const { return journal.Pending(); }
+
+    static const char* CompressionName(UploadCompression mode);
+    static bool Available(UploadCompression mode);
+    // Renvoie false si l'algorithme n'est pas disponible ou a echoue.
+    static bool Compress(UploadCompression mode, const std::string& in, std::string& out);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Resultat journalise en attente d'un nouvel essai
+    struct Retry
+    {
+        uint64_t journalId = 0;
+        std::string url;
+        std::string body;
+        int attempts = 0;
+        Clock::time_point due;
+    };
+
+    void Run();
+    void OpenJournal();
+    void Process(CURL* curl, Job& job);
+    void Drain(CURL* curl);
+    // Classe la reponse d'un resultat journalise : termine ou a retenter.
+    void Settle(Retry retry, long status);
+    // Envoi avec repli sans compression puis en JSON sur 415.
+    long Deliver(CURL* curl, const std::string& url, const std::string& body, bool quiet, std::string* response);
+    // Renvoie le code HTTP (0 en cas d'erreur reseau).
+    long Send(CURL* curl, const std::string& url, const std::string& content, bool quiet, UploadCompression mode,
+              std::string* response);
+    void Log(const std::string& msg) const
+    {
+        if (log)
+            log(msg);
+    }
+
+    LogFn log;
+    HmacSha256 signer;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> pending;
+    bool running = false;
+    bool stopping = false;
+    UploadCompression compression = UploadCompression::Gzip;
+    size_t minCompress = DEFAULT_MIN_COMPRESS;
+    LatencyHistogram* latency = nullptr;
+
+    // Propres au thread d'envoi une fois demarre
+    UploadJournal journal;
+    std::string journalPath;
+    std::deque<Retry> retries;
+    bool batchSupported = true;
+    bool cborRefused = false; // corps CBOR convertis en JSON avant l'envoi
+    std::mt19937_64 rng{std::random_device{}()};
+};
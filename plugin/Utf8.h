@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+// Noms et identifiants venus du jeu : UTF-8 en principe, mais rien ne le
+// garantit, et une copie dans un champ de taille fixe peut couper un
+// caractere en deux. Le bot rejette un corps dont le texte n'est pas de
+// l'UTF-8 valide (JSON comme CBOR).
+
+// U+FFFD, substitue a chaque octet invalide
+static constexpr std::string_view UTF8_REPLACEMENT = "\xEF\xBF\xBD";
+
+// Longueur de la sequence UTF-8 valide qui commence a `p` (1 a 4), ou 0 si
+// l'octet ne commence pas une sequence complete et bien formee (octet de
+// continuation isole, forme trop longue, substitut UTF-16, au-dela de
+// U+10FFFF, sequence coupee).
+inline size_t Utf8SequenceLength(const unsigned char* p, size_t left)
+{
+    unsigned char c = p[0];
+    if (c < 0x80)
+        return 1;
+    size_t length;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf)
+        length = 2;
+    else if (c >= 0xe0 && c <= 0xef)
+    {
+        length = 3;
+        if (c == 0xe0)
+            low = 0xa0;
+        else if (c == 0xed)
+            high = 0x9f;
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+        length = 4;
+        if (c == 0xf0)
+            low = 0x90;
+        else if (c == 0xf4)
+            high = 0x8f;
+    }
+    else
+        return 0;
+    if (left < length || p[1] < low || p[1] > high)
+        return 0;
+    for (size_t i = 2; i < length; ++i)
+        if ((p[i] & 0xc0) != 0x80)
+            return 0;
+    return length;
+}
+
+inline bool Utf8Valid(std::string_view text)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    for (size_t i = 0; i < text.size();)
+    {
+        size_t n = Utf8SequenceLength(p + i, text.size() - i);
+        if (n == 0)
+            return false;
+        i += n;
+    }
+    return true;
+}
+
+// Plus longue tete de `text` d'au plus `max` octets qui ne coupe pas un
+// caractere.
+inline size_t Utf8Prefix(std::string_view text, size_t max)
+{
+    if (text.size() <= max)
+        return text.size();
+    size_t n = max;
+    while (n > 0 && (static_cast<unsigned char>(text[n]) & 0xc0) == 0x80)
+        --n;
+    return n;
+}
@@ -0,0 +1,172 @@
+#include "XGBatch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define XG_X86 1
+#include "XGBatchSimd.h"
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+void XGShotBatch::Reserve(size_t n)
+{
+    distance.reserve(n);
+    cosAngle.reserve(n);
+    ballSpeed.reserve(n);
+    playerBoost.reserve(n);
+    flags.reserve(n);
+    for (int l = 0; l < XG_DEFENDER_LANES; ++l)
+    {
+        defenderDistance[l].reserve(n);
+        defenderBoost[l].reserve(n);
+    }
+}
+
+void XGShotBatch::Add(float dist, float cosAng, float speed, float boost, uint8_t shotFlags, const std::vector<DefenderInfo>& defenders)
+{
+    distance.push_back(dist);
+    cosAngle.push_back(cosAng);
+    ballSpeed.push_back(speed);
+    playerBoost.push_back(boost);
+    flags.push_back(shotFlags);
+    for (int l = 0; l < XG_DEFENDER_LANES; ++l)
+    {
+        bool present = l < static_cast<int>(defenders.size());
+        defenderDistance[l].push_back(present ? defenders[l].distance : XG_NO_DEFENDER);
+        defenderBoost[l].push_back(present ? defenders[l].boost : 0.f);
+    }
+}
+
+// Copie conforme de ComputeXGAdvanced, defenseurs en voies : memes
+// operations dans le meme ordre, donc meme resultat au bit pres.
+static float ComputeXGRow(const XGShotBatch& s, size_t i)
+{
+    float angle = std::acos(std::clamp(s.cosAngle[i], -1.f, 1.f));
+    uint8_t f = s.flags[i];
+
+    float xg = 0.05f;
+    xg += std::exp(-s.distance[i] / 2500.f) * 0.25f;
+    xg += std::clamp(1.f - angle / 1.57f, 0.f, 1.f) * 0.2f;
+    xg += std::clamp(s.ballSpeed[i] / 4000.f, 0.f, 1.f) * 0.05f;
+    if (s.playerBoost[i] > 20.f)
+        xg += 0.02f;
+
+    if (f & XG_OPEN_NET)
+    {
+        float openBonus = 0.25f;
+        for (int l = 0; l < XG_DEFENDER_LANES; ++l)
+        {
+            float d = s.defenderDistance[l][i];
+            if (d < 1000.f)
+                openBonus -= 0.1f;
+            else if (d < 1500.f)
+                openBonus -= 0.05f;
+        }
+        if (openBonus > 0.f)
+            xg += openBonus;
+    }
+
+    int defCount = 0;
+    for (int l = 0; l < XG_DEFENDER_LANES; ++l)
+    {
+        if (s.defenderDistance[l][i] < 1500.f && s.defenderBoost[l][i] > 30.f && defCount < 3)
+        {
+            xg -= 0.04f;
+            ++defCount;
+        }
+    }
+
+    if (f & XG_HARD_REBOUND)
+        xg -= 0.05f;
+    if (f & XG_PANIC_SHOT)
+        xg -= 0.05f;
+    if (f & XG_QUALITY)
+        xg += 0.05f;
+
+    return std::clamp(xg, 0.f, 0.95f);
+}
+
+#ifdef XG_X86
+
+size_t ComputeXGSse2(const XGColumns& s, float* out)
+{
+    return XGComputeVector<Sse2Ops>(s, out);
+}
+
+static XGColumns Columns(const XGShotBatch& shots)
+{
+    static_assert(XG_SIMD_LANES == XG_DEFENDER_LANES, "voies de defenseurs");
+    XGColumns c{};
+    c.count = shots.Size();
+    c.distance = shots.distance.data();
+    c.cosAngle = shots.cosAngle.data();
+    c.ballSpeed = shots.ballSpeed.data();
+    c.playerBoost = shots.playerBoost.data();
+    c.flags = shots.flags.data();
+    for (int l = 0; l < XG_DEFENDER_LANES; ++l)
+    {
+        c.defenderDistance[l] = shots.defenderDistance[l].data();
+        c.defenderBoost[l] = shots.defenderBoost[l].data();
+    }
+    c.openNetBit = XG_OPEN_NET;
+    c.hardReboundBit = XG_HARD_REBOUND;
+    c.panicShotBit = XG_PANIC_SHOT;
+    c.qualityBit = XG_QUALITY;
+    return c;
+}
+
+static bool CpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // XG_X86
+
+XGKernel XGBestKernel()
+{
+#ifdef XG_X86
+    static const XGKernel best = CpuHasAvx2() ? XGKernel::AVX2 : XGKernel::SSE2;
+    return best;
+#else
+    return XGKernel::Scalar;
+#endif
+}
+
+const char* XGKernelName(XGKernel kernel)
+{
+    switch (kernel)
+    {
+    case XGKernel::Scalar: return "scalaire";
+    case XGKernel::SSE2: return "sse2";
+    case XGKernel::AVX2: return "avx2";
+    }
+    return "?";
+}
+
+void ComputeXGBatch(const XGShotBatch& shots, float* out, XGKernel kernel)
+{
+    size_t done = 0;
+#ifdef XG_X86
+    if (kernel == XGKernel::AVX2 && XGBestKernel() == XGKernel::AVX2)
+        done = ComputeXGAvx2(Columns(shots), out);
+    else if (kernel != XGKernel::Scalar)
+        done = ComputeXGSse2(Columns(shots), out);
+#else
+    (void)kernel;
+#endif
+    // Reste du lot (ou tout le lot en scalaire)
+    for (size_t i = done; i < shots.Size(); ++i)
+        out[i] = ComputeXGRow(shots, i);
+}
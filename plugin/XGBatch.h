@@ -0,0 +1,58 @@
+#pragma once
+#include "MatchAnalytics.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Calcul d'xG par lots pour rejouer un modele sur des historiques de tirs.
+//
+// Les tirs sont ranges en colonnes (un tableau par grandeur) et les
+// defenseurs en XG_DEFENDER_LANES voies de taille fixe ; une voie sans
+// defenseur porte la distance XG_NO_DEFENDER. Le noyau reproduit
+// MatchAnalytics::ComputeXGAdvanced avec angle = acos(cosAngle) :
+//  - la version scalaire donne exactement le meme resultat, bit a bit ;
+//  - les versions SSE2 / AVX2 utilisent des approximations polynomiales
+//    de exp et acos (1 a 2 ulp) et restent a XG_BATCH_TOLERANCE pres.
+
+static constexpr int XG_DEFENDER_LANES = MAX_PLAYERS / 2;
+static constexpr float XG_NO_DEFENDER = 3.0e38f;
+static constexpr float XG_BATCH_TOLERANCE = 1e-6f;
+
+enum XGShotFlags : uint8_t
+{
+    XG_AERIAL = 1 << 0, // conserve pour le modele, sans effet aujourd'hui
+    XG_HARD_REBOUND = 1 << 1,
+    XG_PANIC_SHOT = 1 << 2,
+    XG_OPEN_NET = 1 << 3,
+    XG_QUALITY = 1 << 4
+};
+
+struct XGShotBatch
+{
+    std::vector<float> distance;
+    std::vector<float> cosAngle; // cosinus entre direction de la balle et du but
+    std::vector<float> ballSpeed;
+    std::vector<float> playerBoost;
+    std::vector<uint8_t> flags; // XGShotFlags
+    std::vector<float> defenderDistance[XG_DEFENDER_LANES];
+    std::vector<float> defenderBoost[XG_DEFENDER_LANES];
+
+    size_t Size() const { return distance.size(); }
+    void Reserve(size_t n);
+    // Ajoute un tir ; seuls les XG_DEFENDER_LANES premiers defenseurs sont gardes.
+    void Add(float dist, float cosAng, float speed, float boost, uint8_t shotFlags, const std::vector<DefenderInfo>& defenders);
+};
+
+enum class XGKernel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Meilleur noyau disponible sur le processeur courant.
+XGKernel XGBestKernel();
+const char* XGKernelName(XGKernel kernel);
+
+// Ecrit shots.Size() valeurs dans `out`.
+void ComputeXGBatch(const XGShotBatch& shots, float* out, XGKernel kernel = XGBestKernel());
@@ -0,0 +1,9 @@
+// Noyau AVX2 de XGBatch : seul fichier a compiler avec -mavx2 (GCC / Clang).
+// Il n'est appele qu'apres verification du processeur (XGBestKernel).
+#define XG_WITH_AVX2
+#include "XGBatchSimd.h"
+
+size_t ComputeXGAvx2(const XGColumns& s, float* out)
+{
+    return XGComputeVector<Avx2Ops>(s, out);
+}
@@ -0,0 +1,206 @@
+#pragma once
+// Noyau vectoriel interne de XGBatch, partage entre XGBatch.cpp (SSE2) et
+// XGBatchAvx2.cpp (AVX2, compile avec -mavx2). Ce fichier n'utilise que des
+// pointeurs bruts : aucune fonction inline de la bibliotheque standard ne doit
+// etre instanciee avec les options AVX2, sous peine d'etre retenue par
+// l'editeur de liens pour tout le programme.
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static constexpr int XG_SIMD_LANES = 4; // XG_DEFENDER_LANES
+
+struct XGColumns
+{
+    size_t count;
+    const float* distance;
+    const float* cosAngle;
+    const float* ballSpeed;
+    const float* playerBoost;
+    const uint8_t* flags;
+    const float* defenderDistance[XG_SIMD_LANES];
+    const float* defenderBoost[XG_SIMD_LANES];
+    uint8_t openNetBit;
+    uint8_t hardReboundBit;
+    uint8_t panicShotBit;
+    uint8_t qualityBit;
+};
+
+// Renvoie le nombre de tirs traites (multiple de la largeur du vecteur).
+size_t ComputeXGSse2(const XGColumns& s, float* out);
+size_t ComputeXGAvx2(const XGColumns& s, float* out);
+
+// Le noyau est ecrit une fois au-dessus d'un jeu d'operations elementaires :
+// Sse2Ops (4 voies) ou Avx2Ops (8 voies). Chaque unite de compilation ne
+// definit que le sien.
+#ifndef XG_WITH_AVX2
+struct Sse2Ops
+{
+    using V = __m128;
+    using I = __m128i;
+    static constexpr int W = 4;
+
+    static V Set(float v) { return _mm_set1_ps(v); }
+    static V Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V Add(V a, V b) { return _mm_add_ps(a, b); }
+    static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V Div(V a, V b) { return _mm_div_ps(a, b); }
+    static V Min(V a, V b) { return _mm_min_ps(a, b); }
+    static V Max(V a, V b) { return _mm_max_ps(a, b); }
+    static V Sqrt(V a) { return _mm_sqrt_ps(a); }
+    static V Lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+    static V Gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static V And(V a, V b) { return _mm_and_ps(a, b); }
+    static V AndNot(V a, V b) { return _mm_andnot_ps(a, b); }
+    static V Or(V a, V b) { return _mm_or_ps(a, b); }
+    static V Select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static I ToInt(V a) { return _mm_cvttps_epi32(a); }
+    static V ToFloat(I a) { return _mm_cvtepi32_ps(a); }
+    static V Pow2(I n) { return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23)); }
+    static V FlagMask(const uint8_t* p, uint8_t bit)
+    {
+        __m128i v = _mm_setr_epi32(p[0], p[1], p[2], p[3]);
+        __m128i b = _mm_set1_epi32(bit);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(v, b), b));
+    }
+};
+#else
+struct Avx2Ops
+{
+    using V = __m256;
+    using I = __m256i;
+    static constexpr int W = 8;
+
+    static V Set(float v) { return _mm256_set1_ps(v); }
+    static V Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V Div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V Min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V Max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V Sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static V Lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V Gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V And(V a, V b) { return _mm256_and_ps(a, b); }
+    static V AndNot(V a, V b) { return _mm256_andnot_ps(a, b); }
+    static V Or(V a, V b) { return _mm256_or_ps(a, b); }
+    static V Select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+    static I ToInt(V a) { return _mm256_cvttps_epi32(a); }
+    static V ToFloat(I a) { return _mm256_cvtepi32_ps(a); }
+    static V Pow2(I n) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23)); }
+    static V FlagMask(const uint8_t* p, uint8_t bit)
+    {
+        long long bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        __m256i v = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(bytes));
+        __m256i b = _mm256_set1_epi32(bit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(v, b), b));
+    }
+};
+#endif
+
+// exp (Cephes expf) : x = n ln2 + r, |r| <= ln2 / 2, puis 2^n * P(r).
+template <typename O>
+static inline typename O::V XGVecExp(typename O::V x)
+{
+    using V = typename O::V;
+    x = O::Min(O::Max(x, O::Set(-87.3f)), O::Set(88.3f));
+    V fx = O::Add(O::Mul(x, O::Set(1.44269504088896341f)), O::Set(0.5f));
+    // floor : la troncature arrondit vers zero
+    V t = O::ToFloat(O::ToInt(fx));
+    fx = O::Sub(t, O::And(O::Gt(t, fx), O::Set(1.f)));
+    x = O::Sub(x, O::Mul(fx, O::Set(0.693359375f)));
+    x = O::Sub(x, O::Mul(fx, O::Set(-2.12194440e-4f)));
+
+    V y = O::Set(1.9875691500e-4f);
+    y = O::Add(O::Mul(y, x), O::Set(1.3981999507e-3f));
+    y = O::Add(O::Mul(y, x), O::Set(8.3334519073e-3f));
+    y = O::Add(O::Mul(y, x), O::Set(4.1665795894e-2f));
+    y = O::Add(O::Mul(y, x), O::Set(1.6666665459e-1f));
+    y = O::Add(O::Mul(y, x), O::Set(5.0000001201e-1f));
+    y = O::Add(O::Add(O::Mul(O::Mul(y, x), x), x), O::Set(1.f));
+    return O::Mul(y, O::Pow2(O::ToInt(fx)));
+}
+
+// acos (Cephes acosf) a partir de asin sur [0, 0.5] ; au-dela,
+// acos(a) = 2 asin(sqrt((1 - a) / 2)) et acos(-a) = pi - acos(a).
+template <typename O>
+static inline typename O::V XGVecAcos(typename O::V x)
+{
+    using V = typename O::V;
+    const V half = O::Set(0.5f);
+    V sign = O::Lt(x, O::Set(0.f));
+    V a = O::AndNot(O::Set(-0.f), x);
+    V big = O::Gt(a, half);
+    V z = O::Select(big, O::Mul(half, O::Sub(O::Set(1.f), a)), O::Mul(a, a));
+    V s = O::Select(big, O::Sqrt(z), a);
+
+    V p = O::Set(4.2163199048e-2f);
+    p = O::Add(O::Mul(p, z), O::Set(2.4181311049e-2f));
+    p = O::Add(O::Mul(p, z), O::Set(4.5470025998e-2f));
+    p = O::Add(O::Mul(p, z), O::Set(7.4953002686e-2f));
+    p = O::Add(O::Mul(p, z), O::Set(1.6666752422e-1f));
+    V r = O::Add(O::Mul(O::Mul(p, z), s), s); // asin(s)
+
+    V bigRes = O::Add(r, r);
+    bigRes = O::Select(sign, O::Sub(O::Set(3.14159265358979f), bigRes), bigRes);
+    V smallRes = O::Sub(O::Set(1.57079632679490f), O::Select(sign, O::Sub(O::Set(0.f), r), r));
+    return O::Select(big, bigRes, smallRes);
+}
+
+// Meme formule que ComputeXGAdvanced, termes ajoutes dans le meme ordre.
+template <typename O>
+static inline size_t XGComputeVector(const XGColumns& s, float* out)
+{
+    using V = typename O::V;
+    const V zero = O::Set(0.f);
+    const V one = O::Set(1.f);
+    size_t i = 0;
+    for (; i + O::W <= s.count; i += O::W)
+    {
+        V cosAng = O::Min(O::Max(O::Load(s.cosAngle + i), O::Set(-1.f)), one);
+        V angle = XGVecAcos<O>(cosAng);
+
+        V xg = O::Set(0.05f);
+        V dist = O::Load(s.distance + i);
+        xg = O::Add(xg, O::Mul(XGVecExp<O>(O::Div(O::Sub(zero, dist), O::Set(2500.f))), O::Set(0.25f)));
+        V angTerm = O::Sub(one, O::Div(angle, O::Set(1.57f)));
+        xg = O::Add(xg, O::Mul(O::Min(O::Max(angTerm, zero), one), O::Set(0.2f)));
+        V speedTerm = O::Div(O::Load(s.ballSpeed + i), O::Set(4000.f));
+        xg = O::Add(xg, O::Mul(O::Min(O::Max(speedTerm, zero), one), O::Set(0.05f)));
+        xg = O::Add(xg, O::And(O::Gt(O::Load(s.playerBoost + i), O::Set(20.f)), O::Set(0.02f)));
+
+        // Les voies sont parcourues dans l'ordre des defenseurs
+        V openBonus = O::Set(0.25f);
+        V defDist[XG_SIMD_LANES];
+        for (int l = 0; l < XG_SIMD_LANES; ++l)
+        {
+            defDist[l] = O::Load(s.defenderDistance[l] + i);
+            V close = O::Lt(defDist[l], O::Set(1000.f));
+            V mid = O::AndNot(close, O::Lt(defDist[l], O::Set(1500.f)));
+            openBonus = O::Sub(openBonus, O::Or(O::And(close, O::Set(0.1f)), O::And(mid, O::Set(0.05f))));
+        }
+        V open = O::FlagMask(s.flags + i, s.openNetBit);
+        xg = O::Add(xg, O::And(O::And(open, O::Gt(openBonus, zero)), openBonus));
+
+        V defCount = zero;
+        for (int l = 0; l < XG_SIMD_LANES; ++l)
+        {
+            V counts = O::And(O::Lt(defDist[l], O::Set(1500.f)), O::Gt(O::Load(s.defenderBoost[l] + i), O::Set(30.f)));
+            counts = O::And(counts, O::Lt(defCount, O::Set(3.f)));
+            xg = O::Sub(xg, O::And(counts, O::Set(0.04f)));
+            defCount = O::Add(defCount, O::And(counts, one));
+        }
+
+        xg = O::Sub(xg, O::And(O::FlagMask(s.flags + i, s.hardReboundBit), O::Set(0.05f)));
+        xg = O::Sub(xg, O::And(O::FlagMask(s.flags + i, s.panicShotBit), O::Set(0.05f)));
+        xg = O::Add(xg, O::And(O::FlagMask(s.flags + i, s.qualityBit), O::Set(0.05f)));
+        O::Store(out + i, O::Min(O::Max(xg, zero), O::Set(0.95f)));
+    }
+    return i;
+}
@@ -0,0 +1,670 @@
+// Mesure les chemins chauds du calcul des statistiques a partir de frames
+// synthetiques 1v1, 2v2 et 3v3 : echantillon periodique (TickStats), touche de
+// balle (OnHitBall, avec ou sans tir et donc DetectShotContext), calcul d'xG,
+// instrumentation d'un hook (PerfScope) et ecriture du payload de fin de
+// match en JSON et en CBOR (WritePayload). Ces calculs se font sur le thread
+// d'analyse ; le cout restant sur le thread du jeu, le depot d'une frame dans
+// la file d'AnalyticsWorker, est mesure a part (Worker/*).
+//
+//   auusa_bench [--iterations N] [--json resultats.json] [--baseline reference.json]
+//               [--tolerance 0.10]
+//
+// Le calcul d'xG par lots (XGBatch) est mesure par tir pour chaque noyau
+// disponible et compare au calcul scalaire sur un jeu de tirs aleatoires.
+// Le cout d'un message de journal est mesure avec l'ancienne ecriture
+// synchrone (flush a chaque ligne) et avec AsyncLog. La signature HMAC-SHA256
+// d'un corps de resultat est verifiee sur les vecteurs de la RFC 4231 puis
+// mesuree avec recalcul de la cle a chaque appel (comme l'ancien appel
+// BCrypt) et avec les etats de cle precalcules, pour chaque version de
+// SHA-256 disponible.
+//
+// Pour chaque cas : ns/op moyen, p50, p99 et allocations par appel. --json
+// enregistre les resultats (a conserver comme reference), --baseline compare
+// a une reference et signale les regressions au-dela de la tolerance. Le code
+// de sortie est non nul si le pire cas par frame depasse le budget de 50 us ou
+// si une regression est detectee.
+#include "../AnalyticsWorker.h"
+#include "../AsyncLog.h"
+#include "../BallPredictor.h"
+#include "../MatchAnalytics.h"
+#include "../PerfStats.h"
+#include "../Sha256.h"
+#include "../XGBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Compteur d'allocations, atomique a cause du thread d'ecriture d'AsyncLog.
+// GCC signale a tort la paire operator new / free que nous definissons
+// nous-memes.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static constexpr float FRAME_BUDGET_NS = 50000.f;
+static constexpr int FRAME_POOL = 256;
+
+// Generateur deterministe : les resultats doivent etre comparables d'une
+// execution a l'autre.
+struct Lcg
+{
+    uint32_t state = 12345;
+    float Next(float lo, float hi)
+    {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * ((state >> 8) / 16777216.f);
+    }
+};
+
+struct BenchResult
+{
+    std::string name;
+    int teamSize = 0;
+    double meanNs = 0.0;
+    double p50Ns = 0.0;
+    double p99Ns = 0.0;
+    double allocsPerOp = 0.0;
+};
+
+// Frames synthetiques : joueurs repartis sur tout le terrain, balle en
+// mouvement. Avec `shots`, la balle part vers le but adverse de l'equipe du
+// joueur 0 pour declencher l'analyse de tir.
+static std::vector<FrameSnapshot> MakeFrames(int teamSize, bool shots, Lcg& rng)
+{
+    std::vector<FrameSnapshot> frames(FRAME_POOL);
+    for (int n = 0; n < FRAME_POOL; ++n)
+    {
+        FrameSnapshot& f = frames[n];
+        f.time = 1.f + n / 20.f;
+        f.hasBall = true;
+        f.ballPos = {rng.Next(-800.f, 800.f), rng.Next(-4000.f, 4000.f), rng.Next(93.f, 1500.f)};
+        f.ballVel = {rng.Next(-300.f, 300.f), shots ? rng.Next(1500.f, 3000.f) : rng.Next(-2500.f, 2500.f), rng.Next(-600.f, 600.f)};
+        for (int i = 0; i < teamSize * 2; ++i)
+        {
+            int k = f.count++;
+            f.slot[k] = i;
+            f.pri[k] = static_cast<uintptr_t>(i) + 1;
+            f.indexOfSlot[i] = k;
+            f.team[k] = i < teamSize ? 0 : 1;
+            f.hasCar[k] = true;
+            f.pos[k] = {rng.Next(-4000.f, 4000.f), rng.Next(-5000.f, 5000.f), rng.Next(17.f, 600.f)};
+            f.vel[k] = {rng.Next(-2300.f, 2300.f), rng.Next(-2300.f, 2300.f), rng.Next(-500.f, 500.f)};
+            f.boost[k] = rng.Next(0.f, 100.f);
+            f.onGround[k] = rng.Next(0.f, 1.f) < 0.7f;
+            f.saves[k] = 0;
+        }
+    }
+    return frames;
+}
+
+static void SetupMatch(MatchAnalytics& analytics, int teamSize, const FrameSnapshot& first)
+{
+    analytics.Reset();
+    for (int i = 0; i < teamSize * 2; ++i)
+        analytics.AssignPlayer(i, "uid" + std::to_string(i), "Joueur " + std::to_string(i), i < teamSize ? 0 : 1);
+    analytics.OnMatchStart(first);
+    analytics.SetPhase(GamePhase::Live);
+}
+
+static BenchResult Summarize(const std::string& name, int teamSize, std::vector<double>& samples, size_t allocs, double ops);
+
+// Chronometre `batch` appels consecutifs par mesure : les operations tres
+// courtes (xG) restent ainsi au-dessus de la resolution de l'horloge.
+template <typename Fn>
+static BenchResult Measure(const std::string& name, int teamSize, int iterations, int batch, Fn&& fn)
+{
+    for (int i = 0; i < iterations / 10 + 1; ++i)
+        fn(i);
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    size_t allocsInSamples = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        size_t before = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < batch; ++b)
+            fn(i * batch + b);
+        auto end = std::chrono::steady_clock::now();
+        allocsInSamples += allocationCount - before;
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batch);
+    }
+    return Summarize(name, teamSize, samples, allocsInSamples, static_cast<double>(iterations) * batch);
+}
+
+static BenchResult Summarize(const std::string& name, int teamSize, std::vector<double>& samples, size_t allocs, double ops)
+{
+    BenchResult r;
+    r.name = name;
+    r.teamSize = teamSize;
+    double total = 0.0;
+    for (double s : samples)
+        total += s;
+    r.meanNs = total / samples.size();
+    std::sort(samples.begin(), samples.end());
+    r.p50Ns = samples[samples.size() / 2];
+    r.p99Ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    r.allocsPerOp = static_cast<double>(allocs) / ops;
+    return r;
+}
+
+// Cout sur le thread du jeu d'un hook relaye a AnalyticsWorker : copie de la
+// frame dans la file. Les depots se font par rafales plus courtes que la
+// file, videe entre deux rafales hors mesure, pour ne pas mesurer l'attente
+// d'une case libre.
+static BenchResult MeasureWorker(const std::string& name, int teamSize, int iterations,
+                                 std::vector<FrameSnapshot>& frames, bool touch)
+{
+    static constexpr int BURST = static_cast<int>(AnalyticsWorker::CAPACITY / 2);
+    AnalyticsWorker worker;
+    worker.Start(nullptr);
+    worker.Reset();
+    for (int i = 0; i < teamSize * 2; ++i)
+        worker.AssignPlayer(i, "uid" + std::to_string(i), "Joueur " + std::to_string(i), i < teamSize ? 0 : 1);
+    worker.OnMatchStart(frames[0]);
+    worker.SetPhase(GamePhase::Live);
+    worker.Drain();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    size_t allocs = 0;
+    float time = 1.f;
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (i % BURST == 0)
+            worker.Drain();
+        FrameSnapshot& f = frames[i % FRAME_POOL];
+        time += 0.05f;
+        f.time = time;
+        size_t before = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        if (touch)
+            worker.OnTouch(f, 0);
+        else
+            worker.Sample(f);
+        auto end = std::chrono::steady_clock::now();
+        allocs += allocationCount - before;
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    worker.Stop();
+    return Summarize(name, teamSize, samples, allocs, iterations);
+}
+
+static std::vector<BenchResult> RunTeamSize(int teamSize, int iterations)
+{
+    std::vector<BenchResult> results;
+    Lcg rng;
+    rng.state += teamSize;
+    std::vector<FrameSnapshot> frames = MakeFrames(teamSize, false, rng);
+    std::vector<FrameSnapshot> shotFrames = MakeFrames(teamSize, true, rng);
+    int players = teamSize * 2;
+
+    {
+        MatchAnalytics analytics;
+        SetupMatch(analytics, teamSize, frames[0]);
+        float time = 1.f;
+        results.push_back(Measure("TickStats", teamSize, iterations, 1, [&](int i) {
+            FrameSnapshot& f = frames[i % FRAME_POOL];
+            time += 0.05f;
+            f.time = time;
+            analytics.Sample(f);
+        }));
+    }
+    {
+        // Mise a jour d'une carte de presence, joueur par joueur
+        Heatmap maps[MAX_PLAYERS];
+        results.push_back(Measure("Heatmap/Add", teamSize, iterations, 64, [&](int i) {
+            const FrameSnapshot& f = frames[(i / players) % FRAME_POOL];
+            int p = i % players;
+            maps[p].Add(f.pos[p].X, f.pos[p].Y, 5);
+        }));
+        volatile uint32_t sink = 0;
+        for (const Heatmap& map : maps)
+            for (uint16_t cell : map.cells)
+                sink = sink + cell;
+    }
+    {
+        MatchAnalytics analytics;
+        SetupMatch(analytics, teamSize, frames[0]);
+        float time = 1.f;
+        results.push_back(Measure("OnHitBall", teamSize, iterations, 1, [&](int i) {
+            FrameSnapshot& f = frames[i % FRAME_POOL];
+            time += 0.05f;
+            f.time = time;
+            analytics.OnTouch(f, i % players);
+        }));
+    }
+    {
+        // Tirs : touches du joueur 0 (equipe bleue) vers le but orange
+        MatchAnalytics analytics;
+        SetupMatch(analytics, teamSize, shotFrames[0]);
+        float time = 1.f;
+        results.push_back(Measure("OnHitBall+tir", teamSize, iterations, 1, [&](int i) {
+            FrameSnapshot& f = shotFrames[i % FRAME_POOL];
+            time += 0.05f;
+            f.time = time;
+            analytics.OnTouch(f, 0);
+        }));
+    }
+    {
+        std::vector<DefenderInfo> defenders;
+        for (int i = 0; i < teamSize; ++i)
+            defenders.push_back({Vec3{rng.Next(-2000.f, 2000.f), 4000.f, 17.f}, rng.Next(0.f, 100.f), i % 2 == 0, rng.Next(300.f, 2000.f)});
+        volatile float sink = 0.f;
+        results.push_back(Measure("ComputeXGAdvanced", teamSize, iterations, 64, [&](int i) {
+            float d = 500.f + (i % 64) * 80.f;
+            sink = sink + MatchAnalytics::ComputeXGAdvanced(d, 0.3f, 2200.f, 40.f, i % 3 == 0, defenders, false, false, i % 5 == 0, true);
+        }));
+    }
+    {
+        // Trajectoire apres une touche, tirs compris
+        volatile int sink = 0;
+        results.push_back(Measure("PredictBall", teamSize, iterations, 1, [&](int i) {
+            const FrameSnapshot& f = (i & 1 ? shotFrames : frames)[(i / 2) % FRAME_POOL];
+            sink = sink + PredictBall(f.ballPos, f.ballVel).goalSide;
+        }));
+    }
+    {
+        // Instrumentation d'un hook (mm_perf) : deux lectures d'horloge et
+        // une case d'histogramme
+        LatencyHistogram histogram;
+        results.push_back(Measure("PerfScope", teamSize, iterations, 64, [&](int) {
+            PerfScope scope(&histogram);
+        }));
+    }
+    for (bool shots : {false, true})
+        results.push_back(MeasureWorker(shots ? "Worker/OnHitBall+tir" : "Worker/TickStats", teamSize, iterations,
+                                        shots ? shotFrames : frames, shots));
+    {
+        // Payload d'un match complet : ~5 minutes d'echantillons et de touches
+        MatchAnalytics analytics;
+        SetupMatch(analytics, teamSize, frames[0]);
+        for (int i = 0; i < 6000; ++i)
+        {
+            FrameSnapshot& f = frames[i % FRAME_POOL];
+            f.time = 1.f + i / 20.f;
+            analytics.Sample(f);
+            if (i % 10 == 0)
+                analytics.OnTouch(f, i % players);
+        }
+        MatchSummary summary;
+        summary.scoreBlue = 3;
+        summary.scoreOrange = 2;
+        summary.teamBlue = "Bleus";
+        summary.teamOrange = "Oranges";
+        summary.map = "Stadium_P";
+        summary.secondsElapsed = 300.f;
+        summary.totalGameTime = 300.f;
+        for (int i = 0; i < players; ++i)
+        {
+            ScoreboardLine line;
+            line.slot = i;
+            line.name = analytics.PlayerName(i);
+            line.team = i < teamSize ? 0 : 1;
+            line.score = 100 + i * 37;
+            summary.players.push_back(line);
+        }
+        PayloadExtras extras;
+        extras.playedAt = 1700000000;
+        extras.uploadId = 12345678901234567890ull;
+        PayloadWriter writer;
+        for (PayloadFormat format : {PayloadFormat::Json, PayloadFormat::Cbor})
+        {
+            results.push_back(Measure(std::string("WritePayload/") + PayloadFormatName(format), teamSize,
+                                      std::max(iterations / 20, 50), 1, [&](int) {
+                writer.Reset(format);
+                analytics.WritePayload(summary, extras, writer);
+            }));
+            std::printf("Payload %dv%d %s : %zu octets%s\n", teamSize, teamSize, PayloadFormatName(format),
+                        writer.Data().size(), writer.Valid() ? "" : "  INVALIDE");
+        }
+    }
+    return results;
+}
+
+static void BuildShots(XGShotBatch& shots, std::vector<float>& reference, size_t count, Lcg& rng)
+{
+    shots.Reserve(count);
+    reference.reserve(count);
+    std::vector<DefenderInfo> defenders;
+    for (size_t i = 0; i < count; ++i)
+    {
+        defenders.clear();
+        int n = static_cast<int>(rng.Next(0.f, XG_DEFENDER_LANES + 0.99f));
+        for (int d = 0; d < n; ++d)
+            defenders.push_back({Vec3{}, rng.Next(0.f, 100.f), false, rng.Next(100.f, 2000.f)});
+        float dist = rng.Next(200.f, 9000.f);
+        float cosAng = rng.Next(-1.f, 1.f);
+        float speed = rng.Next(0.f, 6000.f);
+        float boost = rng.Next(0.f, 100.f);
+        uint8_t flags = static_cast<uint8_t>(rng.Next(0.f, 31.99f));
+        shots.Add(dist, cosAng, speed, boost, flags, defenders);
+        reference.push_back(MatchAnalytics::ComputeXGAdvanced(dist, std::acos(std::clamp(cosAng, -1.f, 1.f)), speed, boost,
+                                                              flags & XG_AERIAL, defenders, flags & XG_HARD_REBOUND,
+                                                              flags & XG_PANIC_SHOT, flags & XG_OPEN_NET, flags & XG_QUALITY));
+    }
+}
+
+// Mesure chaque noyau par tir et verifie l'ecart au calcul scalaire :
+// nul pour le noyau scalaire, borne par XG_BATCH_TOLERANCE sinon.
+static bool RunXGBatch(int iterations, std::vector<BenchResult>& results)
+{
+    static constexpr size_t SHOTS = 4096;
+    Lcg rng;
+    XGShotBatch shots;
+    std::vector<float> reference;
+    BuildShots(shots, reference, 100000, rng);
+    std::vector<float> out(shots.Size());
+
+    bool ok = true;
+    std::vector<XGKernel> kernels = {XGKernel::Scalar};
+    if (XGBestKernel() != XGKernel::Scalar)
+        kernels.push_back(XGKernel::SSE2);
+    if (XGBestKernel() == XGKernel::AVX2)
+        kernels.push_back(XGKernel::AVX2);
+    for (XGKernel kernel : kernels)
+    {
+        ComputeXGBatch(shots, out.data(), kernel);
+        float maxError = 0.f;
+        for (size_t i = 0; i < out.size(); ++i)
+            maxError = std::max(maxError, std::fabs(out[i] - reference[i]));
+        bool valid = kernel == XGKernel::Scalar ? maxError == 0.f : maxError <= XG_BATCH_TOLERANCE;
+        std::printf("xG par lots (%s) : ecart max %.3g%s\n", XGKernelName(kernel), maxError, valid ? "" : "  HORS TOLERANCE");
+        ok = ok && valid;
+    }
+
+    XGShotBatch slice;
+    std::vector<float> sliceRef;
+    BuildShots(slice, sliceRef, SHOTS, rng);
+    for (XGKernel kernel : kernels)
+    {
+        BenchResult r = Measure(std::string("XGBatch/") + XGKernelName(kernel), 3, std::max(iterations / 20, 50), 1, [&](int) {
+            ComputeXGBatch(slice, out.data(), kernel);
+        });
+        r.meanNs /= SHOTS;
+        r.p50Ns /= SHOTS;
+        r.p99Ns /= SHOTS;
+        r.allocsPerOp /= SHOTS;
+        results.push_back(r);
+    }
+    return ok;
+}
+
+// Vecteurs de test de la RFC 4231 (cas 1, 2 et 6 : cle plus longue qu'un bloc)
+struct HmacVector
+{
+    std::string key;
+    std::string data;
+    const char* expected;
+};
+
+static bool RunHmac(int iterations, std::vector<BenchResult>& results)
+{
+    static constexpr size_t BODY_SIZE = 6 * 1024; // resultat 3v3 typique
+    const HmacVector vectors[] = {
+        {std::string(20, '\x0b'), "Hi There", "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+        {"Jefe", "what do ya want for nothing?", "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+        {std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+         "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"}};
+
+    std::vector<Sha256Kernel> kernels = {Sha256Kernel::Scalar};
+    if (Sha256BestKernel() == Sha256Kernel::ShaNi)
+        kernels.push_back(Sha256Kernel::ShaNi);
+
+    Lcg rng;
+    std::string body(BODY_SIZE, '\0');
+    for (char& c : body)
+        c = static_cast<char>(rng.Next(32.f, 126.f));
+    const std::string key = "secret-de-test-du-bot";
+    const std::string expected = HmacSha256(key, Sha256Kernel::Scalar).Sign(body);
+
+    bool ok = true;
+    for (Sha256Kernel kernel : kernels)
+    {
+        int failures = 0;
+        for (const HmacVector& v : vectors)
+            failures += HmacSha256(v.key, kernel).Sign(v.data) != v.expected;
+        // Signature incrementale par morceaux de tailles irregulieres
+        HmacSha256 signer(key, kernel);
+        for (size_t pos = 0, step = 1; pos < body.size(); pos += step, step = step * 3 % 97 + 1)
+            signer.Update(body.data() + pos, std::min(step, body.size() - pos));
+        failures += signer.HexDigest() != expected;
+        failures += signer.Sign(body) != expected;
+        std::printf("HMAC-SHA256 (%s) : %d erreur(s)%s\n", Sha256KernelName(kernel), failures, failures ? "  INVALIDE" : "");
+        ok = ok && failures == 0;
+    }
+
+    int n = std::max(iterations / 10, 100);
+    for (Sha256Kernel kernel : kernels)
+    {
+        std::string name = std::string("HMAC/") + Sha256KernelName(kernel);
+        results.push_back(Measure(name + "/cle", 0, n, 1, [&](int) {
+            HmacSha256 perCall(key, kernel);
+            perCall.Sign(body);
+        }));
+        HmacSha256 signer(key, kernel);
+        results.push_back(Measure(name, 0, n, 1, [&](int) { signer.Sign(body); }));
+    }
+    return ok;
+}
+
+// Un message de debug typique, ecrit avec flush comme l'ancien Log puis via
+// AsyncLog. Les ecritures asynchrones se font par rafales plus courtes que le
+// tampon : le thread d'ecriture le vide entre deux rafales, hors mesure.
+static void RunLogging(int iterations, std::vector<BenchResult>& results)
+{
+    static constexpr int BURST = static_cast<int>(AsyncLog::CAPACITY / 2);
+    const std::string msg = "[DEBUG] Degagement par Joueur 3 t:123.450000";
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "auusa_bench.log";
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    {
+        std::ofstream file(path, std::ios::trunc);
+        size_t allocs = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            size_t before = allocationCount;
+            auto start = std::chrono::steady_clock::now();
+            file << msg << std::endl;
+            file.flush();
+            auto end = std::chrono::steady_clock::now();
+            allocs += allocationCount - before;
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        results.push_back(Summarize("Log/flush", 0, samples, allocs, iterations));
+    }
+
+    samples.clear();
+    {
+        AsyncLog logger;
+        logger.Open(path, 0, 1);
+        size_t allocs = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            if (i % BURST == 0)
+            {
+                while (logger.Written() + logger.Dropped() < static_cast<uint64_t>(i))
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            size_t before = allocationCount;
+            auto start = std::chrono::steady_clock::now();
+            logger.Write(LogLevel::Info, msg);
+            auto end = std::chrono::steady_clock::now();
+            allocs += allocationCount - before;
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        logger.Close();
+        if (logger.Dropped() > 0)
+            std::printf("AsyncLog : %llu message(s) perdu(s) pendant la mesure\n", static_cast<unsigned long long>(logger.Dropped()));
+        results.push_back(Summarize("Log/async", 0, samples, allocs, iterations));
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+static json ToJson(const std::vector<BenchResult>& results)
+{
+    json cases = json::array();
+    for (const BenchResult& r : results)
+    {
+        cases.push_back({
+            {"name", r.name},
+            {"teamSize", r.teamSize},
+            {"meanNs", r.meanNs},
+            {"p50Ns", r.p50Ns},
+            {"p99Ns", r.p99Ns},
+            {"allocsPerOp", r.allocsPerOp}
+        });
+    }
+    return {{"version", 1}, {"cases", cases}};
+}
+
+// Renvoie le nombre de regressions par rapport a la reference.
+static int CompareBaseline(const std::vector<BenchResult>& results, const json& baseline, double tolerance)
+{
+    int regressions = 0;
+    std::printf("\nComparaison a la reference (tolerance %.0f %%)\n", tolerance * 100.0);
+    for (const BenchResult& r : results)
+    {
+        for (const json& ref : baseline.value("cases", json::array()))
+        {
+            if (ref.value("name", "") != r.name || ref.value("teamSize", 0) != r.teamSize)
+                continue;
+            double refMean = ref.value("meanNs", 0.0);
+            double refAllocs = ref.value("allocsPerOp", 0.0);
+            double delta = refMean > 0.0 ? (r.meanNs - refMean) / refMean : 0.0;
+            bool slower = delta > tolerance;
+            bool moreAllocs = r.allocsPerOp > refAllocs + 0.01;
+            std::printf("%-20s %dv%d  %10.1f -> %10.1f ns  %+6.1f %%  allocs %.2f -> %.2f%s\n",
+                        r.name.c_str(), r.teamSize, r.teamSize, refMean, r.meanNs, delta * 100.0,
+                        refAllocs, r.allocsPerOp, slower || moreAllocs ? "  REGRESSION" : "");
+            if (slower || moreAllocs)
+                regressions++;
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 20000;
+    double tolerance = 0.10;
+    std::string jsonPath;
+    std::string baselinePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--iterations" && hasValue)
+            iterations = std::max(100, std::atoi(argv[++i]));
+        else if (arg == "--json" && hasValue)
+            jsonPath = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            baselinePath = argv[++i];
+        else if (arg == "--tolerance" && hasValue)
+            tolerance = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage : auusa_bench [--iterations N] [--json fichier] [--baseline fichier] [--tolerance 0.10]\n");
+            return 2;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    std::printf("%-20s %-5s %12s %12s %12s %10s\n", "cas", "mode", "ns/op", "p50", "p99", "allocs/op");
+    for (int teamSize = 1; teamSize <= MAX_TEAM_SIZE; ++teamSize)
+    {
+        for (const BenchResult& r : RunTeamSize(teamSize, iterations))
+        {
+            std::printf("%-20s %dv%d   %12.1f %12.1f %12.1f %10.2f\n",
+                        r.name.c_str(), r.teamSize, r.teamSize, r.meanNs, r.p50Ns, r.p99Ns, r.allocsPerOp);
+            results.push_back(r);
+        }
+    }
+
+    std::vector<BenchResult> xgResults;
+    int status = RunXGBatch(iterations, xgResults) ? 0 : 1;
+    for (const BenchResult& r : xgResults)
+    {
+        std::printf("%-20s tir   %12.2f %12.2f %12.2f %10.2f\n", r.name.c_str(), r.meanNs, r.p50Ns, r.p99Ns, r.allocsPerOp);
+        results.push_back(r);
+    }
+
+    std::vector<BenchResult> hmacResults;
+    if (!RunHmac(iterations, hmacResults))
+        status = 1;
+    for (const BenchResult& r : hmacResults)
+    {
+        std::printf("%-20s corps %12.1f %12.1f %12.1f %10.2f\n", r.name.c_str(), r.meanNs, r.p50Ns, r.p99Ns, r.allocsPerOp);
+        results.push_back(r);
+    }
+
+    std::vector<BenchResult> logResults;
+    RunLogging(iterations, logResults);
+    for (const BenchResult& r : logResults)
+    {
+        std::printf("%-20s msg   %12.1f %12.1f %12.1f %10.2f\n", r.name.c_str(), r.meanNs, r.p50Ns, r.p99Ns, r.allocsPerOp);
+        results.push_back(r);
+    }
+
+    // Pire frame : un echantillon et une touche avec tir dans la meme frame
+    for (int teamSize = 1; teamSize <= MAX_TEAM_SIZE; ++teamSize)
+    {
+        double worst = 0.0;
+        for (const BenchResult& r : results)
+            if (r.teamSize == teamSize && (r.name == "TickStats" || r.name == "OnHitBall+tir"))
+                worst += r.p99Ns;
+        bool over = worst > FRAME_BUDGET_NS;
+        std::printf("Budget par frame %dv%d : p99 %.1f us / %.0f us%s\n", teamSize, teamSize,
+                    worst / 1000.0, FRAME_BUDGET_NS / 1000.0, over ? "  DEPASSE" : "");
+        if (over)
+            status = 1;
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream out(jsonPath);
+        out << ToJson(results).dump(2) << std::endl;
+        std::printf("Resultats enregistres dans %s\n", jsonPath.c_str());
+    }
+
+    if (!baselinePath.empty())
+    {
+        std::ifstream in(baselinePath);
+        json baseline = json::parse(in, nullptr, false);
+        if (baseline.is_discarded())
+        {
+            std::fprintf(stderr, "Reference illisible : %s\n", baselinePath.c_str());
+            return 2;
+        }
+        if (CompareBaseline(results, baseline, tolerance) > 0)
+            status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,492 @@
+// Verifications hors jeu du coeur du plugin, sans reseau ni SDK. Chaque
+// verification affiche son resultat ; le code de sortie est non nul si l'une
+// d'elles echoue.
+//
+//   auusa_check [-v]
+//
+// replay : un match synthetique 2v2 est analyse une fois sur les frames
+//          capturees et une fois sur les memes frames passees par la
+//          telemetrie (TelemetryEncodeFrame puis TelemetryDecodeFrame),
+//          comme le fait auusa_replay. Les deux payloads doivent rester
+//          dans les tolerances REPLAY_* ci-dessous : un compteur a seuil
+//          (boost gaspille, tir cadre...) peut basculer d'une unite, les
+//          valeurs continues et les cartes de presence bougent a peine.
+//
+// utf8 : un nom coupe au milieu d'un caractere ou contenant des octets
+//          invalides doit donner du texte UTF-8 valide en JSON comme en CBOR,
+//          et les copies a taille fixe ne coupent pas un caractere.
+//
+// journal : un journal d'envois dont la fin est illisible (ecriture
+//          interrompue) et qui ne peut pas etre reecrit (.tmp bloque) doit
+//          garder ses entrees et celles ajoutees ensuite.
+//
+// -v : affiche chaque champ du payload qui differe.
+#include "../MatchAnalytics.h"
+#include "../PayloadWriter.h"
+#include "../Telemetry.h"
+#include "../UploadJournal.h"
+#include "../Utf8.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+static bool verbose = false;
+
+// Ecart admis entre le payload relu et celui du match : arrondis de la
+// telemetrie (positions et vitesses a l'unite, boost au centieme).
+static constexpr int64_t REPLAY_COUNT_TOLERANCE = 1;
+static constexpr double REPLAY_ABS_TOLERANCE = 0.02;
+static constexpr double REPLAY_REL_TOLERANCE = 0.05;
+// Part du temps de presence qui change de case quand une voiture arrondie
+// passe la frontiere d'une case de 256 uu
+static constexpr double REPLAY_HEATMAP_TOLERANCE = 0.01;
+
+struct Lcg
+{
+    uint32_t state = 12345;
+    float Next(float lo, float hi)
+    {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * ((state >> 8) / 16777216.f);
+    }
+};
+
+static bool Check(bool ok, const char* name, const std::string& detail)
+{
+    std::printf("%-8s %s  %s\n", ok ? "OK" : "ECHEC", name, detail.c_str());
+    return ok;
+}
+
+// Match synthetique : voitures et balle en mouvement continu, touches,
+// ramassages de boost, demolitions et buts, a 20 Hz.
+class SyntheticMatch
+{
+public:
+    static constexpr int TEAM_SIZE = 2;
+    static constexpr int PLAYERS = TEAM_SIZE * 2;
+    static constexpr float DT = 0.05f;
+
+    SyntheticMatch()
+    {
+        f.hasBall = true;
+        f.ballPos = {0.f, 0.f, 93.15f};
+        for (int i = 0; i < PLAYERS; ++i)
+        {
+            int k = f.count++;
+            f.slot[k] = i;
+            f.pri[k] = static_cast<uintptr_t>(i) + 1;
+            f.indexOfSlot[i] = k;
+            f.team[k] = i < TEAM_SIZE ? 0 : 1;
+            f.hasCar[k] = true;
+            f.pos[k] = {rng.Next(-3000.f, 3000.f), (f.team[k] == 0 ? -1.f : 1.f) * rng.Next(1000.f, 4500.f), 17.01f};
+            f.boost[k] = 0.333f;
+            f.onGround[k] = true;
+        }
+    }
+
+    const FrameSnapshot& Frame() const { return f; }
+
+    void Step()
+    {
+        f.time += DT;
+        for (int k = 0; k < f.count; ++k)
+        {
+            Vec3& v = f.vel[k];
+            v.X = std::clamp(v.X + rng.Next(-90.f, 90.f), -1600.f, 1600.f);
+            v.Y = std::clamp(v.Y + rng.Next(-90.f, 90.f), -1600.f, 1600.f);
+            bool air = rng.Next(0.f, 1.f) < 0.02f || f.pos[k].Z > 18.f;
+            v.Z = air ? v.Z + (f.pos[k].Z > 18.f ? -32.5f : 500.f) : 0.f;
+            Move(f.pos[k], v);
+            if (f.pos[k].Z <= 17.01f)
+            {
+                f.pos[k].Z = 17.01f;
+                v.Z = 0.f;
+            }
+            f.onGround[k] = f.pos[k].Z <= 17.01f;
+            f.boost[k] = std::clamp(f.boost[k] + rng.Next(-0.02f, 0.012f), 0.f, 1.f);
+        }
+        f.ballVel.Z -= 32.5f;
+        Move(f.ballPos, f.ballVel);
+        if (f.ballPos.Z < 93.15f)
+        {
+            f.ballPos.Z = 93.15f;
+            f.ballVel.Z = -f.ballVel.Z * 0.6f;
+        }
+    }
+
+    // Le joueur le plus proche de la balle la frappe, vers le but adverse
+    // une fois sur trois
+    int Touch()
+    {
+        int best = 0;
+        for (int k = 1; k < f.count; ++k)
+            if ((f.pos[k] - f.ballPos).magnitude() < (f.pos[best] - f.ballPos).magnitude())
+                best = k;
+        f.pos[best] = {f.ballPos.X + rng.Next(-120.f, 120.f), f.ballPos.Y + rng.Next(-120.f, 120.f), 17.01f};
+        float dir = f.team[best] == 0 ? 1.f : -1.f;
+        bool shot = rng.Next(0.f, 1.f) < 0.33f;
+        f.ballVel = {rng.Next(-800.f, 800.f), dir * rng.Next(shot ? 1800.f : 200.f, shot ? 3000.f : 1500.f),
+                     rng.Next(0.f, 700.f)};
+        return best;
+    }
+
+    int Random(int n) { return static_cast<int>(rng.Next(0.f, n - 0.001f)); }
+    float Boost(int k)
+    {
+        f.boost[k] = std::min(1.f, f.boost[k] + rng.Next(0.1f, 1.f));
+        return f.boost[k];
+    }
+    void Kickoff()
+    {
+        f.ballPos = {0.f, 0.f, 93.15f};
+        f.ballVel = {};
+    }
+
+private:
+    static void Move(Vec3& p, Vec3& v)
+    {
+        p.X += v.X * DT;
+        p.Y += v.Y * DT;
+        p.Z += v.Z * DT;
+        if (std::fabs(p.X) > 4000.f)
+        {
+            p.X = std::copysign(4000.f, p.X);
+            v.X = -v.X;
+        }
+        if (std::fabs(p.Y) > 5000.f)
+        {
+            p.Y = std::copysign(5000.f, p.Y);
+            v.Y = -v.Y;
+        }
+    }
+
+    FrameSnapshot f;
+    Lcg rng;
+};
+
+// Frame telle que auusa_replay la relit
+static void RoundTrip(const FrameSnapshot& in, FrameSnapshot& out)
+{
+    uint8_t bytes[sizeof(TelemetryFrame) + MAX_PLAYERS * sizeof(TelemetryLane)];
+    TelemetryFrame rec;
+    TelemetryLane lanes[MAX_PLAYERS];
+    TelemetryEncodeFrame(in, rec, lanes);
+    std::memcpy(bytes, &rec, sizeof(rec));
+    std::memcpy(bytes + sizeof(rec), lanes, rec.lanes * sizeof(TelemetryLane));
+
+    int saves[MAX_SLOTS] = {};
+    for (int i = 0; i < in.count; ++i)
+        saves[in.slot[i]] = in.saves[i];
+    TelemetryRecord r;
+    r.type = TELEMETRY_FRAME;
+    r.data = bytes;
+    r.size = sizeof(rec) + rec.lanes * sizeof(TelemetryLane);
+    TelemetryDecodeFrame(r, saves, out);
+}
+
+struct Deviation
+{
+    int numbers = 0;
+    int countsChanged = 0;  // compteurs decales, dans la tolerance
+    int countMismatches = 0; // structure ou compteurs hors tolerance
+    int valueMismatches = 0;
+    double worstRel = 0.0;
+    std::string worstPath;
+};
+
+// Part du temps de presence placee dans une autre case
+static double HeatmapShift(const Heatmap& live, const Heatmap& replay)
+{
+    double total = 0.0;
+    double moved = 0.0;
+    for (int c = 0; c < Heatmap::CELLS; ++c)
+    {
+        total += live.cells[c];
+        moved += std::abs(static_cast<int>(live.cells[c]) - static_cast<int>(replay.cells[c]));
+    }
+    return total > 0.0 ? moved / (2.0 * total) : 0.0;
+}
+
+// Compare deux payloads champ par champ. Les cartes de presence encodees
+// sont comparees a part, case par case (HeatmapShift).
+static void Compare(const json& live, const json& replay, const std::string& path, Deviation& d)
+{
+    if (live.type() != replay.type() && !(live.is_number() && replay.is_number()))
+    {
+        d.countMismatches++;
+        if (verbose)
+            std::printf("  %s : type different\n", path.c_str());
+        return;
+    }
+    if (live.is_object())
+    {
+        for (auto it = live.begin(); it != live.end(); ++it)
+        {
+            if (!replay.contains(it.key()))
+            {
+                d.countMismatches++;
+                if (verbose)
+                    std::printf("  %s.%s : absent de la relecture\n", path.c_str(), it.key().c_str());
+                continue;
+            }
+            Compare(it.value(), replay[it.key()], path + "." + it.key(), d);
+        }
+        return;
+    }
+    if (live.is_array())
+    {
+        if (live.size() != replay.size())
+        {
+            d.countMismatches++;
+            if (verbose)
+                std::printf("  %s : %zu elements contre %zu\n", path.c_str(), live.size(), replay.size());
+            return;
+        }
+        for (size_t i = 0; i < live.size(); ++i)
+            Compare(live[i], replay[i], path + "[" + std::to_string(i) + "]", d);
+        return;
+    }
+    if (live.is_string())
+    {
+        if (live != replay && path.find("heatmap") == std::string::npos)
+            d.countMismatches++;
+        return;
+    }
+    if (live.is_number_integer() && replay.is_number_integer())
+    {
+        d.numbers++;
+        int64_t diff = live.get<int64_t>() - replay.get<int64_t>();
+        if (diff != 0)
+        {
+            (diff > REPLAY_COUNT_TOLERANCE || diff < -REPLAY_COUNT_TOLERANCE ? d.countMismatches : d.countsChanged)++;
+            if (verbose)
+                std::printf("  %s : %lld contre %lld\n", path.c_str(), static_cast<long long>(live.get<int64_t>()),
+                            static_cast<long long>(replay.get<int64_t>()));
+        }
+        return;
+    }
+    if (live.is_number())
+    {
+        d.numbers++;
+        double a = live.get<double>();
+        double b = replay.get<double>();
+        double diff = std::fabs(a - b);
+        double rel = diff / std::max(std::fabs(a), 1e-9);
+        if (diff > REPLAY_ABS_TOLERANCE && rel > REPLAY_REL_TOLERANCE)
+        {
+            d.valueMismatches++;
+            if (verbose)
+                std::printf("  %s : %g contre %g\n", path.c_str(), a, b);
+        }
+        if (diff > REPLAY_ABS_TOLERANCE && rel > d.worstRel)
+        {
+            d.worstRel = rel;
+            d.worstPath = path;
+        }
+        return;
+    }
+    if (live != replay)
+        d.countMismatches++;
+}
+
+static bool CheckReplay()
+{
+    MatchAnalytics live;
+    MatchAnalytics replay;
+    SyntheticMatch match;
+    FrameSnapshot rf;
+
+    for (MatchAnalytics* a : {&live, &replay})
+    {
+        a->Reset();
+        for (int i = 0; i < SyntheticMatch::PLAYERS; ++i)
+            a->AssignPlayer(i, "uid" + std::to_string(i), "Joueur " + std::to_string(i),
+                            i < SyntheticMatch::TEAM_SIZE ? 0 : 1);
+    }
+    RoundTrip(match.Frame(), rf);
+    live.OnMatchStart(match.Frame());
+    replay.OnMatchStart(rf);
+    live.SetPhase(GamePhase::Live);
+    replay.SetPhase(GamePhase::Live);
+
+    // 5 minutes de jeu
+    int scoreBlue = 0;
+    int scoreOrange = 0;
+    for (int i = 0; i < 6000; ++i)
+    {
+        match.Step();
+        RoundTrip(match.Frame(), rf);
+        live.Sample(match.Frame());
+        replay.Sample(rf);
+
+        if (i % 9 == 0)
+        {
+            int self = match.Touch();
+            RoundTrip(match.Frame(), rf);
+            live.OnTouch(match.Frame(), self);
+            replay.OnTouch(rf, self);
+        }
+        if (i % 37 == 0)
+        {
+            // Evenement enregistre tel quel (TELEMETRY_BOOST)
+            int k = match.Random(SyntheticMatch::PLAYERS);
+            float current = match.Boost(k);
+            live.OnBoost(k, current, 1.f);
+            replay.OnBoost(k, current, 1.f);
+        }
+        if (i % 401 == 0)
+        {
+            int k = match.Random(SyntheticMatch::PLAYERS);
+            live.OnDemolish(match.Frame(), k);
+            replay.OnDemolish(rf, k);
+        }
+        if (i % 1201 == 1200)
+        {
+            (i / 1201) % 2 ? ++scoreOrange : ++scoreBlue;
+            live.OnGoal(match.Frame(), scoreBlue, scoreOrange);
+            replay.OnGoal(rf, scoreBlue, scoreOrange);
+            match.Kickoff();
+        }
+    }
+
+    MatchSummary summary;
+    summary.scoreBlue = scoreBlue;
+    summary.scoreOrange = scoreOrange;
+    summary.map = "Stadium_P";
+    summary.secondsElapsed = 300.f;
+    summary.totalGameTime = 300.f;
+    for (int i = 0; i < SyntheticMatch::PLAYERS; ++i)
+    {
+        ScoreboardLine line;
+        line.slot = i;
+        line.name = live.PlayerName(i);
+        line.team = i < SyntheticMatch::TEAM_SIZE ? 0 : 1;
+        summary.players.push_back(line);
+    }
+
+    PayloadExtras extras;
+    PayloadWriter a;
+    PayloadWriter b;
+    a.Reset(PayloadFormat::Json);
+    b.Reset(PayloadFormat::Json);
+    live.WritePayload(summary, extras, a);
+    replay.WritePayload(summary, extras, b);
+
+    Deviation d;
+    Compare(json::parse(a.Data()), json::parse(b.Data()), "", d);
+    double heatmap = HeatmapShift(live.BallHeatmap(), replay.BallHeatmap());
+    for (int i = 0; i < SyntheticMatch::PLAYERS; ++i)
+        heatmap = std::max(heatmap, HeatmapShift(live.Stats(i)->heatmap, replay.Stats(i)->heatmap));
+    char detail[256];
+    std::snprintf(detail, sizeof(detail),
+                  "%d valeurs, %d compteur(s) decale(s) d'une unite, %d hors tolerance, "
+                  "pire ecart %.2f %% (%s), temps de presence deplace %.3f %%",
+                  d.numbers, d.countsChanged, d.countMismatches + d.valueMismatches, d.worstRel * 100.0,
+                  d.worstPath.empty() ? "-" : d.worstPath.c_str(), heatmap * 100.0);
+    return Check(d.countMismatches == 0 && d.valueMismatches == 0 && heatmap <= REPLAY_HEATMAP_TOLERANCE, "replay",
+                 detail);
+}
+
+static bool CheckUtf8()
+{
+    // Caractere coupe en fin de nom, puis octets hors UTF-8
+    const std::string name = "\xC3\x89ric \xC3";
+    const std::string bad = "a\xFF\xC0\xAFz";
+    bool ok = true;
+    std::string detail;
+    for (PayloadFormat format : {PayloadFormat::Json, PayloadFormat::Cbor})
+    {
+        PayloadWriter writer;
+        writer.Reset(format);
+        writer.BeginObject(2);
+        writer.Key("name");
+        writer.String(name);
+        writer.Key("bad");
+        writer.String(bad);
+        writer.End();
+        json doc = format == PayloadFormat::Json
+                       ? json::parse(writer.Data(), nullptr, false)
+                       : json::from_cbor(writer.Data(), true, false);
+        bool valid = doc.is_object() && Utf8Valid(doc.value("name", "")) && Utf8Valid(doc.value("bad", ""));
+        ok = ok && valid;
+        detail += std::string(PayloadFormatName(format)) + (valid ? " valide, " : " INVALIDE, ");
+    }
+
+    // 5 octets disponibles : "\xC3\x89ri" tient, le "\xC3\x89" suivant serait coupe
+    char copy[6];
+    TelemetryCopyString(copy, sizeof(copy), "\xC3\x89ri\xC3\x89");
+    bool cut = std::string(copy) == "\xC3\x89ri";
+    ok = ok && cut;
+    detail += cut ? "troncature sur un caractere" : "troncature au milieu d'un caractere";
+    return Check(ok, "utf8", detail);
+}
+
+static bool CheckJournal()
+{
+    std::error_code ec;
+    std::filesystem::path file = std::filesystem::temp_directory_path(ec) / "auusa_check.journal";
+    std::filesystem::path tmp = file.string() + ".tmp";
+    std::filesystem::remove_all(tmp, ec);
+    std::filesystem::remove(file, ec);
+
+    std::vector<UploadJournal::Entry> pending;
+    std::vector<std::string> bodies;
+    {
+        UploadJournal journal;
+        journal.Open(file.string(), pending);
+        uint64_t sent = journal.Append("/match", "{\"a\":1}");
+        journal.Append("/match", "{\"b\":2}");
+        journal.MarkDone(sent);
+    }
+    // En-tete de trame coupe, puis reecriture impossible
+    if (FILE* f = std::fopen(file.string().c_str(), "ab"))
+    {
+        std::fwrite("AAUJ\x01\x00", 1, 6, f);
+        std::fclose(f);
+    }
+    std::filesystem::create_directory(tmp, ec);
+    {
+        UploadJournal journal;
+        journal.Open(file.string(), pending);
+        journal.Append("/match", "{\"c\":3}");
+    }
+    std::filesystem::remove_all(tmp, ec);
+    {
+        UploadJournal journal;
+        journal.Open(file.string(), pending);
+        for (const UploadJournal::Entry& e : pending)
+            bodies.push_back(e.body);
+    }
+    std::filesystem::remove(file, ec);
+
+    std::string detail = std::to_string(bodies.size()) + " entree(s) relue(s) :";
+    for (const std::string& b : bodies)
+        detail += " " + b;
+    return Check(bodies == std::vector<std::string>{"{\"b\":2}", "{\"c\":3}"}, "journal", detail);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else
+        {
+            std::fprintf(stderr, "usage : auusa_check [-v]\n");
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    ok &= CheckReplay();
+    ok &= CheckUtf8();
+    ok &= CheckJournal();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// Ouvre le flux /player/stream d'un joueur avec le PushClient du plugin et
+// affiche chaque attribution recue, precedee du delai depuis le lancement.
+// Sert a verifier le canal push contre le bot ou un serveur SSE local.
+//
+//   auusa_push [-v] [--count N] [--seconds S] <url_de_base> <player_id>
+//
+// --count  : s'arrete apres N attributions (0 : jamais, par defaut 1)
+// --seconds: duree maximale d'ecoute (par defaut 60)
+// -v       : journal detaille du client (reconnexions, identifiants)
+#include "../PushClient.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+static int Usage()
+{
+    std::cerr << "usage: auusa_push [-v] [--count N] [--seconds S] <url_de_base> <player_id>" << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    int count = 1;
+    int seconds = 60;
+    std::string baseUrl;
+    std::string playerId;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = std::atoi(argv[++i]);
+        else if (baseUrl.empty())
+            baseUrl = argv[i];
+        else if (playerId.empty())
+            playerId = argv[i];
+        else
+            return Usage();
+    }
+    if (baseUrl.empty() || playerId.empty())
+        return Usage();
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int received = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    PushClient client;
+    client.SetDebug(verbose);
+    client.SetPlayerId(playerId);
+    client.Start(
+        baseUrl,
+        [&](const std::string& msg) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::fprintf(stderr, "[%9.1f ms] %s\n", elapsedMs(), msg.c_str());
+        },
+        [&](const nlohmann::json& instr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::printf("[%9.1f ms] %s\n", elapsedMs(), instr.dump().c_str());
+            std::fflush(stdout);
+            ++received;
+            done.notify_all();
+        });
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::seconds(seconds), [&] { return count > 0 && received >= count; });
+    }
+    client.Stop();
+    std::cerr << client.Summary() << std::endl;
+    return count > 0 && received < count ? 1 : 0;
+}
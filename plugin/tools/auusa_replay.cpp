@@ -0,0 +1,227 @@
+// Relit un enregistrement de telemetrie (.amt) a travers MatchAnalytics et
+// affiche sur la sortie standard le payload de fin de match. Il ne differe de
+// celui que le plugin a envoye au bot que par les arrondis de la telemetrie
+// (voir Telemetry.h) ; auusa_check mesure l'ecart.
+//
+//   auusa_replay [-v] [--stream] match_<horodatage>.amt
+//
+// -v       : affiche sur la sortie d'erreur les evenements journalises en
+//            mode debug.
+// --stream : affiche aussi, une ligne par lot, ce que le flux de match
+//            (mm_stream) aurait envoye pendant la partie.
+#include "../MatchAnalytics.h"
+#include "../MatchStream.h"
+#include "../SessionStats.h"
+#include "../Telemetry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+template <typename T>
+static T ReadAs(const uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+static MatchSummary LoadSummary(const TelemetryRecord& rec, const MatchAnalytics& analytics)
+{
+    TelemetryMatchEnd end = ReadAs<TelemetryMatchEnd>(rec.data);
+    MatchSummary summary;
+    summary.scoreBlue = end.scoreBlue;
+    summary.scoreOrange = end.scoreOrange;
+    summary.teamBlue = std::string(end.teamBlue, strnlen(end.teamBlue, sizeof(end.teamBlue)));
+    summary.teamOrange = std::string(end.teamOrange, strnlen(end.teamOrange, sizeof(end.teamOrange)));
+    summary.map = std::string(end.map, strnlen(end.map, sizeof(end.map)));
+    summary.secondsElapsed = end.secondsElapsed;
+    summary.totalGameTime = end.totalGameTime;
+
+    const uint8_t* p = rec.data + sizeof(TelemetryMatchEnd);
+    for (int i = 0; i < end.lanes; ++i, p += sizeof(TelemetryScore))
+    {
+        TelemetryScore score = ReadAs<TelemetryScore>(p);
+        if (score.slot >= MAX_SLOTS)
+            continue;
+        ScoreboardLine line;
+        line.slot = score.slot;
+        line.name = analytics.PlayerName(score.slot);
+        line.team = score.team;
+        line.goals = score.goals;
+        line.assists = score.assists;
+        line.shots = score.shots;
+        line.saves = score.saves;
+        line.score = score.score;
+        summary.players.push_back(line);
+    }
+    return summary;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    bool streamed = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (std::strcmp(argv[i], "--stream") == 0)
+            streamed = true;
+        else
+            path = argv[i];
+    }
+    if (!path)
+    {
+        std::fprintf(stderr, "usage : auusa_replay [-v] [--stream] <fichier.amt>\n");
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TelemetryReader reader;
+    if (!reader.Open(path))
+    {
+        std::fprintf(stderr, "[Replay] %s\n", reader.Error().c_str());
+        return 1;
+    }
+
+    MatchAnalytics analytics;
+    analytics.SetDebug(verbose);
+    analytics.SetLogger([](const std::string& msg) { std::fprintf(stderr, "%s\n", msg.c_str()); });
+    analytics.Reset();
+
+    MatchStream stream(analytics);
+    stream.SetSubmit([](std::shared_ptr<const StreamBatch> batch) {
+        std::cout << batch->ToJson().dump() << std::endl;
+        return true;
+    });
+
+    FrameSnapshot frame;
+    int savesBySlot[MAX_SLOTS] = {};
+    bool started = false;
+    bool ended = false;
+    long records = 0;
+    // Frame marquee TELEMETRY_FRAME_SAMPLE : l'echantillon est joue une fois
+    // relus les evenements SAVES qui la completent
+    bool pendingSample = false;
+    auto runSample = [&] {
+        if (!pendingSample)
+            return;
+        pendingSample = false;
+        analytics.Sample(frame);
+        stream.Tick(frame.time);
+    };
+    TelemetryRecord rec;
+    while (reader.Next(rec))
+    {
+        records++;
+        if (rec.type != TELEMETRY_SAVES)
+            runSample();
+        if (rec.type == TELEMETRY_FRAME)
+        {
+            TelemetryDecodeFrame(rec, savesBySlot, frame);
+            if (!started)
+            {
+                analytics.OnMatchStart(frame);
+                if (streamed)
+                    stream.Begin("replay", "", frame.time);
+                started = true;
+            }
+            pendingSample = (ReadAs<TelemetryFrame>(rec.data).flags & TELEMETRY_FRAME_SAMPLE) != 0;
+            continue;
+        }
+        if (rec.type == TELEMETRY_PLAYER)
+        {
+            TelemetryPlayer player = ReadAs<TelemetryPlayer>(rec.data);
+            if (player.slot < MAX_SLOTS)
+                analytics.AssignPlayer(player.slot,
+                                       std::string(player.uid, strnlen(player.uid, sizeof(player.uid))),
+                                       std::string(player.name, strnlen(player.name, sizeof(player.name))),
+                                       player.team);
+            continue;
+        }
+        if (rec.type == TELEMETRY_MATCH_END)
+        {
+            stream.End(frame.time);
+            // Meme resultat que le plugin au premier match d'une session
+            MatchSummary summary = LoadSummary(rec, analytics);
+            SessionStats session;
+            session.AddMatch(analytics, summary);
+            PayloadExtras extras;
+            extras.session = &session;
+            PayloadWriter payload;
+            payload.Reset(PayloadFormat::Json);
+            analytics.WritePayload(summary, extras, payload);
+            std::cout << payload.Data() << std::endl;
+            ended = true;
+            continue;
+        }
+
+        TelemetryEvent ev = ReadAs<TelemetryEvent>(rec.data);
+        int slot = ev.slot < MAX_SLOTS ? ev.slot : -1;
+        switch (ev.type)
+        {
+        case TELEMETRY_PHASE:
+            analytics.SetPhase(static_cast<GamePhase>(ev.slot));
+            break;
+        case TELEMETRY_SAMPLE:
+            analytics.Sample(frame);
+            stream.Tick(frame.time);
+            break;
+        case TELEMETRY_TOUCH:
+        {
+            int self = frame.FindSlot(slot);
+            if (self >= 0 && frame.hasCar[self])
+            {
+                const PlayerStats* ps = analytics.Stats(slot);
+                size_t shots = ps ? ps->shots.size() : 0;
+                analytics.OnTouch(frame, self);
+                ps = analytics.Stats(slot);
+                stream.AddTouch(frame.time, slot, ps && ps->shots.size() > shots ? ps->shots.back().xg : -1.f);
+            }
+            break;
+        }
+        case TELEMETRY_DEMOLISH:
+        {
+            int attacker = frame.FindSlot(slot);
+            if (attacker >= 0 && frame.hasCar[attacker])
+            {
+                analytics.OnDemolish(frame, attacker);
+                stream.AddDemo(frame.time, slot, ev.other < MAX_SLOTS ? ev.other : -1);
+            }
+            break;
+        }
+        case TELEMETRY_BOOST:
+            if (slot >= 0)
+                analytics.OnBoost(slot, ev.a, ev.b);
+            break;
+        case TELEMETRY_GOAL:
+            if (analytics.OnGoal(frame, static_cast<int>(ev.a), static_cast<int>(ev.b)))
+                stream.AddGoal(frame.time, analytics.LastTouchSlot(), static_cast<int>(ev.a), static_cast<int>(ev.b));
+            break;
+        case TELEMETRY_SAVES:
+            if (slot >= 0)
+            {
+                // Evenement emis juste apres la frame qu'il complete
+                savesBySlot[slot] = static_cast<int>(ev.a);
+                int k = frame.FindSlot(slot);
+                if (k >= 0)
+                    frame.saves[k] = savesBySlot[slot];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    runSample();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!reader.Error().empty())
+        std::fprintf(stderr, "[Replay] %s\n", reader.Error().c_str());
+    if (!ended)
+        std::fprintf(stderr, "[Replay] pas de fin de match dans l'enregistrement\n");
+    std::fprintf(stderr, "[Replay] %ld enregistrements relus en %.2f ms\n", records, ms);
+    return ended ? 0 : 1;
+}